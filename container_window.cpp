@@ -1,5 +1,7 @@
 #include "stdafx.h"
 
+#include "direct_write.h"
+
 namespace uih {
 std::unordered_map<std::wstring, size_t> ContainerWindow::s_window_count;
 
@@ -70,6 +72,15 @@ LRESULT ContainerWindow::on_message(HWND wnd, UINT msg, WPARAM wp, LPARAM lp)
         m_wnd = nullptr;
         break;
     case WM_SETTINGCHANGE:
+        // Only top-level windows receive this from the system
+        if (!(GetWindowLongPtr(wnd, GWL_STYLE) & WS_CHILD))
+            direct_write::invalidate_rendering_params();
+
+        send_message_to_direct_children(wnd, msg, wp, lp);
+        break;
+    case WM_DISPLAYCHANGE:
+        direct_write::invalidate_rendering_params();
+        break;
     case WM_SYSCOLORCHANGE:
     case WM_TIMECHANGE:
         send_message_to_direct_children(wnd, msg, wp, lp);
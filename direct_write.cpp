@@ -10,6 +10,9 @@ namespace uih::direct_write {
 
 namespace {
 
+/** Incremented by invalidate_rendering_params() */
+std::atomic<uint64_t> rendering_params_generation{};
+
 float stretch_to_width(DWRITE_FONT_STRETCH stretch)
 {
     if (WI_EnumValue(stretch) < DWRITE_FONT_STRETCH_ULTRA_CONDENSED
@@ -73,10 +76,11 @@ wil::com_ptr<IDWriteFontCollection3> get_typographic_font_collection(const wil::
     return font_collection;
 }
 
-wil::com_ptr<IDWriteFontCollection> get_wss_font_collection(const wil::com_ptr<IDWriteFactory1>& factory)
+wil::com_ptr<IDWriteFontCollection> get_wss_font_collection(
+    const wil::com_ptr<IDWriteFactory1>& factory, bool check_for_updates = false)
 {
     wil::com_ptr<IDWriteFontCollection> font_collection;
-    THROW_IF_FAILED(factory->GetSystemFontCollection(&font_collection));
+    THROW_IF_FAILED(factory->GetSystemFontCollection(&font_collection, check_for_updates));
     return font_collection;
 }
 
@@ -104,6 +108,27 @@ wil::com_ptr<IDWriteFontSet4> get_font_set_4(const wil::com_ptr<IDWriteFactory1>
     return font_set.query<IDWriteFontSet4>();
 }
 
+std::wstring get_first_family_name(const wil::com_ptr<IDWriteFontFamily>& font_family)
+{
+    wil::com_ptr<IDWriteLocalizedStrings> family_names;
+    THROW_IF_FAILED(font_family->GetFamilyNames(&family_names));
+
+    uint32_t length{};
+    THROW_IF_FAILED(family_names->GetStringLength(0, &length));
+
+    std::wstring family_name(length, L'\0');
+    THROW_IF_FAILED(family_names->GetString(0, family_name.data(), length + 1));
+
+    return family_name;
+}
+
+std::vector<std::pair<uint32_t, float>> make_axis_values_key(const AxisValues& axis_values)
+{
+    std::vector<std::pair<uint32_t, float>> key(axis_values.begin(), axis_values.end());
+    std::ranges::sort(key);
+    return key;
+}
+
 constexpr COLORREF direct_write_colour_to_colorref(DWRITE_COLOR_F colour)
 {
     constexpr auto transform_channel
@@ -156,6 +181,72 @@ private:
     COLORREF m_selected_colour{};
 };
 
+/**
+ * An inline object that draws nothing and has a fixed width.
+ */
+class SpacerInlineObject : public IDWriteInlineObject {
+public:
+    explicit SpacerInlineObject(float width) : m_width(width) {}
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(const IID& riid, void** ppvObject) noexcept override
+    {
+        if (__uuidof(IDWriteInlineObject) == riid) {
+            AddRef();
+            *ppvObject = this;
+        } else if (__uuidof(IUnknown) == riid) {
+            AddRef();
+            *ppvObject = static_cast<IUnknown*>(this);
+        } else {
+            *ppvObject = nullptr;
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() noexcept override { return ++m_ref_count; }
+
+    ULONG STDMETHODCALLTYPE Release() noexcept override
+    {
+        if (--m_ref_count == 0) {
+            delete this;
+            return 0;
+        }
+
+        return m_ref_count;
+    }
+
+    HRESULT STDMETHODCALLTYPE Draw(void* clientDrawingContext, IDWriteTextRenderer* renderer, FLOAT originX,
+        FLOAT originY, BOOL isSideways, BOOL isRightToLeft, IUnknown* clientDrawingEffect) noexcept override
+    {
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetMetrics(DWRITE_INLINE_OBJECT_METRICS* metrics) noexcept override
+    {
+        *metrics = {m_width, 0.0f, 0.0f, FALSE};
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetOverhangMetrics(DWRITE_OVERHANG_METRICS* overhangs) noexcept override
+    {
+        *overhangs = {};
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetBreakConditions(
+        DWRITE_BREAK_CONDITION* breakConditionBefore, DWRITE_BREAK_CONDITION* breakConditionAfter) noexcept override
+    {
+        *breakConditionBefore = DWRITE_BREAK_CONDITION_NEUTRAL;
+        *breakConditionAfter = DWRITE_BREAK_CONDITION_NEUTRAL;
+        return S_OK;
+    }
+
+private:
+    std::atomic<ULONG> m_ref_count{};
+    float m_width{};
+};
+
 class GdiTextRenderer : public IDWriteTextRenderer {
 public:
     GdiTextRenderer(wil::com_ptr<IDWriteFactory1> factory, IDWriteBitmapRenderTarget* bitmapRenderTarget,
@@ -192,6 +283,12 @@ public:
         return m_ref_count;
     }
 
+    void set_default_colour(COLORREF default_colour, bool is_selected)
+    {
+        m_default_colour = default_colour;
+        m_is_selected = is_selected;
+    }
+
     HRESULT STDMETHODCALLTYPE IsPixelSnappingDisabled(void* clientDrawingContext, BOOL* isDisabled) noexcept override
     {
         *isDisabled = FALSE;
@@ -366,12 +463,27 @@ GdiTextRenderer::GdiTextRenderer(wil::com_ptr<IDWriteFactory1> factory, IDWriteB
 
 } // namespace
 
-wil::com_ptr<IDWriteRenderingParams> RenderingParams::get(HWND wnd) const
+HMONITOR get_window_monitor(HWND wnd)
 {
     const auto root_window = GetAncestor(wnd, GA_ROOT);
-    const auto monitor = MonitorFromWindow(root_window, MONITOR_DEFAULTTONEAREST);
+    return MonitorFromWindow(root_window, MONITOR_DEFAULTTONEAREST);
+}
+
+void invalidate_rendering_params()
+{
+    rendering_params_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+wil::com_ptr<IDWriteRenderingParams> RenderingParams::get(HWND wnd) const
+{
+    return get(get_window_monitor(wnd));
+}
 
-    if (m_rendering_params && m_monitor == monitor)
+wil::com_ptr<IDWriteRenderingParams> RenderingParams::get(HMONITOR monitor) const
+{
+    const auto generation = rendering_params_generation.load(std::memory_order_relaxed);
+
+    if (m_rendering_params && m_monitor == monitor && m_generation == generation)
         return m_rendering_params;
 
     wil::com_ptr<IDWriteRenderingParams> default_rendering_params;
@@ -379,6 +491,7 @@ wil::com_ptr<IDWriteRenderingParams> RenderingParams::get(HWND wnd) const
 
     if (m_rendering_mode == DWRITE_RENDERING_MODE_DEFAULT) {
         m_monitor = monitor;
+        m_generation = generation;
         m_rendering_params = std::move(default_rendering_params);
         return m_rendering_params;
     }
@@ -418,6 +531,7 @@ wil::com_ptr<IDWriteRenderingParams> RenderingParams::get(HWND wnd) const
     }
 
     m_monitor = monitor;
+    m_generation = generation;
     m_rendering_params = custom_rendering_params;
 
     return custom_rendering_params;
@@ -479,6 +593,21 @@ DWRITE_OVERHANG_METRICS TextLayout::get_overhang_metrics() const
     return overhang_metrics;
 }
 
+std::vector<DWRITE_CLUSTER_METRICS> TextLayout::get_cluster_metrics() const
+{
+    uint32_t cluster_count{};
+    const auto hr = m_text_layout->GetClusterMetrics(nullptr, 0, &cluster_count);
+
+    if (FAILED(hr) && hr != E_NOT_SUFFICIENT_BUFFER)
+        THROW_HR(hr);
+
+    std::vector<DWRITE_CLUSTER_METRICS> cluster_metrics(cluster_count);
+    THROW_IF_FAILED(m_text_layout->GetClusterMetrics(cluster_metrics.data(), cluster_count, &cluster_count));
+    cluster_metrics.resize(cluster_count);
+
+    return cluster_metrics;
+}
+
 bool TextLayout::is_trimmed() const
 {
     DWRITE_LINE_METRICS line_metrics{};
@@ -504,6 +633,12 @@ void TextLayout::set_effect(IUnknown* effect, DWRITE_TEXT_RANGE text_range) cons
     THROW_IF_FAILED(m_text_layout->SetDrawingEffect(effect, text_range));
 }
 
+void TextLayout::set_spacer(uint32_t position, float width) const
+{
+    const wil::com_ptr<IDWriteInlineObject> spacer = new SpacerInlineObject(width);
+    THROW_IF_FAILED(m_text_layout->SetInlineObject(spacer.get(), {position, 1}));
+}
+
 void TextLayout::set_max_height(float value) const
 {
     THROW_IF_FAILED(m_text_layout->SetMaxHeight(value));
@@ -560,7 +695,8 @@ void TextLayout::set_wss(DWRITE_FONT_WEIGHT weight, std::variant<DWRITE_FONT_STR
 }
 
 void TextLayout::render_with_transparent_background(HWND wnd, HDC dc, RECT output_rect, COLORREF default_colour,
-    bool is_selected, float x_origin_offset, wil::com_ptr<IDWriteBitmapRenderTarget> bitmap_render_target) const
+    bool is_selected, float x_origin_offset, wil::com_ptr<IDWriteBitmapRenderTarget> bitmap_render_target,
+    HMONITOR monitor) const
 {
     const auto metrics = get_metrics();
 
@@ -618,7 +754,7 @@ void TextLayout::render_with_transparent_background(HWND wnd, HDC dc, RECT outpu
     THROW_IF_FAILED(bitmap_render_target_1->SetTextAntialiasMode(
         is_greyscale_antialiasing ? DWRITE_TEXT_ANTIALIAS_MODE_GRAYSCALE : DWRITE_TEXT_ANTIALIAS_MODE_CLEARTYPE));
 
-    const auto rendering_params = m_rendering_params->get(wnd);
+    const auto rendering_params = monitor ? m_rendering_params->get(monitor) : m_rendering_params->get(wnd);
     const auto use_colour_glyphs = m_rendering_params->use_colour_glyphs();
     const auto memory_dc = bitmap_render_target->GetMemoryDC();
 
@@ -631,6 +767,117 @@ void TextLayout::render_with_transparent_background(HWND wnd, HDC dc, RECT outpu
     BitBlt(dc, source_x, source_y, bitmap_width, bitmap_height, memory_dc, 0, 0, SRCCOPY);
 }
 
+void TextLayout::render_with_transparent_background(TextRenderBatch& batch, RECT output_rect,
+    COLORREF default_colour, bool is_selected, float x_origin_offset) const
+{
+    RECT visible_rect{};
+    if (!IntersectRect(&visible_rect, &output_rect, &batch.m_rect))
+        return;
+
+    const auto metrics = get_metrics();
+
+    if (metrics.width <= 0.0f)
+        return;
+
+    const auto scaling_factor = get_default_scaling_factor();
+    const auto overhang_metrics = get_overhang_metrics();
+    const auto layout_width = m_text_layout->GetMaxWidth();
+    const auto layout_height = m_text_layout->GetMaxHeight();
+    const auto rect_width_dip = gsl::narrow_cast<float>(wil::rect_width(output_rect)) / scaling_factor;
+    const auto rect_height_dip = gsl::narrow_cast<float>(wil::rect_height(output_rect)) / scaling_factor;
+
+    const auto ink_bottom_dip
+        = m_has_underline ? metrics.top + metrics.height : layout_height + overhang_metrics.bottom;
+
+    batch.begin();
+
+    const RECT batch_output_rect{output_rect.left - batch.m_rect.left, output_rect.top - batch.m_rect.top,
+        output_rect.right - batch.m_rect.left, output_rect.bottom - batch.m_rect.top};
+
+    // Text extending outside of output_rect is rendered separately, so that it's clipped to output_rect
+    if (x_origin_offset - overhang_metrics.left < 0.0f
+        || x_origin_offset + layout_width + overhang_metrics.right > rect_width_dip || overhang_metrics.top > 0.0f
+        || ink_bottom_dip > rect_height_dip) {
+        render_with_transparent_background(batch.m_wnd, batch.m_bitmap_render_target->GetMemoryDC(),
+            batch_output_rect, default_colour, is_selected, x_origin_offset, {}, batch.m_monitor);
+        return;
+    }
+
+    const auto renderer = batch.get_renderer(m_factory, m_rendering_params, default_colour, is_selected);
+
+    THROW_IF_FAILED(m_text_layout->Draw(NULL, renderer,
+        gsl::narrow_cast<float>(batch_output_rect.left) / scaling_factor + x_origin_offset,
+        gsl::narrow_cast<float>(batch_output_rect.top) / scaling_factor));
+}
+
+TextRenderBatch::TextRenderBatch(HWND wnd, HDC dc, const RECT& rect,
+    wil::com_ptr<IDWriteBitmapRenderTarget> bitmap_render_target, HMONITOR monitor)
+    : m_wnd(wnd)
+    , m_monitor(monitor ? monitor : get_window_monitor(wnd))
+    , m_dc(dc)
+    , m_bitmap_render_target(std::move(bitmap_render_target))
+{
+    RECT clip_box{};
+
+    if (GetClipBox(dc, &clip_box) == ERROR)
+        m_rect = rect;
+    else
+        IntersectRect(&m_rect, &rect, &clip_box);
+}
+
+TextRenderBatch::~TextRenderBatch()
+{
+    end();
+}
+
+void TextRenderBatch::begin()
+{
+    if (m_is_active)
+        return;
+
+    const auto width = wil::rect_width(m_rect);
+    const auto height = wil::rect_height(m_rect);
+
+    SIZE size{};
+    THROW_IF_FAILED(m_bitmap_render_target->GetSize(&size));
+
+    if (width > size.cx || height > size.cy)
+        THROW_IF_FAILED(m_bitmap_render_target->Resize(std::max(width, size.cx), std::max(height, size.cy)));
+
+    BitBlt(m_bitmap_render_target->GetMemoryDC(), 0, 0, width, height, m_dc, m_rect.left, m_rect.top, SRCCOPY);
+    m_is_active = true;
+}
+
+void TextRenderBatch::end()
+{
+    if (!m_is_active)
+        return;
+
+    BitBlt(m_dc, m_rect.left, m_rect.top, wil::rect_width(m_rect), wil::rect_height(m_rect),
+        m_bitmap_render_target->GetMemoryDC(), 0, 0, SRCCOPY);
+    m_is_active = false;
+}
+
+IDWriteTextRenderer* TextRenderBatch::get_renderer(const wil::com_ptr<IDWriteFactory1>& factory,
+    const RenderingParams::Ptr& rendering_params, COLORREF default_colour, bool is_selected)
+{
+    if (m_renderer && m_renderer_rendering_params == rendering_params) {
+        static_cast<GdiTextRenderer*>(m_renderer.get())->set_default_colour(default_colour, is_selected);
+        return m_renderer.get();
+    }
+
+    const auto bitmap_render_target_1 = m_bitmap_render_target.query<IDWriteBitmapRenderTarget1>();
+    THROW_IF_FAILED(bitmap_render_target_1->SetTextAntialiasMode(rendering_params->use_greyscale_antialiasing()
+            ? DWRITE_TEXT_ANTIALIAS_MODE_GRAYSCALE
+            : DWRITE_TEXT_ANTIALIAS_MODE_CLEARTYPE));
+
+    m_renderer = new GdiTextRenderer(factory, m_bitmap_render_target.get(), rendering_params->get(m_monitor).get(),
+        default_colour, is_selected, rendering_params->use_colour_glyphs());
+    m_renderer_rendering_params = rendering_params;
+
+    return m_renderer.get();
+}
+
 void TextFormat::set_text_alignment(DWRITE_TEXT_ALIGNMENT value) const
 {
     THROW_IF_FAILED(m_text_format->SetTextAlignment(value));
@@ -700,27 +947,79 @@ TextLayout TextFormat::create_text_layout(std::wstring_view text, float max_widt
 
 std::shared_ptr<TextLayout> TextFormat::get_cached_text_layout(std::wstring_view text_key, float max_width,
     float max_height, bool enable_ellipsis, DWRITE_TEXT_ALIGNMENT alignment,
-    const std::vector<uint8_t>& serialised_initial_format) const
+    const text_style::FormatPropertiesHandle& initial_format, bool allow_width_change, uint32_t layout_variant) const
 {
-    return m_text_layout_cache.get(
-        {text_key, max_width, max_height, enable_ellipsis, alignment, serialised_initial_format});
+    const TextLayoutCache<std::shared_ptr<TextLayout>>::CacheKeyView key_view{
+        text_key, max_width, max_height, enable_ellipsis, alignment, initial_format.id(), layout_variant};
+
+    if (auto text_layout = m_caches->text_layouts.get(key_view))
+        return text_layout;
+
+    if (!allow_width_change)
+        return {};
+
+    // While a column is being resized, the same text is typically laid out again
+    // at a slightly different width, so reuse an existing layout for it if possible.
+    // If its width can't be changed, it stays cached under its existing width.
+    try {
+        return m_caches->text_layouts.get_with_different_width(
+            key_view, [max_width](const std::shared_ptr<TextLayout>& text_layout) {
+                text_layout->set_max_width(max_width);
+            });
+    }
+    CATCH_LOG()
+
+    return {};
 }
 
 std::shared_ptr<TextLayout> TextFormat::create_cached_text_layout(std::wstring_view text, std::wstring_view text_key,
     float max_width, float max_height, bool enable_ellipsis, DWRITE_TEXT_ALIGNMENT alignment,
-    const std::vector<uint8_t>& serialised_initial_format) const
+    const text_style::FormatPropertiesHandle& initial_format, uint32_t layout_variant) const
 {
-    assert(!m_text_layout_cache.contains(
-        {text_key, max_width, max_height, enable_ellipsis, alignment, serialised_initial_format}));
+    const TextLayoutCache<std::shared_ptr<TextLayout>>::CacheKeyView key_view{
+        text_key, max_width, max_height, enable_ellipsis, alignment, initial_format.id(), layout_variant};
+
+    assert(!m_caches->text_layouts.contains(key_view));
 
     auto unwrapped_text_layout = create_unwrapped_text_layout(text, max_width, max_height, enable_ellipsis, alignment);
     const auto text_layout
         = std::make_shared<TextLayout>(m_factory, m_gdi_interop, unwrapped_text_layout, m_rendering_params);
-    m_text_layout_cache.put_new(
-        {text_key, max_width, max_height, enable_ellipsis, alignment, serialised_initial_format}, text_layout);
+    m_caches->text_layouts.put_new(key_view, text_layout);
     return text_layout;
 }
 
+void TextFormat::put_cached_text_layout(std::wstring_view text_key, float max_width, float max_height,
+    bool enable_ellipsis, DWRITE_TEXT_ALIGNMENT alignment, const text_style::FormatPropertiesHandle& initial_format,
+    std::shared_ptr<TextLayout> text_layout, uint32_t layout_variant, bool allow_evicting_current_frame) const
+{
+    const TextLayoutCache<std::shared_ptr<TextLayout>>::CacheKeyView key_view{
+        text_key, max_width, max_height, enable_ellipsis, alignment, initial_format.id(), layout_variant};
+
+    if (allow_evicting_current_frame)
+        m_caches->text_layouts.put(key_view, std::move(text_layout));
+    else
+        m_caches->text_layouts.put_without_evicting_current_frame(key_view, std::move(text_layout));
+}
+
+void TextFormat::prepare_for_background_layout_creation() const
+{
+    if (!m_trimming_sign)
+        THROW_IF_FAILED(m_factory->CreateEllipsisTrimmingSign(m_text_format.get(), &m_trimming_sign));
+
+    [[maybe_unused]] const auto typography = m_context->get_default_typography();
+}
+
+void TextFormat::begin_text_layout_cache_frame() const
+{
+    m_caches->text_layouts.start_new_frame();
+}
+
+void TextFormat::set_expected_visible_cell_count(const void* user, size_t count) const
+{
+    // Leave some headroom for partially visible rows and prefetched layouts
+    m_caches->text_layouts.set_min_size_for_user(user, count + count / 2);
+}
+
 float TextFormat::get_font_size_pt() const
 {
     return dip_to_pt(m_text_format->GetFontSize());
@@ -809,17 +1108,8 @@ TextFormat Context::create_text_format(const wil::com_ptr<IDWriteFont>& font, fl
 TextFormat Context::create_text_format(const wil::com_ptr<IDWriteFontFamily>& font_family, DWRITE_FONT_WEIGHT weight,
     DWRITE_FONT_STRETCH stretch, DWRITE_FONT_STYLE style, float font_size, const AxisValues& axis_values)
 {
-    wil::com_ptr<IDWriteLocalizedStrings> family_names;
-    THROW_IF_FAILED(font_family->GetFamilyNames(&family_names));
-
-    uint32_t length{};
-    THROW_IF_FAILED(family_names->GetStringLength(0, &length));
-
-    std::vector<wchar_t> family_name(length + 1, 0);
-
-    THROW_IF_FAILED(family_names->GetString(0, family_name.data(), length + 1));
-
-    return create_text_format(family_name.data(), weight, stretch, style, font_size, axis_values);
+    const auto family_name = get_first_family_name(font_family);
+    return create_text_format(family_name.c_str(), weight, stretch, style, font_size, axis_values);
 }
 
 TextFormat Context::create_text_format(const wchar_t* family_name, DWRITE_FONT_WEIGHT weight,
@@ -851,18 +1141,73 @@ TextFormat Context::create_text_format(const LOGFONT& log_font, float font_size)
 
 std::optional<TextFormat> Context::create_text_format_with_fallback(
     const LOGFONT& log_font, std::optional<float> font_size) noexcept
+{
+    return create_text_format_with_fallback(log_font, font_size, false);
+}
+
+TextFormat Context::get_shared_text_format(const wchar_t* family_name, DWRITE_FONT_WEIGHT weight,
+    DWRITE_FONT_STRETCH stretch, DWRITE_FONT_STYLE style, float font_size, const AxisValues& axis_values,
+    DWRITE_RENDERING_MODE rendering_mode, bool use_greyscale_antialiasing)
+{
+    TextFormatKey key{family_name, weight, stretch, style, font_size, make_axis_values_key(axis_values),
+        rendering_mode, use_greyscale_antialiasing};
+
+    // The lock is held while creating the text format, so that concurrent calls
+    // for the same key share one text format
+    std::scoped_lock lock(m_shared_text_formats_mutex);
+
+    if (const auto iter = m_shared_text_formats.find(key); iter != m_shared_text_formats.end()) {
+        if (auto caches = iter->second.caches.lock())
+            return {shared_from_this(), m_factory, m_gdi_interop, iter->second.text_format,
+                iter->second.rendering_params, std::move(caches)};
+    }
+
+    auto text_format = create_text_format(
+        family_name, weight, stretch, style, font_size, axis_values, rendering_mode, use_greyscale_antialiasing);
+
+    std::erase_if(m_shared_text_formats, [](auto&& item) { return item.second.caches.expired(); });
+    m_shared_text_formats.insert_or_assign(std::move(key),
+        SharedTextFormat{text_format.m_text_format, text_format.m_rendering_params, text_format.m_caches});
+
+    return text_format;
+}
+
+TextFormat Context::get_shared_text_format(const LOGFONT& log_font, float font_size)
+{
+    const auto font = create_font(log_font);
+
+    wil::com_ptr<IDWriteFontFamily> font_family;
+    THROW_IF_FAILED(font->GetFontFamily(&font_family));
+
+    const auto family_name = get_first_family_name(font_family);
+    return get_shared_text_format(family_name.c_str(), font->GetWeight(), font->GetStretch(), font->GetStyle(),
+        font_size > 0 ? font_size : px_to_dip(20.0f));
+}
+
+std::optional<TextFormat> Context::get_shared_text_format_with_fallback(
+    const LOGFONT& log_font, std::optional<float> font_size) noexcept
+{
+    return create_text_format_with_fallback(log_font, font_size, true);
+}
+
+std::optional<TextFormat> Context::create_text_format_with_fallback(
+    const LOGFONT& log_font, std::optional<float> font_size, bool use_shared_text_formats) noexcept
 {
     const auto resolved_size = font_size.value_or(-px_to_dip(gsl::narrow_cast<float>(log_font.lfHeight)));
 
     try {
-        return create_text_format(log_font, resolved_size);
+        return use_shared_text_formats ? get_shared_text_format(log_font, resolved_size)
+                                       : create_text_format(log_font, resolved_size);
     }
     CATCH_LOG()
 
+    const auto weight = static_cast<DWRITE_FONT_WEIGHT>(std::clamp(log_font.lfWeight, 1l, 999l));
+    const auto style = log_font.lfItalic ? DWRITE_FONT_STYLE_ITALIC : DWRITE_FONT_STYLE_NORMAL;
+
     try {
-        return create_text_format(L"", static_cast<DWRITE_FONT_WEIGHT>(std::clamp(log_font.lfWeight, 1l, 999l)),
-            DWRITE_FONT_STRETCH_NORMAL, log_font.lfItalic ? DWRITE_FONT_STYLE_ITALIC : DWRITE_FONT_STYLE_NORMAL,
-            resolved_size);
+        return use_shared_text_formats
+            ? get_shared_text_format(L"", weight, DWRITE_FONT_STRETCH_NORMAL, style, resolved_size)
+            : create_text_format(L"", weight, DWRITE_FONT_STRETCH_NORMAL, style, resolved_size);
     }
     CATCH_LOG()
 
@@ -885,7 +1230,8 @@ TextFormat Context::wrap_text_format(wil::com_ptr<IDWriteTextFormat> text_format
     const auto rendering_params
         = std::make_shared<RenderingParams>(m_factory, rendering_mode, use_greyscale_antialiasing, use_colour_glyphs);
 
-    return {shared_from_this(), m_factory, m_gdi_interop, std::move(text_format), rendering_params, layout_cache_size};
+    return {shared_from_this(), m_factory, m_gdi_interop, std::move(text_format), rendering_params, layout_cache_size,
+        m_text_layout_cache_budget};
 }
 
 wil::com_ptr<IDWriteFontFallback> Context::create_emoji_font_fallback(
@@ -913,132 +1259,268 @@ wil::com_ptr<IDWriteTypography> Context::get_default_typography()
     return m_default_typography;
 }
 
+void Context::set_text_layout_cache_budget(std::optional<size_t> max_bytes)
+{
+    if (max_bytes && m_text_layout_cache_budget) {
+        m_text_layout_cache_budget->set_max_bytes(*max_bytes);
+        return;
+    }
+
+    if (!max_bytes && !m_text_layout_cache_budget)
+        return;
+
+    // Shared text formats keep the budget they were created with, so stop
+    // handing them out
+    {
+        std::scoped_lock lock(m_shared_text_formats_mutex);
+        m_shared_text_formats.clear();
+    }
+
+    m_text_layout_cache_budget = max_bytes ? std::make_shared<TextLayoutCacheBudget>(*max_bytes) : nullptr;
+}
+
+namespace {
+
+struct SystemFontCollections {
+    wil::com_ptr<IDWriteFontCollection3> typographic;
+    wil::com_ptr<IDWriteFontCollection> wss;
+    wil::com_ptr<IDWriteFontSet4> font_set;
+};
+
+SystemFontCollections get_system_font_collections(const wil::com_ptr<IDWriteFactory1>& factory)
+{
+    auto typographic_font_collection = get_typographic_font_collection(factory);
+    auto font_set = typographic_font_collection ? get_font_set_4(factory) : nullptr;
+
+    return {std::move(typographic_font_collection), get_wss_font_collection(factory), std::move(font_set)};
+}
+
+std::optional<ResolvedFontNames> resolve_font_names_uncached(
+    const SystemFontCollections& collections, const FontNamesQuery& query)
+{
+    const auto family_name
+        = query.typographic_family_name.empty() ? query.wss_family_name.c_str() : query.typographic_family_name.c_str();
+
+    wil::com_ptr<IDWriteFont> font;
+    wil::com_ptr<IDWriteFontFamily> font_family;
+
+    if (collections.typographic) {
+        auto axis_values_vector = axis_values_to_vector(query.axis_values);
+
+        if (axis_values_vector.empty()) {
+            axis_values_vector.resize(DWRITE_STANDARD_FONT_AXIS_COUNT);
+
+            const auto written_axis_count = collections.font_set->ConvertWeightStretchStyleToFontAxisValues(
+                nullptr, 0, query.weight, query.stretch, query.style, 0, axis_values_vector.data());
+
+            axis_values_vector.resize(written_axis_count);
+        }
+
+        wil::com_ptr<IDWriteFontList2> font_list;
+
+        THROW_IF_FAILED(collections.typographic->GetMatchingFonts(
+            family_name, axis_values_vector.data(), gsl::narrow<uint32_t>(axis_values_vector.size()), &font_list));
+
+        if (font_list->GetFontCount() == 0)
+            return {};
+
+        THROW_IF_FAILED(font_list->GetFont(0, &font));
+
+        THROW_IF_FAILED(font->GetFontFamily(&font_family));
+    } else {
+        BOOL exists{};
+        uint32_t index{};
+        THROW_IF_FAILED(collections.wss->FindFamilyName(query.wss_family_name.c_str(), &index, &exists));
+
+        if (!exists)
+            return {};
+
+        THROW_IF_FAILED(collections.wss->GetFontFamily(index, &font_family));
+
+        THROW_IF_FAILED(font_family->GetFirstMatchingFont(query.weight, query.stretch, query.style, &font));
+    }
+
+    wil::com_ptr<IDWriteLocalizedStrings> face_names;
+    THROW_IF_FAILED(font->GetFaceNames(&face_names));
+
+    wil::com_ptr<IDWriteLocalizedStrings> family_names;
+    THROW_IF_FAILED(font_family->GetFamilyNames(&family_names));
+
+    return ResolvedFontNames{get_localised_string(family_names), get_localised_string(face_names)};
+}
+
+} // namespace
+
+void Context::validate_resolved_fonts_caches(const wil::com_ptr<IDWriteFontCollection>& font_collection) const
+{
+    if (m_resolved_fonts_collection == font_collection)
+        return;
+
+    m_resolved_fonts_collection = font_collection;
+    m_resolved_font_names.clear();
+    m_wss_and_logfonts.clear();
+}
+
 std::optional<ResolvedFontNames> Context::resolve_font_names(const wchar_t* wss_family_name,
     const wchar_t* typographic_family_name, DWRITE_FONT_WEIGHT weight, DWRITE_FONT_STRETCH stretch,
     DWRITE_FONT_STYLE style, const AxisValues& axis_values) const
 {
-    const auto family_name = wcsnlen(typographic_family_name, 1) > 0 ? typographic_family_name : wss_family_name;
+    const FontNamesQuery query{wss_family_name, typographic_family_name, weight, stretch, style, axis_values};
+    return std::move(resolve_font_names(std::span(&query, 1)).front());
+}
+
+std::vector<std::optional<ResolvedFontNames>> Context::resolve_font_names(
+    std::span<const FontNamesQuery> queries) const
+{
+    std::vector<std::optional<ResolvedFontNames>> results(queries.size());
 
     try {
-        const auto typographic_font_collection = get_typographic_font_collection(m_factory);
-        const auto wss_font_collection = get_wss_font_collection(m_factory);
-        wil::com_ptr<IDWriteFont> font;
-        wil::com_ptr<IDWriteFontFamily> font_family;
+        const auto collections = get_system_font_collections(m_factory);
 
-        if (typographic_font_collection) {
-            auto axis_values_vector = axis_values_to_vector(axis_values);
+        const auto keys = queries | ranges::views::transform([](auto&& query) {
+            return FontNamesKey{query.wss_family_name, query.typographic_family_name, query.weight, query.stretch,
+                query.style, make_axis_values_key(query.axis_values)};
+        }) | ranges::to<std::vector>;
 
-            if (axis_values_vector.empty()) {
-                axis_values_vector.resize(DWRITE_STANDARD_FONT_AXIS_COUNT);
+        std::vector<size_t> uncached_indices;
 
-                const auto system_font_set = get_font_set_4(m_factory);
-                const auto written_axis_count = system_font_set->ConvertWeightStretchStyleToFontAxisValues(
-                    nullptr, 0, weight, stretch, style, 0, axis_values_vector.data());
+        {
+            std::scoped_lock lock(m_resolved_fonts_mutex);
+            validate_resolved_fonts_caches(collections.wss);
 
-                axis_values_vector.resize(written_axis_count);
+            for (const auto index : std::ranges::views::iota(size_t{}, keys.size())) {
+                if (const auto iter = m_resolved_font_names.find(keys[index]); iter != m_resolved_font_names.end())
+                    results[index] = iter->second;
+                else
+                    uncached_indices.emplace_back(index);
             }
+        }
 
-            wil::com_ptr<IDWriteFontList2> font_list;
-
-            THROW_IF_FAILED(typographic_font_collection->GetMatchingFonts(
-                family_name, axis_values_vector.data(), gsl::narrow<uint32_t>(axis_values_vector.size()), &font_list));
+        if (uncached_indices.empty())
+            return results;
 
-            if (font_list->GetFontCount() == 0)
-                return {};
+        // The lock isn't held while resolving fonts, as that can be slow
+        std::vector<size_t> resolved_indices;
 
-            THROW_IF_FAILED(font_list->GetFont(0, &font));
+        for (const auto index : uncached_indices) {
+            try {
+                results[index] = resolve_font_names_uncached(collections, queries[index]);
+                resolved_indices.emplace_back(index);
+            }
+            CATCH_LOG()
+        }
 
-            THROW_IF_FAILED(font->GetFontFamily(&font_family));
-        } else {
-            BOOL exists{};
-            uint32_t index{};
-            THROW_IF_FAILED(wss_font_collection->FindFamilyName(wss_family_name, &index, &exists));
+        std::scoped_lock lock(m_resolved_fonts_mutex);
 
-            if (!exists)
-                return {};
+        if (m_resolved_fonts_collection != collections.wss)
+            return results;
 
-            THROW_IF_FAILED(wss_font_collection->GetFontFamily(index, &font_family));
+        for (const auto index : resolved_indices) {
+            if (m_resolved_font_names.size() >= max_resolved_fonts)
+                m_resolved_font_names.clear();
 
-            THROW_IF_FAILED(font_family->GetFirstMatchingFont(weight, stretch, style, &font));
+            m_resolved_font_names.insert_or_assign(keys[index], results[index]);
         }
-
-        wil::com_ptr<IDWriteLocalizedStrings> face_names;
-        THROW_IF_FAILED(font->GetFaceNames(&face_names));
-
-        wil::com_ptr<IDWriteLocalizedStrings> family_names;
-        THROW_IF_FAILED(font_family->GetFamilyNames(&family_names));
-
-        return ResolvedFontNames{get_localised_string(family_names), get_localised_string(face_names)};
     }
     CATCH_LOG()
 
-    return {};
+    return results;
 }
 
 std::optional<std::tuple<WeightStretchStyle, LOGFONT>> Context::get_wss_and_logfont_for_axis_values(
     const wchar_t* typographic_family_name, const AxisValues& axis_values) const
 {
     try {
-        const auto system_font_set = get_font_set_4(m_factory);
+        const auto font_collection = get_wss_font_collection(m_factory);
+        AxisValuesFontKey key{typographic_family_name, make_axis_values_key(axis_values)};
 
-        if (!system_font_set)
-            return {};
+        {
+            std::scoped_lock lock(m_resolved_fonts_mutex);
+            validate_resolved_fonts_caches(font_collection);
 
-        const auto axis_values_vector = axis_values_to_vector(axis_values);
+            if (const auto iter = m_wss_and_logfonts.find(key); iter != m_wss_and_logfonts.end())
+                return iter->second;
+        }
 
-        const auto find_matching_font_face
-            = [&system_font_set, &axis_values_vector](const auto* font_family) -> wil::com_ptr<IDWriteFontFace6> {
-            wil::com_ptr<IDWriteFontSet4> matching_fonts;
-            THROW_IF_FAILED(system_font_set->GetMatchingFonts(font_family, axis_values_vector.data(),
-                gsl::narrow<uint32_t>(axis_values_vector.size()),
-                DWRITE_FONT_SIMULATIONS_BOLD | DWRITE_FONT_SIMULATIONS_OBLIQUE, &matching_fonts));
+        auto result = get_wss_and_logfont_for_axis_values_uncached(typographic_family_name, axis_values);
 
-            if (matching_fonts->GetFontCount() == 0)
-                return {};
+        std::scoped_lock lock(m_resolved_fonts_mutex);
 
-            wil::com_ptr<IDWriteFontFace5> font_face_5;
-            THROW_IF_FAILED(matching_fonts->CreateFontFace(0, &font_face_5));
+        if (m_resolved_fonts_collection == font_collection) {
+            if (m_wss_and_logfonts.size() >= max_resolved_fonts)
+                m_wss_and_logfonts.clear();
 
-            return font_face_5.query<IDWriteFontFace6>();
-        };
+            m_wss_and_logfonts.insert_or_assign(std::move(key), result);
+        }
 
-        auto font_face_6 = find_matching_font_face(typographic_family_name);
+        return result;
+    }
+    CATCH_LOG()
 
-        if (!font_face_6)
+    return {};
+}
+
+std::optional<std::tuple<WeightStretchStyle, LOGFONT>> Context::get_wss_and_logfont_for_axis_values_uncached(
+    const wchar_t* typographic_family_name, const AxisValues& axis_values) const
+{
+    const auto system_font_set = get_font_set_4(m_factory);
+
+    if (!system_font_set)
+        return {};
+
+    const auto axis_values_vector = axis_values_to_vector(axis_values);
+
+    const auto find_matching_font_face
+        = [&system_font_set, &axis_values_vector](const auto* font_family) -> wil::com_ptr<IDWriteFontFace6> {
+        wil::com_ptr<IDWriteFontSet4> matching_fonts;
+        THROW_IF_FAILED(system_font_set->GetMatchingFonts(font_family, axis_values_vector.data(),
+            gsl::narrow<uint32_t>(axis_values_vector.size()),
+            DWRITE_FONT_SIMULATIONS_BOLD | DWRITE_FONT_SIMULATIONS_OBLIQUE, &matching_fonts));
+
+        if (matching_fonts->GetFontCount() == 0)
             return {};
 
-        wil::com_ptr<IDWriteLocalizedStrings> family_names;
-        THROW_IF_FAILED(font_face_6->GetFamilyNames(DWRITE_FONT_FAMILY_MODEL_WEIGHT_STRETCH_STYLE, &family_names));
+        wil::com_ptr<IDWriteFontFace5> font_face_5;
+        THROW_IF_FAILED(matching_fonts->CreateFontFace(0, &font_face_5));
 
-        auto family_name = get_localised_string(family_names);
+        return font_face_5.query<IDWriteFontFace6>();
+    };
 
-        // Check if this family name actually exists (yes, sometimes it returns invalid values)
-        font_face_6 = find_matching_font_face(family_name.c_str());
+    auto font_face_6 = find_matching_font_face(typographic_family_name);
 
-        if (!font_face_6) {
-            font_face_6 = find_matching_font_face(L"Segoe UI");
+    if (!font_face_6)
+        return {};
 
-            if (!font_face_6)
-                return {};
+    wil::com_ptr<IDWriteLocalizedStrings> family_names;
+    THROW_IF_FAILED(font_face_6->GetFamilyNames(DWRITE_FONT_FAMILY_MODEL_WEIGHT_STRETCH_STYLE, &family_names));
 
-            THROW_IF_FAILED(font_face_6->GetFamilyNames(DWRITE_FONT_FAMILY_MODEL_WEIGHT_STRETCH_STYLE, &family_names));
+    auto family_name = get_localised_string(family_names);
 
-            family_name = get_localised_string(family_names);
-        }
+    // Check if this family name actually exists (yes, sometimes it returns invalid values)
+    font_face_6 = find_matching_font_face(family_name.c_str());
 
-        const auto wss = WeightStretchStyle{
-            family_name, font_face_6->GetWeight(), font_face_6->GetStretch(), font_face_6->GetStyle()};
+    if (!font_face_6) {
+        font_face_6 = find_matching_font_face(L"Segoe UI");
 
-        const auto log_font = create_log_font(font_face_6);
+        if (!font_face_6)
+            return {};
 
-        return std::make_tuple(wss, log_font);
+        THROW_IF_FAILED(font_face_6->GetFamilyNames(DWRITE_FONT_FAMILY_MODEL_WEIGHT_STRETCH_STYLE, &family_names));
+
+        family_name = get_localised_string(family_names);
     }
-    CATCH_LOG()
 
-    return {};
+    const auto wss = WeightStretchStyle{
+        family_name, font_face_6->GetWeight(), font_face_6->GetStretch(), font_face_6->GetStyle()};
+
+    const auto log_font = create_log_font(font_face_6);
+
+    return std::make_tuple(wss, log_font);
 }
 
-std::vector<Font> FontFamily::fonts() const
+namespace {
+
+std::vector<Font> create_font_family_fonts(const wil::com_ptr<IDWriteFontFamily>& family)
 {
     std::vector<Font> fonts;
 
@@ -1093,6 +1575,21 @@ std::vector<Font> FontFamily::fonts() const
     return fonts;
 }
 
+} // namespace
+
+std::vector<Font> FontFamily::fonts() const
+{
+    if (!details)
+        return create_font_family_fonts(family);
+
+    std::scoped_lock lock(details->mutex);
+
+    if (!details->fonts)
+        details->fonts = create_font_family_fonts(family);
+
+    return *details->fonts;
+}
+
 std::wstring_view FontFamily::typographic_name() const
 {
     return is_typographic_model ? std::wstring_view(name) : L""sv;
@@ -1122,11 +1619,10 @@ std::wstring FontFamily::wss_name(const Font& font) const
     return name;
 }
 
-std::vector<AxisRange> FontFamily::axes() const
-{
-    if (!is_typographic_model)
-        return {};
+namespace {
 
+std::vector<AxisRange> create_font_family_axes(const wil::com_ptr<IDWriteFontFamily>& family)
+{
     try {
         std::vector<DWRITE_FONT_AXIS_RANGE> axis_ranges;
         std::unordered_map<uint32_t, std::set<std::tuple<float, float>>> unique_axis_ranges_map;
@@ -1203,8 +1699,35 @@ std::vector<AxisRange> FontFamily::axes() const
     return {};
 }
 
+} // namespace
+
+std::vector<AxisRange> FontFamily::axes() const
+{
+    if (!is_typographic_model)
+        return {};
+
+    if (!details)
+        return create_font_family_axes(family);
+
+    std::scoped_lock lock(details->mutex);
+
+    if (!details->axes)
+        details->axes = create_font_family_axes(family);
+
+    return *details->axes;
+}
+
 std::vector<FontFamily> Context::get_font_families() const
 {
+    // This is only used to detect changes to the system font collection, as
+    // it's the only way of requesting a check for them
+    const auto current_font_collection = get_wss_font_collection(m_factory, true);
+
+    std::scoped_lock lock(m_font_families_mutex);
+
+    if (m_font_families_collection == current_font_collection)
+        return m_font_families;
+
     const auto typographic_font_collection = get_typographic_font_collection(m_factory);
 
     const wil::com_ptr<IDWriteFontCollection> font_collection
@@ -1233,6 +1756,26 @@ std::vector<FontFamily> Context::get_font_families() const
         families, [](auto&& left, auto&& right) { return StrCmpLogicalW(left.name.c_str(), right.name.c_str()); },
         false);
 
+    m_font_families_collection = current_font_collection;
+    m_font_families = families;
+
+    // Copies of FontFamily share their details, so this fills in the details
+    // of the cached families
+    m_font_families_thread = std::jthread([families](std::stop_token stop_token) {
+        mmh::set_thread_description(GetCurrentThread(), font_families_thread_name.c_str());
+
+        for (auto&& family : families) {
+            if (stop_token.stop_requested())
+                return;
+
+            try {
+                family.fonts();
+                family.axes();
+            }
+            CATCH_LOG()
+        }
+    });
+
     return families;
 }
 
@@ -6,6 +6,24 @@ namespace uih::direct_write {
 
 using AxisValues = std::unordered_map<uint32_t, float>;
 
+/**
+ * Get the monitor used for the rendering parameters of text in a window.
+ *
+ * When rendering many text layouts, call this once (e.g. once per WM_PAINT)
+ * and pass the result to the rendering functions, as it's relatively slow.
+ */
+HMONITOR get_window_monitor(HWND wnd);
+
+/**
+ * Discard all cached rendering parameters.
+ *
+ * Call this when display or font smoothing settings change. The system only
+ * sends WM_SETTINGCHANGE and WM_DISPLAYCHANGE to top-level windows, so this
+ * must be called from a top-level window procedure. ContainerWindow does this
+ * when it's used as a top-level window; other hosts need to do it themselves.
+ */
+void invalidate_rendering_params();
+
 class RenderingParams {
 public:
     using Ptr = std::shared_ptr<RenderingParams>;
@@ -20,6 +38,7 @@ public:
     }
 
     wil::com_ptr<IDWriteRenderingParams> get(HWND wnd) const;
+    wil::com_ptr<IDWriteRenderingParams> get(HMONITOR monitor) const;
     DWRITE_RENDERING_MODE rendering_mode() const { return m_rendering_mode; }
     D2D1_TEXT_ANTIALIAS_MODE d2d_text_antialiasing_mode() const
     {
@@ -38,6 +57,7 @@ public:
 private:
     mutable wil::com_ptr<IDWriteRenderingParams> m_rendering_params;
     mutable HMONITOR m_monitor{};
+    mutable uint64_t m_generation{};
 
     wil::com_ptr<IDWriteFactory1> m_factory;
     DWRITE_RENDERING_MODE m_rendering_mode{};
@@ -45,6 +65,8 @@ private:
     bool m_use_colour_glyphs{true};
 };
 
+class TextRenderBatch;
+
 struct EmojiFontSelectionConfig {
     std::wstring colour_emoji_family_name{};
     std::wstring monochrome_emoji_family_name{};
@@ -71,12 +93,32 @@ public:
     DWRITE_OVERHANG_METRICS get_overhang_metrics() const;
     [[nodiscard]] bool is_trimmed() const;
 
+    [[nodiscard]] std::vector<DWRITE_CLUSTER_METRICS> get_cluster_metrics() const;
+
+    /**
+     * \param monitor  The monitor returned by get_window_monitor() for wnd. If
+     *                 null, it's determined from wnd.
+     */
     void render_with_transparent_background(HWND wnd, HDC dc, RECT output_rect, COLORREF default_colour,
         bool is_selected = false, float x_origin_offset = 0.0f,
-        wil::com_ptr<IDWriteBitmapRenderTarget> bitmap_render_target = {}) const;
+        wil::com_ptr<IDWriteBitmapRenderTarget> bitmap_render_target = {}, HMONITOR monitor = nullptr) const;
+
+    /**
+     * Render the text layout as part of a batch.
+     *
+     * This is equivalent to render_with_transparent_background(), except that the
+     * text is drawn to the device context when the batch ends.
+     */
+    void render_with_transparent_background(TextRenderBatch& batch, RECT output_rect, COLORREF default_colour,
+        bool is_selected = false, float x_origin_offset = 0.0f) const;
 
     void set_colour(COLORREF colour, COLORREF selected_colour, DWRITE_TEXT_RANGE text_range) const;
     void set_effect(IUnknown* effect, DWRITE_TEXT_RANGE text_range) const;
+
+    /**
+     * Replace a character with empty space of the specified width (in DIPs).
+     */
+    void set_spacer(uint32_t position, float width) const;
     void set_max_height(float value) const;
     void set_max_width(float value) const;
     void set_underline(bool is_underlined, DWRITE_TEXT_RANGE text_range);
@@ -98,6 +140,66 @@ private:
     bool m_has_underline{};
 };
 
+/**
+ * Renders multiple text layouts to a GDI device context using one bitmap render
+ * target.
+ *
+ * The background is copied from the device context to the bitmap render target
+ * once, before the first text layout is rendered, and copied back once when the
+ * batch ends. (Rendering text layouts individually copies the background to and
+ * from the device context for each text layout.)
+ *
+ * Nothing else should be drawn within the batch rect while the batch is active,
+ * as it will be overwritten when the batch ends.
+ */
+class TextRenderBatch {
+public:
+    /**
+     * \param rect     The area of the device context that text will be rendered
+     *                 to. This is clipped to the clip box of the device context.
+     * \param monitor  The monitor returned by get_window_monitor() for wnd. If
+     *                 null, it's determined from wnd.
+     */
+    TextRenderBatch(HWND wnd, HDC dc, const RECT& rect, wil::com_ptr<IDWriteBitmapRenderTarget> bitmap_render_target,
+        HMONITOR monitor = nullptr);
+    ~TextRenderBatch();
+
+    TextRenderBatch(const TextRenderBatch&) = delete;
+    TextRenderBatch& operator=(const TextRenderBatch&) = delete;
+
+    /**
+     * Copy rendered text to the device context.
+     *
+     * This is called automatically when the batch is destroyed.
+     */
+    void end();
+
+private:
+    friend class TextLayout;
+
+    /**
+     * Copy the background to the bitmap render target, if not already done.
+     */
+    void begin();
+
+    /**
+     * Get a text renderer that draws to the bitmap render target.
+     *
+     * The same renderer is reused while the rendering parameters are unchanged.
+     */
+    IDWriteTextRenderer* get_renderer(const wil::com_ptr<IDWriteFactory1>& factory,
+        const RenderingParams::Ptr& rendering_params, COLORREF default_colour, bool is_selected);
+
+    HWND m_wnd{};
+    HMONITOR m_monitor{};
+    HDC m_dc{};
+    RECT m_rect{};
+    wil::com_ptr<IDWriteBitmapRenderTarget> m_bitmap_render_target;
+    wil::com_ptr<IDWriteTextRenderer> m_renderer;
+    RenderingParams::Ptr m_renderer_rendering_params;
+    bool m_is_active{};
+};
+
 struct TextPosition {
     int left{};
     float left_remainder_dip{};
@@ -106,17 +208,55 @@ struct TextPosition {
     int height{};
 };
 
+/**
+ * The widths, in DIPs, of the tab-separated columns of some text.
+ *
+ * These are empty if the columns can't be rendered using a single text layout.
+ */
+struct TabColumnWidths {
+    /** The width of each column excluding trailing whitespace, as with DWRITE_TEXT_METRICS::width */
+    std::vector<float> widths;
+    /** The width of each column including trailing whitespace */
+    std::vector<float> advance_widths;
+};
+
+/**
+ * Caches of a text format.
+ *
+ * These are shared by copies of a TextFormat.
+ */
+struct TextFormatCaches {
+    TextFormatCaches(size_t layout_cache_size, TextLayoutCacheBudget::Ptr layout_cache_budget)
+        : text_layouts(layout_cache_size, std::move(layout_cache_budget))
+    {
+    }
+
+    TextLayoutCache<std::shared_ptr<TextLayout>> text_layouts;
+    TextWidthCache text_widths{4096};
+    GenerationalTextCache<TabColumnWidths> tab_column_widths{1024};
+};
+
 class TextFormat {
 public:
     TextFormat(std::shared_ptr<class Context> context, wil::com_ptr<IDWriteFactory1> factory,
         wil::com_ptr<IDWriteGdiInterop> gdi_interop, wil::com_ptr<IDWriteTextFormat> text_format,
-        RenderingParams::Ptr rendering_params, size_t layout_cache_size = 32)
+        RenderingParams::Ptr rendering_params, size_t layout_cache_size = 32,
+        TextLayoutCacheBudget::Ptr layout_cache_budget = {})
+        : TextFormat(std::move(context), std::move(factory), std::move(gdi_interop), std::move(text_format),
+              std::move(rendering_params),
+              std::make_shared<TextFormatCaches>(layout_cache_size, std::move(layout_cache_budget)))
+    {
+    }
+
+    TextFormat(std::shared_ptr<class Context> context, wil::com_ptr<IDWriteFactory1> factory,
+        wil::com_ptr<IDWriteGdiInterop> gdi_interop, wil::com_ptr<IDWriteTextFormat> text_format,
+        RenderingParams::Ptr rendering_params, std::shared_ptr<TextFormatCaches> caches)
         : m_context(std::move(context))
         , m_factory(std::move(factory))
         , m_gdi_interop(std::move(gdi_interop))
         , m_text_format(std::move(text_format))
         , m_rendering_params(std::move(rendering_params))
-        , m_text_layout_cache(layout_cache_size)
+        , m_caches(std::move(caches))
     {
     }
 
@@ -131,20 +271,117 @@ public:
     [[nodiscard]] TextLayout create_text_layout(std::wstring_view text, float max_width, float max_height,
         bool enable_ellipsis = false, std::optional<DWRITE_TEXT_ALIGNMENT> alignment = {}) const;
 
+    /**
+     * Get a cached text layout.
+     *
+     * If there is no exact match and allow_width_change is true, a cached layout
+     * for the same text and format that hasn't been used since
+     * begin_text_layout_cache_frame() was last called may be returned after
+     * changing its maximum width.
+     *
+     * layout_variant distinguishes layouts of the same text that the caller
+     * lays out differently in other ways.
+     */
     [[nodiscard]] std::shared_ptr<TextLayout> get_cached_text_layout(std::wstring_view text_key, float max_width,
         float max_height, bool enable_ellipsis, DWRITE_TEXT_ALIGNMENT alignment,
-        const std::vector<uint8_t>& serialised_initial_format) const;
+        const text_style::FormatPropertiesHandle& initial_format, bool allow_width_change = true,
+        uint32_t layout_variant = 0) const;
 
     /**
      * Only valid to call this if get_cached_text_layout() returned an empty std::shared_ptr.
      */
     [[nodiscard]] std::shared_ptr<TextLayout> create_cached_text_layout(std::wstring_view text,
         std::wstring_view text_key, float max_width, float max_height, bool enable_ellipsis,
-        DWRITE_TEXT_ALIGNMENT alignment, const std::vector<uint8_t>& serialised_initial_format) const;
+        DWRITE_TEXT_ALIGNMENT alignment, const text_style::FormatPropertiesHandle& initial_format,
+        uint32_t layout_variant = 0) const;
+
+    /**
+     * Add a text layout created using create_text_layout() to the cache.
+     *
+     * Does nothing if a layout with the same key is already cached. If
+     * allow_evicting_current_frame is false, the layout is also not added if
+     * that would evict a layout used since begin_text_layout_cache_frame() was
+     * last called.
+     */
+    void put_cached_text_layout(std::wstring_view text_key, float max_width, float max_height, bool enable_ellipsis,
+        DWRITE_TEXT_ALIGNMENT alignment, const text_style::FormatPropertiesHandle& initial_format,
+        std::shared_ptr<TextLayout> text_layout, uint32_t layout_variant = 0,
+        bool allow_evicting_current_frame = true) const;
+
+    /**
+     * Initialise resources that are otherwise lazily created by create_text_layout().
+     *
+     * Must be called before create_text_layout() is called from a thread other
+     * than the one that owns this object.
+     */
+    void prepare_for_background_layout_creation() const;
+
+    /**
+     * Call this before rendering a set of text layouts obtained using get_cached_text_layout().
+     *
+     * This stops get_cached_text_layout() from changing the width of layouts
+     * that are still being rendered at a different width.
+     */
+    void begin_text_layout_cache_frame() const;
+
+    /**
+     * Get the cached width, in DIPs, of text with style codes processed.
+     */
+    [[nodiscard]] std::optional<float> get_cached_text_width(
+        std::wstring_view text, const text_style::FormatPropertiesHandle& initial_format) const
+    {
+        return m_caches->text_widths.get(text, initial_format.id());
+    }
+
+    void put_cached_text_width(
+        std::wstring_view text, const text_style::FormatPropertiesHandle& initial_format, float width) const
+    {
+        m_caches->text_widths.put(text, initial_format.id(), width);
+    }
+
+    /**
+     * Get the cached widths of the tab-separated columns of text (with style
+     * codes processed).
+     */
+    [[nodiscard]] std::optional<TabColumnWidths> get_cached_tab_column_widths(
+        std::wstring_view text, const text_style::FormatPropertiesHandle& initial_format) const
+    {
+        return m_caches->tab_column_widths.get(text, initial_format.id());
+    }
+
+    void put_cached_tab_column_widths(std::wstring_view text, const text_style::FormatPropertiesHandle& initial_format,
+        TabColumnWidths widths) const
+    {
+        m_caches->tab_column_widths.put(text, initial_format.id(), std::move(widths));
+    }
+
+    [[nodiscard]] size_t get_text_layout_cache_capacity() const { return m_caches->text_layouts.max_size(); }
+
+    /**
+     * Hint how many text layouts a user of this text format (for example, a
+     * window) expects to be visible at once.
+     *
+     * The text layout cache adapts its size automatically, but this lets it
+     * grow to a sufficient size straight away. It also stops the cache from
+     * shrinking below what's needed to hold the visible text layouts.
+     *
+     * The counts of all users of the same cache (including users of copies of
+     * this text format) are added together. Pass a count of zero when a user
+     * stops using this text format.
+     */
+    void set_expected_visible_cell_count(const void* user, size_t count) const;
+
+    /** Whether this and another text format share the same caches (for example, because one is a copy of the other) */
+    [[nodiscard]] bool shares_caches_with(const TextFormat& other) const { return m_caches == other.m_caches; }
+
+    [[nodiscard]] TextLayoutCacheStats get_text_layout_cache_stats() const { return m_caches->text_layouts.stats(); }
+    void reset_text_layout_cache_stats() const { m_caches->text_layouts.reset_stats(); }
 
     [[nodiscard]] float get_font_size_pt() const;
 
 private:
+    friend class Context;
+
     [[nodiscard]] wil::com_ptr<IDWriteTextLayout> create_unwrapped_text_layout(std::wstring_view text, float max_width,
         float max_height, bool enable_ellipsis, std::optional<DWRITE_TEXT_ALIGNMENT> alignment) const;
 
@@ -154,7 +391,7 @@ private:
     wil::com_ptr<IDWriteGdiInterop> m_gdi_interop;
     wil::com_ptr<IDWriteTextFormat> m_text_format;
     RenderingParams::Ptr m_rendering_params;
-    mutable TextLayoutCache<std::shared_ptr<TextLayout>> m_text_layout_cache;
+    std::shared_ptr<TextFormatCaches> m_caches;
 };
 
 struct Font {
@@ -173,11 +410,22 @@ struct AxisRange {
     bool is_toggle{};
 };
 
+/**
+ * Fonts and axes of a font family, computed on first use.
+ */
+struct FontFamilyDetails {
+    std::mutex mutex;
+    std::optional<std::vector<Font>> fonts;
+    std::optional<std::vector<AxisRange>> axes;
+};
+
 struct FontFamily {
     wil::com_ptr<IDWriteFontFamily> family;
     std::wstring name;
     bool is_typographic_model;
     bool is_symbol_font{};
+    /** Shared by copies of this object, so that fonts() and axes() only query DirectWrite once */
+    std::shared_ptr<FontFamilyDetails> details{std::make_shared<FontFamilyDetails>()};
 
     std::vector<Font> fonts() const;
     std::wstring_view typographic_name() const;
@@ -197,6 +445,15 @@ struct ResolvedFontNames {
     std::wstring face_name;
 };
 
+struct FontNamesQuery {
+    std::wstring wss_family_name;
+    std::wstring typographic_family_name;
+    DWRITE_FONT_WEIGHT weight{DWRITE_FONT_WEIGHT_REGULAR};
+    DWRITE_FONT_STRETCH stretch{DWRITE_FONT_STRETCH_NORMAL};
+    DWRITE_FONT_STYLE style{DWRITE_FONT_STYLE_NORMAL};
+    AxisValues axis_values;
+};
+
 class Context : public std::enable_shared_from_this<Context> {
 public:
     using Ptr = std::shared_ptr<Context>;
@@ -236,6 +493,27 @@ public:
     std::optional<TextFormat> create_text_format_with_fallback(
         const LOGFONT& log_font, std::optional<float> font_size = {}) noexcept;
 
+    /**
+     * Get a text format shared with other callers requesting the same font,
+     * size and rendering options.
+     *
+     * Shared text formats also share their text layout and text width caches,
+     * and are kept for as long as a copy of them exists. They must not be
+     * modified (for example, using TextFormat::set_text_alignment()), as that
+     * would affect all users of them.
+     *
+     * This can be called from any thread, but the caches of a shared text
+     * format must only be used on one thread.
+     */
+    TextFormat get_shared_text_format(const wchar_t* family_name, DWRITE_FONT_WEIGHT weight,
+        DWRITE_FONT_STRETCH stretch, DWRITE_FONT_STYLE style, float font_size, const AxisValues& axis_values = {},
+        DWRITE_RENDERING_MODE rendering_mode = DWRITE_RENDERING_MODE_DEFAULT, bool use_greyscale_antialiasing = false);
+
+    TextFormat get_shared_text_format(const LOGFONT& log_font, float font_size);
+
+    std::optional<TextFormat> get_shared_text_format_with_fallback(
+        const LOGFONT& log_font, std::optional<float> font_size = {}) noexcept;
+
     TextFormat wrap_text_format(wil::com_ptr<IDWriteTextFormat> text_format,
         DWRITE_RENDERING_MODE rendering_mode = DWRITE_RENDERING_MODE_DEFAULT, bool use_greyscale_antialiasing = false,
         bool use_colour_glyphs = true, bool set_defaults = true, size_t layout_cache_size = 32);
@@ -245,22 +523,134 @@ public:
 
     wil::com_ptr<IDWriteTypography> get_default_typography();
 
+    /**
+     * Set a memory budget shared by the text layout caches of text formats
+     * subsequently created using this context.
+     *
+     * This bounds the total memory used by cached text layouts, with the least
+     * recently used layouts across all text formats evicted first. Text formats
+     * created using this context must then all be used on the same thread.
+     *
+     * Changing the limit also applies it to existing text formats using the
+     * budget. Pass an empty std::optional to create subsequent text formats
+     * without a shared budget.
+     */
+    void set_text_layout_cache_budget(std::optional<size_t> max_bytes);
+
+    TextLayoutCacheBudget::Ptr get_text_layout_cache_budget() const { return m_text_layout_cache_budget; }
+
+    /**
+     * Resolve the family and face names of a font.
+     *
+     * Results are cached until the system font collection changes.
+     */
     std::optional<ResolvedFontNames> resolve_font_names(const wchar_t* wss_family_name,
         const wchar_t* typographic_family_name, DWRITE_FONT_WEIGHT weight, DWRITE_FONT_STRETCH stretch,
         DWRITE_FONT_STYLE style, const AxisValues& axis_values) const;
 
+    /**
+     * Resolve the family and face names of several fonts at once.
+     *
+     * This is intended for resolving all configured fonts at start-up, so that
+     * subsequent calls for those fonts are answered from the cache.
+     */
+    std::vector<std::optional<ResolvedFontNames>> resolve_font_names(std::span<const FontNamesQuery> queries) const;
+
+    /**
+     * Get the WSS font and LOGFONT closest to a typographic font.
+     *
+     * Results are cached until the system font collection changes.
+     */
     std::optional<std::tuple<WeightStretchStyle, LOGFONT>> get_wss_and_logfont_for_axis_values(
         const wchar_t* typographic_family_name, const AxisValues& axis_values) const;
 
+    /**
+     * Get the font families in the system font collection, sorted by name.
+     *
+     * The result is cached until the system font collection changes. When
+     * the font families are first enumerated, their fonts and axes are also
+     * queried on a worker thread.
+     */
     std::vector<FontFamily> get_font_families() const;
     std::vector<std::wstring> get_emoji_font_families() const;
 
 private:
+    using AxisValuesKey = std::vector<std::pair<uint32_t, float>>;
+
+    struct FontNamesKey {
+        std::wstring wss_family_name;
+        std::wstring typographic_family_name;
+        DWRITE_FONT_WEIGHT weight{};
+        DWRITE_FONT_STRETCH stretch{};
+        DWRITE_FONT_STYLE style{};
+        AxisValuesKey axis_values;
+
+        auto operator<=>(const FontNamesKey&) const = default;
+    };
+
+    struct AxisValuesFontKey {
+        std::wstring typographic_family_name;
+        AxisValuesKey axis_values;
+
+        auto operator<=>(const AxisValuesFontKey&) const = default;
+    };
+
+    struct TextFormatKey {
+        std::wstring family_name;
+        DWRITE_FONT_WEIGHT weight{};
+        DWRITE_FONT_STRETCH stretch{};
+        DWRITE_FONT_STYLE style{};
+        float font_size{};
+        AxisValuesKey axis_values;
+        DWRITE_RENDERING_MODE rendering_mode{};
+        bool use_greyscale_antialiasing{};
+
+        auto operator<=>(const TextFormatKey&) const = default;
+    };
+
+    struct SharedTextFormat {
+        wil::com_ptr<IDWriteTextFormat> text_format;
+        RenderingParams::Ptr rendering_params;
+        /** Not owned, so that unused text formats can be released */
+        std::weak_ptr<TextFormatCaches> caches;
+    };
+
+    static constexpr size_t max_resolved_fonts = 256;
+
+    std::optional<TextFormat> create_text_format_with_fallback(
+        const LOGFONT& log_font, std::optional<float> font_size, bool use_shared_text_formats) noexcept;
+
+    std::optional<std::tuple<WeightStretchStyle, LOGFONT>> get_wss_and_logfont_for_axis_values_uncached(
+        const wchar_t* typographic_family_name, const AxisValues& axis_values) const;
+
+    /**
+     * Clear the resolved font caches if the system font collection has changed.
+     *
+     * m_resolved_fonts_mutex must be held.
+     */
+    void validate_resolved_fonts_caches(const wil::com_ptr<IDWriteFontCollection>& font_collection) const;
+
+    static constexpr wil::zwstring_view font_families_thread_name{L"[UI helpers] Font family details thread"};
+
     inline static std::weak_ptr<Context> s_ptr;
 
     wil::com_ptr<IDWriteFactory1> m_factory;
     wil::com_ptr<IDWriteGdiInterop> m_gdi_interop;
     wil::com_ptr<IDWriteTypography> m_default_typography;
+    TextLayoutCacheBudget::Ptr m_text_layout_cache_budget;
+
+    mutable std::mutex m_shared_text_formats_mutex;
+    std::map<TextFormatKey, SharedTextFormat> m_shared_text_formats;
+
+    mutable std::mutex m_font_families_mutex;
+    mutable wil::com_ptr<IDWriteFontCollection> m_font_families_collection;
+    mutable std::vector<FontFamily> m_font_families;
+    mutable std::optional<std::jthread> m_font_families_thread;
+
+    mutable std::mutex m_resolved_fonts_mutex;
+    mutable wil::com_ptr<IDWriteFontCollection> m_resolved_fonts_collection;
+    mutable std::map<FontNamesKey, std::optional<ResolvedFontNames>> m_resolved_font_names;
+    mutable std::map<AxisValuesFontKey, std::optional<std::tuple<WeightStretchStyle, LOGFONT>>> m_wss_and_logfonts;
 };
 
 std::wstring get_localised_string(const wil::com_ptr<IDWriteLocalizedStrings>& localised_strings);
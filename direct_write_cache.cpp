@@ -0,0 +1,189 @@
+#include "stdafx.h"
+
+#include "direct_write_cache.h"
+
+namespace uih::direct_write {
+
+namespace {
+
+struct AggregateStats {
+    std::atomic<uint64_t> lookups;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> evictions;
+    std::atomic<uint64_t> width_reuses;
+    std::atomic<size_t> entries;
+    std::atomic<size_t> capacity;
+    std::atomic<size_t> estimated_bytes;
+};
+
+AggregateStats& get_aggregate_stats()
+{
+    static AggregateStats stats;
+    return stats;
+}
+
+void add_totals(size_t entries, size_t capacity, size_t estimated_bytes)
+{
+    auto& stats = get_aggregate_stats();
+    stats.entries.fetch_add(entries, std::memory_order_relaxed);
+    stats.capacity.fetch_add(capacity, std::memory_order_relaxed);
+    stats.estimated_bytes.fetch_add(estimated_bytes, std::memory_order_relaxed);
+}
+
+void subtract_totals(size_t entries, size_t capacity, size_t estimated_bytes)
+{
+    auto& stats = get_aggregate_stats();
+    stats.entries.fetch_sub(entries, std::memory_order_relaxed);
+    stats.capacity.fetch_sub(capacity, std::memory_order_relaxed);
+    stats.estimated_bytes.fetch_sub(estimated_bytes, std::memory_order_relaxed);
+}
+
+} // namespace
+
+TextLayoutCacheStatsReporter::TextLayoutCacheStatsReporter(const TextLayoutCacheStatsReporter& other)
+    : m_entries(other.m_entries)
+    , m_capacity(other.m_capacity)
+    , m_estimated_bytes(other.m_estimated_bytes)
+{
+    add_totals(m_entries, m_capacity, m_estimated_bytes);
+}
+
+TextLayoutCacheStatsReporter::TextLayoutCacheStatsReporter(TextLayoutCacheStatsReporter&& other) noexcept
+    : m_entries(std::exchange(other.m_entries, 0))
+    , m_capacity(std::exchange(other.m_capacity, 0))
+    , m_estimated_bytes(std::exchange(other.m_estimated_bytes, 0))
+{
+}
+
+TextLayoutCacheStatsReporter& TextLayoutCacheStatsReporter::operator=(const TextLayoutCacheStatsReporter& other)
+{
+    if (this != &other)
+        report_totals(other.m_entries, other.m_capacity, other.m_estimated_bytes);
+
+    return *this;
+}
+
+TextLayoutCacheStatsReporter& TextLayoutCacheStatsReporter::operator=(TextLayoutCacheStatsReporter&& other) noexcept
+{
+    if (this != &other) {
+        subtract_totals(m_entries, m_capacity, m_estimated_bytes);
+        m_entries = std::exchange(other.m_entries, 0);
+        m_capacity = std::exchange(other.m_capacity, 0);
+        m_estimated_bytes = std::exchange(other.m_estimated_bytes, 0);
+    }
+
+    return *this;
+}
+
+TextLayoutCacheStatsReporter::~TextLayoutCacheStatsReporter()
+{
+    subtract_totals(m_entries, m_capacity, m_estimated_bytes);
+}
+
+void TextLayoutCacheStatsReporter::report_lookup(bool is_hit)
+{
+    auto& stats = get_aggregate_stats();
+    stats.lookups.fetch_add(1, std::memory_order_relaxed);
+    (is_hit ? stats.hits : stats.misses).fetch_add(1, std::memory_order_relaxed);
+}
+
+void TextLayoutCacheStatsReporter::report_evictions(uint64_t count)
+{
+    get_aggregate_stats().evictions.fetch_add(count, std::memory_order_relaxed);
+}
+
+void TextLayoutCacheStatsReporter::report_width_reuse()
+{
+    get_aggregate_stats().width_reuses.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TextLayoutCacheStatsReporter::report_totals(size_t entries, size_t capacity, size_t estimated_bytes)
+{
+    subtract_totals(m_entries, m_capacity, m_estimated_bytes);
+    add_totals(entries, capacity, estimated_bytes);
+
+    m_entries = entries;
+    m_capacity = capacity;
+    m_estimated_bytes = estimated_bytes;
+}
+
+void TextLayoutCacheBudget::set_max_bytes(size_t max_bytes)
+{
+    m_max_bytes = max_bytes;
+    enforce();
+}
+
+void TextLayoutCacheBudget::set_member_bytes(Member* member, size_t bytes)
+{
+    const auto iter = std::ranges::find(m_members, member, &MemberInfo::member);
+
+    if (iter == m_members.end()) {
+        m_members.emplace_back(member, bytes);
+    } else {
+        m_used_bytes -= iter->bytes;
+        iter->bytes = bytes;
+    }
+
+    m_used_bytes += bytes;
+}
+
+void TextLayoutCacheBudget::remove_member(Member* member)
+{
+    const auto iter = std::ranges::find(m_members, member, &MemberInfo::member);
+
+    if (iter == m_members.end())
+        return;
+
+    m_used_bytes -= iter->bytes;
+    m_members.erase(iter);
+}
+
+void TextLayoutCacheBudget::enforce()
+{
+    while (m_used_bytes > m_max_bytes) {
+        Member* oldest_member{};
+        std::optional<uint64_t> oldest_tick;
+
+        for (auto&& [member, _] : m_members) {
+            const auto tick = member->get_oldest_entry_tick();
+
+            if (tick && (!oldest_tick || *tick < *oldest_tick)) {
+                oldest_member = member;
+                oldest_tick = tick;
+            }
+        }
+
+        if (!oldest_member)
+            break;
+
+        // This calls set_member_bytes() to update m_used_bytes
+        oldest_member->evict_oldest_entry();
+    }
+}
+
+TextLayoutCacheStats get_aggregate_text_layout_cache_stats()
+{
+    const auto& stats = get_aggregate_stats();
+
+    return {.lookups = stats.lookups.load(std::memory_order_relaxed),
+        .hits = stats.hits.load(std::memory_order_relaxed),
+        .misses = stats.misses.load(std::memory_order_relaxed),
+        .evictions = stats.evictions.load(std::memory_order_relaxed),
+        .width_reuses = stats.width_reuses.load(std::memory_order_relaxed),
+        .entries = stats.entries.load(std::memory_order_relaxed),
+        .capacity = stats.capacity.load(std::memory_order_relaxed),
+        .estimated_bytes = stats.estimated_bytes.load(std::memory_order_relaxed)};
+}
+
+void reset_aggregate_text_layout_cache_stats()
+{
+    auto& stats = get_aggregate_stats();
+    stats.lookups.store(0, std::memory_order_relaxed);
+    stats.hits.store(0, std::memory_order_relaxed);
+    stats.misses.store(0, std::memory_order_relaxed);
+    stats.evictions.store(0, std::memory_order_relaxed);
+    stats.width_reuses.store(0, std::memory_order_relaxed);
+}
+
+} // namespace uih::direct_write
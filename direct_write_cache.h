@@ -3,122 +3,1017 @@
 #include "text_format_parser.h"
 
 namespace uih::direct_write {
-template <class CacheValue>
-class TextLayoutCache {
+
+struct TextLayoutCacheStats {
+    uint64_t lookups{};
+    uint64_t hits{};
+    uint64_t misses{};
+    uint64_t evictions{};
+    /** Misses where a cached layout with a different width was reused */
+    uint64_t width_reuses{};
+    size_t entries{};
+    size_t capacity{};
+    /** A rough estimate, including memory used internally by DirectWrite for the cached layouts */
+    size_t estimated_bytes{};
+};
+
+/**
+ * Keeps the process-wide totals returned by get_aggregate_text_layout_cache_stats()
+ * up to date for one cache.
+ *
+ * Copying or moving this copies or moves the reported totals, so that the
+ * aggregate totals stay correct when a cache is copied or moved.
+ */
+class TextLayoutCacheStatsReporter {
 public:
-    template <typename String>
-    struct GenericCacheKey {
-        String text;
-        float width{};
-        float height{};
-        bool enable_ellipses{};
-        DWRITE_TEXT_ALIGNMENT alignment{};
-        std::vector<uint8_t> serialised_format_properties{};
+    TextLayoutCacheStatsReporter() = default;
+    TextLayoutCacheStatsReporter(const TextLayoutCacheStatsReporter& other);
+    TextLayoutCacheStatsReporter(TextLayoutCacheStatsReporter&& other) noexcept;
+    TextLayoutCacheStatsReporter& operator=(const TextLayoutCacheStatsReporter& other);
+    TextLayoutCacheStatsReporter& operator=(TextLayoutCacheStatsReporter&& other) noexcept;
+    ~TextLayoutCacheStatsReporter();
 
-        template <typename Other>
-        Other as() const
-        {
-            return Other{
-                decltype(Other::text)(text), width, height, enable_ellipses, alignment, serialised_format_properties};
+    static void report_lookup(bool is_hit);
+    static void report_evictions(uint64_t count);
+    static void report_width_reuse();
+    void report_totals(size_t entries, size_t capacity, size_t estimated_bytes);
+
+private:
+    size_t m_entries{};
+    size_t m_capacity{};
+    size_t m_estimated_bytes{};
+};
+
+/**
+ * Get statistics for all text layout caches in the process.
+ *
+ * Entries, capacity and estimated bytes are for caches that currently exist.
+ * Other counts are since the process started, or since
+ * reset_aggregate_text_layout_cache_stats() was last called.
+ */
+TextLayoutCacheStats get_aggregate_text_layout_cache_stats();
+
+/**
+ * Reset the lookup, hit, miss, eviction and width reuse counts returned by get_aggregate_text_layout_cache_stats().
+ */
+void reset_aggregate_text_layout_cache_stats();
+
+/**
+ * Cache of values derived from text and format properties.
+ *
+ * Entries are kept in two generations. When the current generation is full, it
+ * becomes the previous generation and the old previous generation is discarded.
+ * Entries found in the previous generation are moved back to the current one.
+ * This approximates least-recently-used eviction at a much lower cost per entry
+ * than TextLayoutCache.
+ */
+template <class Value>
+class GenerationalTextCache {
+public:
+    /**
+     * \param max_size  Maximum number of entries. If zero, caching is disabled.
+     */
+    explicit GenerationalTextCache(size_t max_size) : m_max_generation_size(max_size / 2) {}
+
+    [[nodiscard]] std::optional<Value> get(std::wstring_view text, uint32_t format_properties_id)
+    {
+        if (m_max_generation_size == 0)
+            return {};
+
+        set_key(text, format_properties_id);
+
+        if (const auto iter = m_current_generation.find(m_key); iter != m_current_generation.end())
+            return iter->second;
+
+        auto node = m_previous_generation.extract(m_key);
+
+        if (node.empty())
+            return {};
+
+        auto value = node.mapped();
+        insert_current(std::move(node.key()), std::move(node.mapped()));
+        return value;
+    }
+
+    void put(std::wstring_view text, uint32_t format_properties_id, Value value)
+    {
+        if (m_max_generation_size == 0)
+            return;
+
+        set_key(text, format_properties_id);
+
+        if (const auto iter = m_current_generation.find(m_key); iter != m_current_generation.end()) {
+            iter->second = std::move(value);
+            return;
         }
 
-        template <typename OtherString>
-        bool operator==(const GenericCacheKey<OtherString>& other) const
-        {
-            return text == other.text && width == other.width && height == other.height
-                && enable_ellipses == other.enable_ellipses && alignment == other.alignment
-                && serialised_format_properties == other.serialised_format_properties;
+        m_previous_generation.erase(m_key);
+        insert_current(m_key, std::move(value));
+    }
+
+    [[nodiscard]] size_t size() const { return m_current_generation.size() + m_previous_generation.size(); }
+
+    void clear()
+    {
+        m_current_generation.clear();
+        m_previous_generation.clear();
+    }
+
+private:
+    void set_key(std::wstring_view text, uint32_t format_properties_id)
+    {
+        // The format properties ID is stored in the first two characters of the key
+        m_key.assign(
+            {static_cast<wchar_t>(format_properties_id & 0xffff), static_cast<wchar_t>(format_properties_id >> 16)});
+        m_key.append(text);
+    }
+
+    void insert_current(std::wstring key, Value value)
+    {
+        if (m_current_generation.size() >= m_max_generation_size) {
+            m_previous_generation = std::move(m_current_generation);
+            m_current_generation.clear();
+            m_current_generation.reserve(m_max_generation_size);
         }
+
+        m_current_generation.emplace(std::move(key), std::move(value));
+    }
+
+    size_t m_max_generation_size{};
+    std::unordered_map<std::wstring, Value> m_current_generation;
+    std::unordered_map<std::wstring, Value> m_previous_generation;
+    /** Reused between calls to avoid allocating for each lookup */
+    std::wstring m_key;
+};
+
+/**
+ * Cache of the widths of text (with style codes processed), used when measuring
+ * text without a text layout otherwise being needed.
+ */
+using TextWidthCache = GenerationalTextCache<float>;
+
+/**
+ * A limit on the total estimated memory used by the entries of a group of text
+ * layout caches.
+ *
+ * When the limit is exceeded, the least recently used entries across all the
+ * caches in the group are evicted. This means caches that are in active use can
+ * use more of the budget than idle ones.
+ *
+ * All caches sharing a budget must be used on the same thread.
+ */
+class TextLayoutCacheBudget {
+public:
+    using Ptr = std::shared_ptr<TextLayoutCacheBudget>;
+
+    class Member {
+    public:
+        /** The last-used tick of the least recently used entry, or an empty std::optional if there are no entries */
+        [[nodiscard]] virtual std::optional<uint64_t> get_oldest_entry_tick() const = 0;
+        virtual void evict_oldest_entry() = 0;
+
+    protected:
+        ~Member() = default;
     };
 
-    using CacheKey = GenericCacheKey<std::wstring>;
-    using CacheKeyView = GenericCacheKey<std::wstring_view>;
+    explicit TextLayoutCacheBudget(size_t max_bytes) : m_max_bytes(max_bytes) {}
 
-    struct CacheKeyViewHash {
-        size_t operator()(const CacheKeyView& key_view) const
-        {
-            constexpr auto make_hash = [](auto&& value) { return std::hash<std::decay_t<decltype(value)>>{}(value); };
+    TextLayoutCacheBudget(const TextLayoutCacheBudget&) = delete;
+    TextLayoutCacheBudget& operator=(const TextLayoutCacheBudget&) = delete;
+
+    [[nodiscard]] size_t max_bytes() const { return m_max_bytes; }
+    [[nodiscard]] size_t used_bytes() const { return m_used_bytes; }
+
+    void set_max_bytes(size_t max_bytes);
+
+    /** Returns a value greater than all previously returned values, used to order entries across caches */
+    uint64_t get_next_tick() { return ++m_tick; }
+
+    /** Sets the estimated size of a member's entries, adding the member if needed */
+    void set_member_bytes(Member* member, size_t bytes);
+    void remove_member(Member* member);
+
+    /** Evicts the least recently used entries across all members until within the budget */
+    void enforce();
+
+private:
+    struct MemberInfo {
+        Member* member{};
+        size_t bytes{};
+    };
+
+    std::vector<MemberInfo> m_members;
+    size_t m_max_bytes{};
+    size_t m_used_bytes{};
+    uint64_t m_tick{};
+};
+
+/**
+ * A text layout cache's membership of a TextLayoutCacheBudget.
+ *
+ * The address of a cache changes when it's copied or moved, so copies and
+ * moves are only added to the budget when update() is next called.
+ */
+class TextLayoutCacheBudgetMembership {
+public:
+    TextLayoutCacheBudgetMembership() = default;
+    explicit TextLayoutCacheBudgetMembership(TextLayoutCacheBudget::Ptr budget) : m_budget(std::move(budget)) {}
 
-            size_t hash{};
-            hash ^= make_hash(key_view.text);
-            hash ^= make_hash(key_view.width) << 1;
-            hash ^= make_hash(key_view.height) << 2;
-            hash ^= make_hash(key_view.enable_ellipses) << 3;
-            hash ^= make_hash(key_view.alignment) << 4;
+    TextLayoutCacheBudgetMembership(const TextLayoutCacheBudgetMembership& other) : m_budget(other.m_budget) {}
 
-            std::string_view serialised_format_properties_as_string_view{
-                reinterpret_cast<const char*>(key_view.serialised_format_properties.data()),
-                key_view.serialised_format_properties.size()};
-            hash ^= make_hash(serialised_format_properties_as_string_view) << 5;
+    TextLayoutCacheBudgetMembership(TextLayoutCacheBudgetMembership&& other) noexcept : m_budget(other.m_budget)
+    {
+        other.leave();
+    }
 
-            return hash;
+    TextLayoutCacheBudgetMembership& operator=(const TextLayoutCacheBudgetMembership& other)
+    {
+        if (this != &other) {
+            leave();
+            m_budget = other.m_budget;
         }
+
+        return *this;
+    }
+
+    TextLayoutCacheBudgetMembership& operator=(TextLayoutCacheBudgetMembership&& other) noexcept
+    {
+        if (this != &other) {
+            leave();
+            m_budget = other.m_budget;
+            other.leave();
+        }
+
+        return *this;
+    }
+
+    ~TextLayoutCacheBudgetMembership() { leave(); }
+
+    explicit operator bool() const { return static_cast<bool>(m_budget); }
+
+    uint64_t get_next_tick() const { return m_budget->get_next_tick(); }
+
+    void update(TextLayoutCacheBudget::Member& member, size_t bytes)
+    {
+        m_member = &member;
+        m_budget->set_member_bytes(m_member, bytes);
+    }
+
+    void enforce() const { m_budget->enforce(); }
+
+private:
+    void leave() noexcept
+    {
+        if (m_budget && m_member)
+            m_budget->remove_member(m_member);
+
+        m_member = nullptr;
+    }
+
+    TextLayoutCacheBudget::Ptr m_budget;
+    TextLayoutCacheBudget::Member* m_member{};
+};
+
+/**
+ * Least-recently-used cache of text layouts.
+ *
+ * Entries are stored in a flat array, with the LRU list threaded through the
+ * entries using indices. Lookups use an open-addressing hash table (with linear
+ * probing) of entry indices. Evicted entries are reused in place, so once the
+ * cache is full, adding an entry normally doesn't allocate.
+ *
+ * The capacity adapts to the working set. Misses on recently evicted keys
+ * (tracked using a small filter of evicted key hashes) indicate that the cache is
+ * too small, and cause it to grow. If, over a longer period, less than half of
+ * the capacity is used and nothing evicted is needed again, the cache shrinks
+ * to twice the size of what was used. The capacity never goes below the size
+ * passed to the constructor or set using set_min_size().
+ *
+ * A second hash table indexes entries by their key excluding the width. This
+ * allows get_with_different_width() to reuse layouts when only the width has
+ * changed, for example while a column is being resized.
+ *
+ * Optionally, the cache can share a TextLayoutCacheBudget with other caches,
+ * which further limits the memory used by its entries.
+ */
+template <class CacheValue>
+class TextLayoutCache : private TextLayoutCacheBudget::Member {
+public:
+    struct CacheKeyView {
+        std::wstring_view text;
+        float width{};
+        float height{};
+        bool enable_ellipses{};
+        DWRITE_TEXT_ALIGNMENT alignment{};
+        /** See text_style::FormatPropertiesHandle */
+        uint32_t format_properties_id{};
+        /** Distinguishes layouts of the same text that are otherwise laid out differently */
+        uint32_t layout_variant{};
     };
 
-    explicit TextLayoutCache(size_t max_size) : m_max_size(max_size) {}
+    /** Upper limit for automatic growth (but not for set_min_size()) */
+    static constexpr size_t max_adaptive_size = 4096;
 
-    bool contains(const CacheKeyView& key_view) { return m_cache_map.contains(key_view); }
+    /**
+     * \param min_size  Initial and minimum capacity. If zero, caching is disabled.
+     * \param budget    Optional memory budget shared with other caches
+     */
+    explicit TextLayoutCache(size_t min_size, TextLayoutCacheBudget::Ptr budget = {})
+        : m_base_size(min_size)
+        , m_min_size(min_size)
+        , m_max_size(min_size)
+        , m_budget_membership(std::move(budget))
+    {
+        if (m_max_size == 0)
+            return;
+
+        m_entries.reserve(m_max_size);
+        m_buckets.resize(get_bucket_count(m_max_size), npos);
+        m_width_independent_buckets.resize(get_bucket_count(m_max_size), npos);
+        report_totals();
+    }
+
+    bool contains(const CacheKeyView& key_view) const { return find(key_view, hash_key(key_view)).has_value(); }
+
+    size_t max_size() const { return m_max_size; }
+    size_t min_size() const { return m_min_size; }
+    size_t size() const { return m_entries.size(); }
+
+    TextLayoutCacheStats stats() const
+    {
+        return {m_lookup_count, m_hit_count, m_miss_count, m_eviction_count, m_width_reuse_count, m_entries.size(),
+            m_max_size, estimate_bytes()};
+    }
+
+    void reset_stats()
+    {
+        m_lookup_count = 0;
+        m_hit_count = 0;
+        m_miss_count = 0;
+        m_eviction_count = 0;
+        m_width_reuse_count = 0;
+    }
 
     /**
-     * Get an existing item from the cache if present.
+     * Set the minimum capacity, growing the cache immediately if needed.
+     *
+     * The minimum capacity is never less than the size passed to the constructor.
+     */
+    void set_min_size(size_t min_size)
+    {
+        if (m_base_size == 0)
+            return;
+
+        m_min_size = std::max(m_base_size, min_size);
+
+        if (m_max_size < m_min_size)
+            resize(m_min_size);
+    }
+
+    /**
+     * Set the minimum capacity needed by one of several users of the cache.
      *
-     * Creates a space for a new item if at capacity and the item is not found.
+     * The minimum capacity is set to the total needed by all users, so that
+     * users sharing the cache (for example, windows using the same text
+     * format) don't replace each other's requirements. Pass zero when a user
+     * stops using the cache.
+     */
+    void set_min_size_for_user(const void* user, size_t min_size)
+    {
+        const auto iter = std::ranges::find(m_user_min_sizes, user, &UserMinSize::user);
+
+        if (iter != m_user_min_sizes.end() && min_size == 0)
+            m_user_min_sizes.erase(iter);
+        else if (iter != m_user_min_sizes.end())
+            iter->min_size = min_size;
+        else if (min_size > 0)
+            m_user_min_sizes.emplace_back(user, min_size);
+
+        size_t total_min_size{};
+
+        for (auto&& user_min_size : m_user_min_sizes)
+            total_min_size += user_min_size.min_size;
+
+        set_min_size(total_min_size);
+    }
+
+    /**
+     * Get an existing item from the cache if present.
      */
     CacheValue get(const CacheKeyView& key_view)
     {
-        if (m_max_size == 0)
+        if (m_max_size == 0) {
+            record_lookup(false);
             return {};
+        }
+
+        const auto hash = hash_key(key_view);
+        const auto entry_index = find(key_view, hash);
 
-        auto iter = m_cache_map.find(key_view);
+        record_lookup(entry_index.has_value());
+
+        if (!entry_index) {
+            on_miss(hash);
+            on_lookup();
+            return {};
+        }
+
+        move_to_front(*entry_index);
+        mark_used(*entry_index);
+        auto value = m_entries[*entry_index].value;
+        on_lookup();
+
+        return value;
+    }
+
+    /**
+     * Get an item whose key only differs by its width, changing its key to the passed key.
+     *
+     * The caller is responsible for updating the item for the new width. Items that
+     * have been used since start_new_frame() was last called are not returned, so
+     * that items that are in use at a different width are not taken over. (This
+     * means nothing is returned if start_new_frame() is never called.)
+     */
+    CacheValue get_with_different_width(const CacheKeyView& key_view)
+    {
+        return get_with_different_width(key_view, [](const CacheValue&) {});
+    }
 
-        if (iter == m_cache_map.end()) {
-            shrink_one_if_at_capacity();
+    /**
+     * Get an item whose key only differs by its width, updating it for the new width and
+     * changing its key to the passed key.
+     *
+     * update_value is called with the item before its key is changed. If it throws, the
+     * exception is propagated and the item is left in the cache with its existing key.
+     */
+    template <class UpdateValue>
+    CacheValue get_with_different_width(const CacheKeyView& key_view, UpdateValue&& update_value)
+    {
+        if (m_max_size == 0)
             return {};
+
+        const auto width_independent_hash = fold_hash(hash_key_except_width(key_view));
+        const auto mask = m_width_independent_buckets.size() - 1;
+        std::optional<uint32_t> found_entry_index;
+
+        for (auto bucket = width_independent_hash & mask;; bucket = (bucket + 1) & mask) {
+            const auto entry_index = m_width_independent_buckets[bucket];
+
+            if (entry_index == npos)
+                break;
+
+            const auto& entry = m_entries[entry_index];
+
+            if (entry.width_independent_hash == width_independent_hash && entry.last_used_frame != m_frame
+                && entry.matches_except_width(key_view)) {
+                found_entry_index = entry_index;
+                break;
+            }
         }
 
-        m_cache_list.splice(m_cache_list.begin(), m_cache_list, iter->second);
+        if (!found_entry_index)
+            return {};
+
+        auto& entry = m_entries[*found_entry_index];
+
+        update_value(entry.value);
 
-        return iter->second->layout;
+        erase_bucket(m_buckets, &Entry::hash, find_bucket(m_buckets, &Entry::hash, *found_entry_index));
+        entry.width = key_view.width;
+        entry.hash = hash_key(key_view);
+        insert_bucket(m_buckets, &Entry::hash, *found_entry_index);
+
+        move_to_front(*found_entry_index);
+        mark_used(*found_entry_index);
+        ++m_width_reuse_count;
+        TextLayoutCacheStatsReporter::report_width_reuse();
+
+        return entry.value;
     }
 
     /**
-     * Put a new item in the cache.
+     * Mark the start of a new frame (i.e. paint) for the purposes of get_with_different_width().
+     */
+    void start_new_frame() { ++m_frame; }
+
+    /**
+     * Put a new item in the cache, evicting the least recently used item if at capacity.
      *
      * Can only be used if the item is not already in the cache.
      */
-    void put_new(const CacheKeyView& key_view, CacheValue layout)
+    void put_new(const CacheKeyView& key_view, CacheValue value)
     {
         if (m_max_size == 0)
             return;
 
-        assert(!m_cache_map.contains(key_view));
+        const auto width_independent_hash = hash_key_except_width(key_view);
+        const auto hash = hash_key(width_independent_hash, key_view.width);
 
-        auto& stored_key = m_cache_list.emplace_front(key_view.template as<CacheKey>(), std::move(layout));
-        m_cache_map.emplace(stored_key.key.template as<CacheKeyView>(), m_cache_list.begin());
+        assert(!find(key_view, hash));
+
+        uint32_t entry_index{};
+
+        if (m_entries.size() < m_max_size) {
+            entry_index = gsl::narrow<uint32_t>(m_entries.size());
+            m_entries.emplace_back();
+        } else {
+            entry_index = m_oldest;
+            add_to_ghost_filter(m_entries[entry_index].hash);
+            erase_from_indexes(entry_index);
+            unlink(entry_index);
+            m_text_character_count -= m_entries[entry_index].text.size();
+            record_evictions(1);
+        }
+
+        auto& entry = m_entries[entry_index];
+        // assign() and append() reuse any existing capacity of an evicted entry
+        entry.text.assign(key_view.text);
+        entry.format_properties_id = key_view.format_properties_id;
+        entry.width = key_view.width;
+        entry.height = key_view.height;
+        entry.enable_ellipses = key_view.enable_ellipses;
+        entry.alignment = key_view.alignment;
+        entry.layout_variant = key_view.layout_variant;
+        entry.hash = hash;
+        entry.width_independent_hash = fold_hash(width_independent_hash);
+        entry.value = std::move(value);
+        m_text_character_count += entry.text.size();
+
+        insert_into_indexes(entry_index);
+        link_front(entry_index);
+        mark_used(entry_index);
+        report_totals();
+
+        if (m_budget_membership)
+            m_budget_membership.enforce();
     }
 
-private:
-    void shrink_one_if_at_capacity()
+    /**
+     * Put an item in the cache, evicting the least recently used item if at capacity.
+     *
+     * Does nothing if the item is already in the cache.
+     */
+    void put(const CacheKeyView& key_view, CacheValue value)
     {
-        if (m_cache_list.size() < m_max_size)
+        if (m_max_size == 0 || contains(key_view))
             return;
 
-        auto& lru_key = m_cache_list.back().key;
-        m_cache_map.erase(lru_key.template as<CacheKeyView>());
-        m_cache_list.pop_back();
+        put_new(key_view, std::move(value));
+    }
+
+    /**
+     * Put an item in the cache, unless that would evict an item that has been used
+     * since start_new_frame() was last called.
+     *
+     * This is for items that may be needed soon (such as prefetched text layouts),
+     * which shouldn't displace items that are currently in use. Does nothing if the
+     * item is already in the cache.
+     *
+     * \return  Whether the item was added
+     */
+    bool put_without_evicting_current_frame(const CacheKeyView& key_view, CacheValue value)
+    {
+        if (m_max_size == 0 || contains(key_view))
+            return false;
+
+        if (m_entries.size() >= m_max_size && m_entries[m_oldest].last_used_frame == m_frame)
+            return false;
+
+        put_new(key_view, std::move(value));
+        return true;
     }
 
-    struct CacheEntry {
-        CacheKey key;
-        CacheValue layout;
+private:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t ghost_filter_size = 8192;
+    /** The length of a sizing window, as a multiple of the current capacity */
+    static constexpr size_t window_lookups_factor = 8;
+
+    // Very rough estimates of the memory used by DirectWrite for a text layout
+    static constexpr size_t estimated_value_bytes = 2048;
+    static constexpr size_t estimated_value_bytes_per_character = 64;
+
+    struct Entry {
+        std::wstring text;
+        uint32_t format_properties_id{};
+        float width{};
+        float height{};
+        bool enable_ellipses{};
+        DWRITE_TEXT_ALIGNMENT alignment{};
+        uint32_t layout_variant{};
+        uint32_t hash{};
+        uint32_t width_independent_hash{};
+        uint32_t newer{npos};
+        uint32_t older{npos};
+        uint32_t last_used_window{};
+        uint32_t last_used_frame{};
+        /** Only set if there is a budget */
+        uint64_t last_used_tick{};
+        CacheValue value;
+
+        bool matches_except_width(const CacheKeyView& key_view) const
+        {
+            return format_properties_id == key_view.format_properties_id && height == key_view.height
+                && enable_ellipses == key_view.enable_ellipses && alignment == key_view.alignment
+                && layout_variant == key_view.layout_variant && text == key_view.text;
+        }
+
+        bool operator==(const CacheKeyView& key_view) const
+        {
+            return width == key_view.width && matches_except_width(key_view);
+        }
     };
 
-    using CacheList = std::list<CacheEntry>;
-    using CacheMap = std::unordered_map<CacheKeyView, typename CacheList::iterator, CacheKeyViewHash>;
+    static uint64_t mix_hash(uint64_t value)
+    {
+        // splitmix64 finaliser
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ull;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebull;
+        value ^= value >> 31;
+        return value;
+    }
+
+    static uint64_t combine_hash(uint64_t seed, uint64_t value)
+    {
+        return mix_hash(seed + 0x9e3779b97f4a7c15ull + value);
+    }
+
+    static uint64_t hash_float(float value)
+    {
+        // 0.0f and -0.0f compare equal, so must hash equally
+        return value == 0.f ? 0 : std::bit_cast<uint32_t>(value);
+    }
+
+    static uint32_t fold_hash(uint64_t hash) { return static_cast<uint32_t>(hash ^ (hash >> 32)); }
+
+    static uint64_t hash_key_except_width(const CacheKeyView& key_view)
+    {
+        auto hash = mix_hash(std::hash<std::wstring_view>{}(key_view.text));
+        hash = combine_hash(hash, hash_float(key_view.height));
+        hash = combine_hash(
+            hash, (static_cast<uint64_t>(key_view.alignment) << 1) | (key_view.enable_ellipses ? 1u : 0u));
+        hash = combine_hash(
+            hash, (static_cast<uint64_t>(key_view.layout_variant) << 32) | key_view.format_properties_id);
+
+        return hash;
+    }
+
+    static uint32_t hash_key(uint64_t hash_except_width, float width)
+    {
+        return fold_hash(combine_hash(hash_except_width, hash_float(width)));
+    }
+
+    static uint32_t hash_key(const CacheKeyView& key_view)
+    {
+        return hash_key(hash_key_except_width(key_view), key_view.width);
+    }
+
+    static size_t get_bucket_count(size_t max_size) { return std::bit_ceil(std::max(max_size * 2, size_t{8})); }
+
+    size_t bucket_mask() const { return m_buckets.size() - 1; }
+
+    std::optional<uint32_t> find(const CacheKeyView& key_view, uint32_t hash) const
+    {
+        if (m_buckets.empty())
+            return {};
+
+        for (auto bucket = hash & bucket_mask();; bucket = (bucket + 1) & bucket_mask()) {
+            const auto entry_index = m_buckets[bucket];
+
+            if (entry_index == npos)
+                return {};
+
+            const auto& entry = m_entries[entry_index];
+
+            if (entry.hash == hash && entry == key_view)
+                return entry_index;
+        }
+    }
+
+    using HashMember = uint32_t Entry::*;
+
+    size_t find_bucket(const std::vector<uint32_t>& buckets, HashMember hash_member, uint32_t entry_index) const
+    {
+        const auto mask = buckets.size() - 1;
+
+        for (auto bucket = m_entries[entry_index].*hash_member & mask;; bucket = (bucket + 1) & mask) {
+            if (buckets[bucket] == entry_index)
+                return bucket;
+
+            assert(buckets[bucket] != npos);
+        }
+    }
+
+    void insert_bucket(std::vector<uint32_t>& buckets, HashMember hash_member, uint32_t entry_index)
+    {
+        const auto mask = buckets.size() - 1;
+        auto bucket = m_entries[entry_index].*hash_member & mask;
+
+        while (buckets[bucket] != npos)
+            bucket = (bucket + 1) & mask;
+
+        buckets[bucket] = entry_index;
+    }
+
+    /**
+     * Removes a bucket using backward-shift deletion, so that no tombstones are needed.
+     */
+    void erase_bucket(std::vector<uint32_t>& buckets, HashMember hash_member, size_t bucket)
+    {
+        const auto mask = buckets.size() - 1;
+        auto next_bucket = bucket;
+
+        while (true) {
+            next_bucket = (next_bucket + 1) & mask;
+            const auto next_entry_index = buckets[next_bucket];
+
+            if (next_entry_index == npos)
+                break;
+
+            const auto ideal_bucket = m_entries[next_entry_index].*hash_member & mask;
+
+            // Shift the entry back if its ideal bucket is not cyclically in (bucket, next_bucket]
+            const auto can_shift = bucket <= next_bucket ? ideal_bucket <= bucket || ideal_bucket > next_bucket
+                                                         : ideal_bucket <= bucket && ideal_bucket > next_bucket;
+
+            if (can_shift) {
+                buckets[bucket] = next_entry_index;
+                bucket = next_bucket;
+            }
+        }
+
+        buckets[bucket] = npos;
+    }
+
+    void insert_into_indexes(uint32_t entry_index)
+    {
+        insert_bucket(m_buckets, &Entry::hash, entry_index);
+        insert_bucket(m_width_independent_buckets, &Entry::width_independent_hash, entry_index);
+    }
+
+    void erase_from_indexes(uint32_t entry_index)
+    {
+        erase_bucket(m_buckets, &Entry::hash, find_bucket(m_buckets, &Entry::hash, entry_index));
+        erase_bucket(m_width_independent_buckets, &Entry::width_independent_hash,
+            find_bucket(m_width_independent_buckets, &Entry::width_independent_hash, entry_index));
+    }
+
+    void unlink(uint32_t entry_index)
+    {
+        auto& entry = m_entries[entry_index];
+
+        if (entry.newer != npos)
+            m_entries[entry.newer].older = entry.older;
+        else
+            m_newest = entry.older;
+
+        if (entry.older != npos)
+            m_entries[entry.older].newer = entry.newer;
+        else
+            m_oldest = entry.newer;
+
+        entry.newer = npos;
+        entry.older = npos;
+    }
+
+    void link_front(uint32_t entry_index)
+    {
+        auto& entry = m_entries[entry_index];
+
+        entry.older = m_newest;
+        entry.newer = npos;
+
+        if (m_newest != npos)
+            m_entries[m_newest].newer = entry_index;
+
+        m_newest = entry_index;
+
+        if (m_oldest == npos)
+            m_oldest = entry_index;
+    }
+
+    void move_to_front(uint32_t entry_index)
+    {
+        if (m_newest == entry_index)
+            return;
+
+        unlink(entry_index);
+        link_front(entry_index);
+    }
+
+    std::optional<uint64_t> get_oldest_entry_tick() const override
+    {
+        if (m_oldest == npos)
+            return {};
+
+        return m_entries[m_oldest].last_used_tick;
+    }
+
+    /**
+     * Removes the least recently used entry, moving the last entry in the array into its place.
+     */
+    void evict_oldest_entry() override
+    {
+        const auto entry_index = m_oldest;
+        const auto last_entry_index = gsl::narrow<uint32_t>(m_entries.size() - 1);
+
+        erase_from_indexes(entry_index);
+        unlink(entry_index);
+        m_text_character_count -= m_entries[entry_index].text.size();
+        record_evictions(1);
+
+        if (entry_index != last_entry_index) {
+            m_buckets[find_bucket(m_buckets, &Entry::hash, last_entry_index)] = entry_index;
+            m_width_independent_buckets[find_bucket(
+                m_width_independent_buckets, &Entry::width_independent_hash, last_entry_index)]
+                = entry_index;
+
+            auto& entry = m_entries[entry_index];
+            entry = std::move(m_entries[last_entry_index]);
+
+            if (entry.newer != npos)
+                m_entries[entry.newer].older = entry_index;
+            else
+                m_newest = entry_index;
+
+            if (entry.older != npos)
+                m_entries[entry.older].newer = entry_index;
+            else
+                m_oldest = entry_index;
+        }
+
+        m_entries.pop_back();
+        report_totals();
+    }
+
+    /**
+     * Changes the capacity, keeping the most recently used entries if shrinking.
+     */
+    void resize(size_t new_max_size)
+    {
+        if (new_max_size < m_entries.size()) {
+            std::vector<Entry> kept_entries;
+            kept_entries.reserve(new_max_size);
+
+            for (auto entry_index = m_newest; entry_index != npos && kept_entries.size() < new_max_size;
+                entry_index = m_entries[entry_index].older)
+                kept_entries.emplace_back(std::move(m_entries[entry_index]));
+
+            record_evictions(m_entries.size() - kept_entries.size());
+            m_entries = std::move(kept_entries);
+            m_text_character_count = 0;
+
+            for (auto&& entry : m_entries)
+                m_text_character_count += entry.text.size();
+
+            const auto entry_count = gsl::narrow<uint32_t>(m_entries.size());
+
+            for (uint32_t entry_index{}; entry_index < entry_count; ++entry_index) {
+                m_entries[entry_index].newer = entry_index > 0 ? entry_index - 1 : npos;
+                m_entries[entry_index].older = entry_index + 1 < entry_count ? entry_index + 1 : npos;
+            }
+
+            m_newest = entry_count > 0 ? 0 : npos;
+            m_oldest = entry_count > 0 ? entry_count - 1 : npos;
+        }
+
+        m_max_size = new_max_size;
+        m_buckets.assign(get_bucket_count(m_max_size), npos);
+        m_width_independent_buckets.assign(get_bucket_count(m_max_size), npos);
+
+        for (uint32_t entry_index{}; entry_index < gsl::narrow<uint32_t>(m_entries.size()); ++entry_index)
+            insert_into_indexes(entry_index);
+
+        start_new_window();
+        report_totals();
+    }
+
+    size_t estimate_bytes() const
+    {
+        return sizeof(*this) + m_entries.capacity() * sizeof(Entry)
+            + (m_buckets.size() + m_width_independent_buckets.size()) * sizeof(uint32_t) + estimate_entry_bytes();
+    }
 
+    /** Estimates the memory used by the entries, excluding the fixed overhead of the cache itself */
+    size_t estimate_entry_bytes() const
+    {
+        return m_text_character_count * sizeof(wchar_t) + m_entries.size() * estimated_value_bytes
+            + m_text_character_count * estimated_value_bytes_per_character;
+    }
+
+    void record_lookup(bool is_hit)
+    {
+        ++m_lookup_count;
+        ++(is_hit ? m_hit_count : m_miss_count);
+        TextLayoutCacheStatsReporter::report_lookup(is_hit);
+    }
+
+    void record_evictions(size_t count)
+    {
+        m_eviction_count += count;
+        TextLayoutCacheStatsReporter::report_evictions(count);
+    }
+
+    void report_totals()
+    {
+        m_stats_reporter.report_totals(m_entries.size(), m_max_size, estimate_bytes());
+
+        if (m_budget_membership)
+            m_budget_membership.update(*this, estimate_entry_bytes());
+    }
+
+    void mark_used(uint32_t entry_index)
+    {
+        auto& entry = m_entries[entry_index];
+        entry.last_used_frame = m_frame;
+
+        if (m_budget_membership)
+            entry.last_used_tick = m_budget_membership.get_next_tick();
+
+        if (entry.last_used_window == m_window)
+            return;
+
+        entry.last_used_window = m_window;
+        ++m_window_used_count;
+    }
+
+    void on_miss(uint32_t hash)
+    {
+        if (!m_ghost_filter.test(hash % ghost_filter_size))
+            return;
+
+        ++m_window_ghost_hit_count;
+
+        const auto max_size_limit = std::max(max_adaptive_size, m_min_size);
+
+        if (m_window_ghost_hit_count > m_max_size / 4 && m_max_size < max_size_limit)
+            resize(std::min(max_size_limit, m_max_size * 2));
+    }
+
+    void on_lookup()
+    {
+        if (++m_window_lookup_count < m_max_size * window_lookups_factor)
+            return;
+
+        if (m_window_ghost_hit_count == 0 && m_window_used_count < m_max_size / 2 && m_max_size > m_min_size)
+            resize(std::max(m_min_size, m_window_used_count * 2));
+        else
+            start_new_window();
+    }
+
+    void add_to_ghost_filter(uint32_t hash)
+    {
+        // Limit the false positive rate by clearing the filter once it's a quarter full
+        if (++m_ghost_filter_insertion_count > ghost_filter_size / 4) {
+            m_ghost_filter.reset();
+            m_ghost_filter_insertion_count = 1;
+        }
+
+        m_ghost_filter.set(hash % ghost_filter_size);
+    }
+
+    void start_new_window()
+    {
+        ++m_window;
+        m_window_lookup_count = 0;
+        m_window_ghost_hit_count = 0;
+        m_window_used_count = 0;
+    }
+
+    struct UserMinSize {
+        const void* user{};
+        size_t min_size{};
+    };
+
+    size_t m_base_size{};
+    size_t m_min_size{};
     size_t m_max_size{};
-    CacheList m_cache_list;
-    CacheMap m_cache_map;
+    std::vector<UserMinSize> m_user_min_sizes;
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_buckets;
+    std::vector<uint32_t> m_width_independent_buckets;
+    uint32_t m_newest{npos};
+    uint32_t m_oldest{npos};
+
+    uint32_t m_frame{1};
+    uint32_t m_window{1};
+    size_t m_window_lookup_count{};
+    size_t m_window_ghost_hit_count{};
+    size_t m_window_used_count{};
+    std::bitset<ghost_filter_size> m_ghost_filter;
+    size_t m_ghost_filter_insertion_count{};
+
+    uint64_t m_lookup_count{};
+    uint64_t m_hit_count{};
+    uint64_t m_miss_count{};
+    uint64_t m_eviction_count{};
+    uint64_t m_width_reuse_count{};
+    /** Total length of the text of all entries */
+    size_t m_text_character_count{};
+    TextLayoutCacheStatsReporter m_stats_reporter;
+    TextLayoutCacheBudgetMembership m_budget_membership;
 };
 
 } // namespace uih::direct_write
@@ -1,7 +1,7 @@
 #include "stdafx.h"
 
 #include "direct_write.h"
-#include "emoji.h"
+#include "emoji_segmenter.h"
 
 namespace uih::direct_write::emoji_font_fallback {
 
@@ -23,12 +23,196 @@ wil::com_ptr<IDWriteFontFamily> find_font_family(
     return font_family;
 }
 
+/**
+ * Caches which code points fonts contain, so that repeated coverage queries
+ * for the same font don't need to call IDWriteFont::HasCharacter() again.
+ *
+ * Fonts are identified by their IDWriteFont instance, which is kept alive by
+ * the cache.
+ */
+class FontCoverageCache {
+public:
+    bool has_character(const wil::com_ptr<IDWriteFont>& font, uint32_t code_point)
+    {
+        std::scoped_lock lock(m_mutex);
+        return has_character(get_font_coverage(font), code_point);
+    }
+
+    /**
+     * Get the length, in UTF-16 code units, of the start of some text that a
+     * font has all the characters of.
+     */
+    size_t get_covered_length(const wil::com_ptr<IDWriteFont>& font, std::wstring_view text)
+    {
+        std::scoped_lock lock(m_mutex);
+        auto& coverage = get_font_coverage(font);
+        size_t position{};
+
+        while (position < text.size()) {
+            const auto [code_point, length] = emoji::decode_utf16(text, position);
+
+            if (!has_character(coverage, code_point))
+                break;
+
+            position += length;
+        }
+
+        return position;
+    }
+
+private:
+    static constexpr uint32_t block_size = 256;
+    static constexpr size_t max_fonts = 16;
+
+    struct Block {
+        std::bitset<block_size> known;
+        std::bitset<block_size> present;
+    };
+
+    struct FontCoverage {
+        wil::com_ptr<IDWriteFont> font;
+        std::unordered_map<uint32_t, Block> blocks;
+        /** The most recently used block, as consecutive code points are usually in the same block */
+        uint32_t last_block_index{std::numeric_limits<uint32_t>::max()};
+        Block* last_block{};
+    };
+
+    static bool has_character(FontCoverage& coverage, uint32_t code_point)
+    {
+        const auto block_index = code_point / block_size;
+
+        if (block_index != coverage.last_block_index) {
+            coverage.last_block = &coverage.blocks[block_index];
+            coverage.last_block_index = block_index;
+        }
+
+        auto& block = *coverage.last_block;
+        const auto offset = code_point % block_size;
+
+        if (block.known.test(offset))
+            return block.present.test(offset);
+
+        BOOL exists{};
+        const auto hr = coverage.font->HasCharacter(code_point, &exists);
+
+        if (FAILED(hr)) {
+            LOG_HR(hr);
+            return false;
+        }
+
+        block.known.set(offset);
+        block.present.set(offset, exists == TRUE);
+
+        return exists == TRUE;
+    }
+
+    FontCoverage& get_font_coverage(const wil::com_ptr<IDWriteFont>& font)
+    {
+        const auto iter = std::ranges::find(m_fonts, font.get(), [](auto&& coverage) { return coverage.font.get(); });
+
+        if (iter != m_fonts.end())
+            return *iter;
+
+        if (m_fonts.size() >= max_fonts)
+            m_fonts.erase(m_fonts.begin());
+
+        return m_fonts.emplace_back(FontCoverage{font, {}});
+    }
+
+    std::mutex m_mutex;
+    std::vector<FontCoverage> m_fonts;
+};
+
+struct FontKey {
+    /** Null for fonts from the emoji font families */
+    IDWriteFontCollection* collection{};
+    std::wstring family_name;
+    DWRITE_FONT_WEIGHT weight{};
+    DWRITE_FONT_STRETCH stretch{};
+    DWRITE_FONT_STYLE style{};
+    /** Used instead of weight, stretch and style by IDWriteFontFallback1 */
+    std::optional<std::vector<std::pair<uint32_t, float>>> axis_values;
+
+    auto operator<=>(const FontKey&) const = default;
+};
+
+std::vector<std::pair<uint32_t, float>> make_axis_values_key(
+    const DWRITE_FONT_AXIS_VALUE* axis_values, uint32_t axis_value_count)
+{
+    return std::span(axis_values, axis_value_count)
+        | ranges::views::transform([](auto&& axis_value) {
+              return std::make_pair(static_cast<uint32_t>(axis_value.axisTag), axis_value.value);
+          })
+        | ranges::to<std::vector>;
+}
+
+struct ResolvedFont {
+    wil::com_ptr<IDWriteFontCollection> collection;
+    wil::com_ptr<IDWriteFont> font;
+    wil::com_ptr<IDWriteFontFace5> font_face;
+};
+
+/**
+ * Caches fonts resolved from a family name and font properties.
+ *
+ * DirectWrite calls MapCharacters() many times per text layout with the same
+ * base family and properties, and resolving fonts from them is relatively
+ * slow.
+ */
+class ResolvedFontCache {
+public:
+    /**
+     * Get a resolved font, calling resolve to resolve it if it's not in the cache.
+     *
+     * Results are only cached if resolve succeeds.
+     */
+    template <class Resolve>
+    HRESULT get(const FontKey& key, ResolvedFont& resolved_font, Resolve&& resolve)
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (const auto iter = m_fonts.find(key); iter != m_fonts.end()) {
+            resolved_font = iter->second;
+            return S_OK;
+        }
+
+        ResolvedFont new_resolved_font{key.collection};
+        RETURN_IF_FAILED(resolve(new_resolved_font));
+
+        if (m_fonts.size() >= max_fonts)
+            m_fonts.clear();
+
+        m_fonts.emplace(key, new_resolved_font);
+        resolved_font = std::move(new_resolved_font);
+        return S_OK;
+    }
+
+    /**
+     * Update a cached font (e.g. to add a font face created later).
+     */
+    void put(const FontKey& key, ResolvedFont resolved_font)
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (const auto iter = m_fonts.find(key); iter != m_fonts.end())
+            iter->second = std::move(resolved_font);
+    }
+
+private:
+    static constexpr size_t max_fonts = 64;
+
+    std::mutex m_mutex;
+    std::map<FontKey, ResolvedFont> m_fonts;
+};
+
 class EmojiFontFallback : public IDWriteFontFallback1 {
 public:
     explicit EmojiFontFallback(const wil::com_ptr<IDWriteFontCollection>& font_collection,
         wil::com_ptr<IDWriteFontFallback> base_fallback, const wchar_t* emoji_family_name,
         const wchar_t* monochrome_family_name)
-        : m_base_fallback(std::move(base_fallback))
+        : m_text_family_name(monochrome_family_name)
+        , m_emoji_family_name(emoji_family_name)
+        , m_base_fallback(std::move(base_fallback))
     {
         m_text_font_family = find_font_family(font_collection, monochrome_family_name);
         m_emoji_font_family = find_font_family(font_collection, emoji_family_name);
@@ -80,36 +264,32 @@ public:
         uint32_t length{};
         RETURN_IF_FAILED(analysisSource->GetTextAtPosition(textPosition, &text, &length));
 
-        wil::com_ptr_nothrow<IDWriteFont> base_font;
+        ResolvedFont resolved_base_font;
 
         if (baseFontCollection && baseFamilyName) {
-            uint32_t index{};
-            BOOL exists{};
-            RETURN_IF_FAILED(baseFontCollection->FindFamilyName(baseFamilyName, &index, &exists));
+            const FontKey key{baseFontCollection, baseFamilyName, baseWeight, baseStretch, baseStyle};
 
-            if (exists) {
-                wil::com_ptr<IDWriteFontFamily> base_font_family;
-                RETURN_IF_FAILED(baseFontCollection->GetFontFamily(index, &base_font_family));
-                RETURN_IF_FAILED(
-                    base_font_family->GetFirstMatchingFont(baseWeight, baseStretch, baseStyle, &base_font));
-            }
-        }
+            const auto resolve_base_font = [&](ResolvedFont& resolved_font) {
+                uint32_t index{};
+                BOOL exists{};
+                RETURN_IF_FAILED(baseFontCollection->FindFamilyName(baseFamilyName, &index, &exists));
 
-        std::wstring_view text_view{text, length};
-        const auto map_result = map_char(text_view, base_font);
+                if (!exists)
+                    return S_OK;
 
-        auto pos = map_result.skip_length;
+                wil::com_ptr_nothrow<IDWriteFontFamily> base_font_family;
+                RETURN_IF_FAILED(baseFontCollection->GetFontFamily(index, &base_font_family));
+                return base_font_family->GetFirstMatchingFont(baseWeight, baseStretch, baseStyle, &resolved_font.font);
+            };
 
-        while (pos < text_view.size()) {
-            auto next_map_result = map_char(text_view.substr(pos), base_font, map_result.type);
+            RETURN_IF_FAILED(m_base_fonts.get(key, resolved_base_font, resolve_base_font));
+        }
 
-            if (next_map_result.type != map_result.type)
-                break;
+        const auto& base_font = resolved_base_font.font;
 
-            pos += next_map_result.skip_length;
-        }
+        const auto [type, pos] = map_text({text, std::min(length, textLength)}, base_font);
 
-        if (map_result.type == EmojiType::NotEmoji)
+        if (type == EmojiType::NotEmoji)
             return m_base_fallback->MapCharacters(analysisSource, textPosition, gsl::narrow_cast<uint32_t>(pos),
                 baseFontCollection, baseFamilyName, baseWeight, baseStyle, baseStretch, mappedLength, mappedFont,
                 scale);
@@ -117,13 +297,30 @@ public:
         *mappedLength = gsl::narrow_cast<uint32_t>(pos);
         *scale = 1.0f;
 
-        if (map_result.type == EmojiType::UseBaseFont) {
-            RETURN_IF_FAILED(base_font.query_to(mappedFont));
+        if (type == EmojiType::UseBaseFont) {
+            base_font.copy_to(mappedFont);
             return S_OK;
         }
 
-        if (const auto& family = map_result.type == EmojiType::Emoji ? m_emoji_font_family : m_text_font_family)
-            LOG_IF_FAILED(family->GetFirstMatchingFont(baseWeight, baseStretch, baseStyle, mappedFont));
+        const auto is_emoji = type == EmojiType::Emoji;
+        const auto& family = is_emoji ? m_emoji_font_family : m_text_font_family;
+
+        if (!family)
+            return S_OK;
+
+        const FontKey key{nullptr, is_emoji ? m_emoji_family_name : m_text_family_name, baseWeight, baseStretch,
+            baseStyle};
+        const auto resolve_font = [&](ResolvedFont& resolved_font) {
+            return family->GetFirstMatchingFont(baseWeight, baseStretch, baseStyle, &resolved_font.font);
+        };
+
+        ResolvedFont resolved_font;
+
+        if (LOG_IF_FAILED(m_fallback_fonts.get(key, resolved_font, resolve_font)))
+            return S_OK;
+
+        if (resolved_font.font)
+            resolved_font.font.copy_to(mappedFont);
 
         return S_OK;
     }
@@ -137,39 +334,39 @@ public:
         uint32_t length{};
         RETURN_IF_FAILED(analysisSource->GetTextAtPosition(textPosition, &text, &length));
 
-        wil::com_ptr<IDWriteFont> base_font;
-
-        wil::com_ptr<IDWriteFontCollection2> base_font_collection_2;
+        const auto axis_values_key = make_axis_values_key(fontAxisValues, fontAxisValueCount);
+        const FontKey base_font_key{baseFontCollection, baseFamilyName ? baseFamilyName : L"", {}, {}, {},
+            axis_values_key};
+        ResolvedFont resolved_base_font;
 
-        if (baseFontCollection)
-            base_font_collection_2 = wil::try_com_query_nothrow<IDWriteFontCollection2>(baseFontCollection);
+        if (baseFontCollection && baseFamilyName) {
+            const auto resolve_base_font = [&](ResolvedFont& resolved_font) {
+                const auto base_font_collection_2
+                    = wil::try_com_query_nothrow<IDWriteFontCollection2>(baseFontCollection);
 
-        if (base_font_collection_2 && baseFamilyName) {
-            wil::com_ptr<IDWriteFontList2> base_font_list_2;
+                if (!base_font_collection_2)
+                    return S_OK;
 
-            RETURN_IF_FAILED(base_font_collection_2->GetMatchingFonts(
-                baseFamilyName, fontAxisValues, fontAxisValueCount, &base_font_list_2));
+                wil::com_ptr_nothrow<IDWriteFontList2> base_font_list_2;
 
-            if (base_font_list_2->GetFontCount() > 0) {
-                RETURN_IF_FAILED(base_font_list_2->GetFont(0, &base_font));
-            }
-        }
+                RETURN_IF_FAILED(base_font_collection_2->GetMatchingFonts(
+                    baseFamilyName, fontAxisValues, fontAxisValueCount, &base_font_list_2));
 
-        std::wstring_view text_view{text, length};
-        const auto map_result = map_char(text_view, base_font);
+                if (base_font_list_2->GetFontCount() > 0) {
+                    RETURN_IF_FAILED(base_font_list_2->GetFont(0, &resolved_font.font));
+                }
 
-        auto pos = map_result.skip_length;
+                return S_OK;
+            };
 
-        while (pos < text_view.size()) {
-            auto next_map_result = map_char(text_view.substr(pos), base_font, map_result.type);
+            RETURN_IF_FAILED(m_base_fonts.get(base_font_key, resolved_base_font, resolve_base_font));
+        }
 
-            if (next_map_result.type != map_result.type)
-                break;
+        const auto& base_font = resolved_base_font.font;
 
-            pos += next_map_result.skip_length;
-        }
+        const auto [type, pos] = map_text({text, std::min(length, textLength)}, base_font);
 
-        if (map_result.type == EmojiType::NotEmoji) {
+        if (type == EmojiType::NotEmoji) {
             return m_base_fallback_1->MapCharacters(analysisSource, textPosition, gsl::narrow_cast<uint32_t>(pos),
                 baseFontCollection, baseFamilyName, fontAxisValues, fontAxisValueCount, mappedLength, scale,
                 mappedFontFace);
@@ -178,14 +375,20 @@ public:
         *scale = 1.0f;
         *mappedLength = gsl::narrow_cast<uint32_t>(pos);
 
-        if (map_result.type == EmojiType::UseBaseFont) {
-            wil::com_ptr_nothrow<IDWriteFontFace> base_font_face;
-            RETURN_IF_FAILED(base_font->CreateFontFace(&base_font_face));
-            RETURN_IF_FAILED(base_font_face.query_to(mappedFontFace));
+        if (type == EmojiType::UseBaseFont) {
+            if (!resolved_base_font.font_face) {
+                wil::com_ptr_nothrow<IDWriteFontFace> base_font_face;
+                RETURN_IF_FAILED(base_font->CreateFontFace(&base_font_face));
+                RETURN_IF_FAILED(base_font_face.query_to(&resolved_base_font.font_face));
+                m_base_fonts.put(base_font_key, resolved_base_font);
+            }
+
+            resolved_base_font.font_face.copy_to(mappedFontFace);
             return S_OK;
         }
 
-        const auto& family = map_result.type == EmojiType::Emoji ? m_emoji_font_family : m_text_font_family;
+        const auto is_emoji = type == EmojiType::Emoji;
+        const auto& family = is_emoji ? m_emoji_font_family : m_text_font_family;
 
         if (!family)
             return S_OK;
@@ -195,13 +398,25 @@ public:
         if (!family_2)
             return E_NOINTERFACE;
 
-        wil::com_ptr<IDWriteFontSet1> font_set;
-        RETURN_IF_FAILED(family_2->GetFontSet(&font_set));
+        const FontKey key{nullptr, is_emoji ? m_emoji_family_name : m_text_family_name, {}, {}, {}, axis_values_key};
+        const auto resolve_font_face = [&](ResolvedFont& resolved_font) {
+            wil::com_ptr_nothrow<IDWriteFontSet1> font_set;
+            RETURN_IF_FAILED(family_2->GetFontSet(&font_set));
+
+            wil::com_ptr_nothrow<IDWriteFontSet1> matching_font_set;
+            RETURN_IF_FAILED(
+                font_set->GetMatchingFonts(nullptr, fontAxisValues, fontAxisValueCount, &matching_font_set));
 
-        wil::com_ptr<IDWriteFontSet1> matching_font_set;
-        RETURN_IF_FAILED(font_set->GetMatchingFonts(nullptr, fontAxisValues, fontAxisValueCount, &matching_font_set));
+            return matching_font_set->CreateFontFace(0, &resolved_font.font_face);
+        };
 
-        LOG_IF_FAILED(matching_font_set->CreateFontFace(0, mappedFontFace));
+        ResolvedFont resolved_font;
+
+        if (LOG_IF_FAILED(m_fallback_fonts.get(key, resolved_font, resolve_font_face)))
+            return S_OK;
+
+        if (resolved_font.font_face)
+            resolved_font.font_face.copy_to(mappedFontFace);
 
         return S_OK;
     }
@@ -216,85 +431,103 @@ private:
 
     struct MapResult {
         EmojiType type{};
-        size_t skip_length{};
+        size_t length{};
     };
 
-    MapResult map_char(std::wstring_view text, const wil::com_ptr<IDWriteFont>& base_font,
-        std::optional<EmojiType> previous_character_type = {}) const
+    /**
+     * Get the font type to use for the start of some text.
+     *
+     * \return  The type, and the number of UTF-16 code units it applies to
+     */
+    MapResult map_text(std::wstring_view text, const wil::com_ptr<IDWriteFont>& base_font) const
     {
-        uint32_t decoded{};
-        auto decoded_length = pfc::utf16_decode_char(text.data(), &decoded, text.size());
-
-        const auto iter = emoji::emojis.find(decoded);
-
-        const auto props = iter == emoji::emojis.end() ? std::nullopt : std::make_optional(iter->second);
-
-        const auto is_emoji = props && props->emoji;
-        const auto is_emoji_presentation = props && props->emoji_presentation;
-        const auto is_emoji_component = props && props->component;
-        const auto has_variation = props && props->has_variation;
-        const auto in_emoji_sequence = previous_character_type && previous_character_type == EmojiType::Emoji;
+        const auto base_has_character = [&](char32_t code_point) {
+            return base_font && m_font_coverage_cache.has_character(base_font, code_point);
+        };
 
-        const auto next_char = decoded_length < text.size() ? std::make_optional(text[decoded_length]) : std::nullopt;
-        const auto is_next_char_text_selector = next_char && *next_char == 0xFE0E;
-        const auto is_next_char_emoji_selector = next_char && *next_char == 0xFE0F;
-        const auto is_next_char_selector = is_next_char_text_selector || is_next_char_emoji_selector;
+        std::optional<EmojiType> run_type;
+        size_t position{};
 
-        const auto is_text_variation_selected = has_variation && is_next_char_text_selector;
-        const auto is_emoji_variation_selected = has_variation && is_next_char_emoji_selector;
+        while (position < text.size()) {
+            const auto segment = emoji::get_next_segment(text, position);
 
-        const auto base_has_character = [&] {
-            BOOL exists{};
+            if (segment.type != emoji::SegmentType::Text) {
+                const auto type = get_emoji_segment_type(segment, base_has_character);
 
-            if (base_font)
-                LOG_IF_FAILED(base_font->HasCharacter(decoded, &exists));
+                if (run_type && type != *run_type)
+                    break;
 
-            return exists == TRUE;
-        };
+                run_type = type;
+                position += segment.length;
+                continue;
+            }
 
-        const auto type = [&, this] {
-            if (!(is_emoji || is_emoji_component))
-                return base_has_character() ? EmojiType::UseBaseFont : EmojiType::NotEmoji;
+            // Characters outside of emoji sequences use the base font if it has them
+            const auto segment_end = position + segment.length;
+            const auto covered_end = base_font
+                ? position + m_font_coverage_cache.get_covered_length(base_font, text.substr(position, segment.length))
+                : segment_end;
 
-            if (!in_emoji_sequence && !is_emoji)
-                return base_has_character() ? EmojiType::UseBaseFont : EmojiType::NotEmoji;
+            // Map the start of the segment that the base font has all the
+            // characters of as a single run, checking it in one pass
+            if (covered_end > position) {
+                const auto type = base_font ? EmojiType::UseBaseFont : EmojiType::NotEmoji;
 
-            if (is_emoji_variation_selected)
-                return EmojiType::Emoji;
+                if (run_type && type != *run_type)
+                    break;
 
-            if (is_text_variation_selected)
-                return EmojiType::Text;
+                run_type = type;
+                position = covered_end;
+            }
 
-            if (is_emoji && base_has_character())
-                return EmojiType::UseBaseFont;
+            while (position < segment_end) {
+                const auto [code_point, length] = emoji::decode_utf16(text, position);
+                const auto is_variation_selector = code_point == emoji::text_variation_selector
+                    || code_point == emoji::emoji_variation_selector;
 
-            if (is_emoji_component && in_emoji_sequence && !has_variation)
-                return EmojiType::Emoji;
+                const auto type = run_type && is_variation_selector
+                    ? *run_type
+                    : base_has_character(code_point) ? EmojiType::UseBaseFont : EmojiType::NotEmoji;
 
-            if (!is_emoji && is_emoji_component && previous_character_type
-                && *previous_character_type == EmojiType::UseBaseFont && !has_variation)
-                return EmojiType::UseBaseFont;
+                if (run_type && type != *run_type)
+                    return {*run_type, position};
 
-            if (is_emoji_component && !is_emoji_presentation)
-                return EmojiType::NotEmoji;
+                run_type = type;
+                position += length;
+            }
+        }
 
-            if (!is_emoji_presentation) {
-                BOOL exists{};
+        return {run_type.value_or(EmojiType::NotEmoji), position};
+    }
 
-                if (m_text_font)
-                    LOG_IF_FAILED(m_text_font->HasCharacter(decoded, &exists));
+    template <class BaseHasCharacter>
+    EmojiType get_emoji_segment_type(const emoji::Segment& segment, BaseHasCharacter&& base_has_character) const
+    {
+        switch (segment.type) {
+        case emoji::SegmentType::EmojiSequence:
+            return EmojiType::Emoji;
+        case emoji::SegmentType::TextPresentationSequence:
+            return EmojiType::Text;
+        default:
+            break;
+        }
 
-                if (exists)
-                    return EmojiType::Text;
-            }
+        if (base_has_character(segment.code_point))
+            return EmojiType::UseBaseFont;
 
-            return is_emoji ? EmojiType::Emoji : EmojiType::NotEmoji;
-        }();
+        if (!segment.properties.emoji_presentation && m_text_font
+            && m_font_coverage_cache.has_character(m_text_font, segment.code_point))
+            return EmojiType::Text;
 
-        return MapResult{type, decoded_length + (is_next_char_selector ? 1 : 0)};
+        return EmojiType::Emoji;
     }
 
     std::atomic<ULONG> m_ref_count{};
+    mutable FontCoverageCache m_font_coverage_cache;
+    ResolvedFontCache m_base_fonts;
+    ResolvedFontCache m_fallback_fonts;
+    std::wstring m_text_family_name;
+    std::wstring m_emoji_family_name;
     wil::com_ptr<IDWriteFont> m_text_font;
     wil::com_ptr<IDWriteFontFamily> m_text_font_family;
     wil::com_ptr<IDWriteFontFamily> m_emoji_font_family;
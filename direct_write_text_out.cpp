@@ -4,6 +4,8 @@
 #include "direct_write_text_out.h"
 
 #include "direct_write_style_utils.h"
+#include "text_encoding.h"
+#include "text_scan.h"
 #include "text_style.h"
 
 using namespace std::string_view_literals;
@@ -12,74 +14,114 @@ namespace uih::direct_write {
 
 namespace {
 
+int width_dip_to_px(float width)
+{
+    return gsl::narrow_cast<int>(width * get_default_scaling_factor() + 1);
+}
+
 int measure_text_width_styles(
-    const TextFormat& text_format, std::wstring_view text, const text_style::FormatProperties& default_format)
+    const TextFormat& text_format, std::wstring_view text, const text_style::FormatPropertiesHandle& default_format)
 {
+    if (const auto cached_width = text_format.get_cached_text_width(text, default_format))
+        return width_dip_to_px(*cached_width);
+
     const auto text_without_newlines = text_style::remove_newlines(text);
     const auto text_without_newlines_view = text_without_newlines ? std::wstring_view(*text_without_newlines) : text;
-    const auto [processed_text, _, font_segments]
-        = text_style::process_colour_and_font_codes(text_without_newlines_view, default_format);
+    const auto processed
+        = text_style::process_colour_and_font_codes_cached(text_without_newlines_view, default_format);
 
     try {
-        auto text_layout = text_format.create_text_layout(processed_text, 65536.f, 65536.f, false);
-        set_layout_font_segments(text_layout, font_segments);
+        auto text_layout = text_format.create_text_layout(
+            processed->stripped_text ? *processed->stripped_text : text_without_newlines_view, 65536.f, 65536.f,
+            false);
+        set_layout_font_segments(text_layout, processed->font_segments);
         const auto metrics = text_layout.get_metrics();
-        return gsl::narrow_cast<int>(metrics.widthIncludingTrailingWhitespace * get_default_scaling_factor() + 1);
+        text_format.put_cached_text_width(text, default_format, metrics.widthIncludingTrailingWhitespace);
+        return width_dip_to_px(metrics.widthIncludingTrailingWhitespace);
     }
     CATCH_LOG()
 
     return 0;
 }
 
-std::shared_ptr<TextLayout> create_cached_text_layout_styles(const TextFormat& text_format, std::wstring_view text,
-    const RECT& rect, const text_style::FormatProperties& initial_format, alignment align, bool enable_colour_codes,
-    bool enable_ellipsis)
+std::pair<float, float> get_max_layout_size(const RECT& rect)
 {
-    std::optional<std::wstring> processed_text;
-    std::vector<text_style::ColourSegment> colour_segments;
-    std::vector<text_style::FontSegment> font_segments;
-
     const auto scaling_factor = get_default_scaling_factor();
     const auto max_width = std::max(0.f, gsl::narrow_cast<float>(wil::rect_width(rect)) / scaling_factor);
     const auto max_height = std::max(0.f, gsl::narrow_cast<float>(wil::rect_height(rect)) / scaling_factor);
-    const auto dwrite_alignment = get_text_alignment(align);
-    const auto serialised_initial_format = initial_format.serialise();
 
-    auto layout = text_format.get_cached_text_layout(
-        text, max_width, max_height, enable_ellipsis, dwrite_alignment, serialised_initial_format);
+    return {max_width, max_height};
+}
 
-    if (!layout) {
-        const auto text_without_newlines = text_style::remove_newlines(text);
-        const auto text_without_newlines_view
-            = text_without_newlines ? std::wstring_view(*text_without_newlines) : text;
+std::shared_ptr<TextLayout> create_text_layout_styles(const TextFormat& text_format, std::wstring_view text,
+    float max_width, float max_height, const text_style::FormatPropertiesHandle& initial_format, alignment align,
+    bool enable_colour_codes, bool enable_ellipsis)
+{
+    const auto text_without_newlines = text_style::remove_newlines(text);
+    const auto text_without_newlines_view = text_without_newlines ? std::wstring_view(*text_without_newlines) : text;
 
-        if (enable_colour_codes)
-            std::tie(processed_text, colour_segments, font_segments)
-                = text_style::process_colour_and_font_codes(text_without_newlines_view, initial_format);
+    std::shared_ptr<const text_style::ProcessedColourAndFontCodes> processed;
+    auto render_text = text_without_newlines_view;
 
-        if (align != ALIGN_LEFT) {
-            if (!processed_text)
-                processed_text = text;
+    if (enable_colour_codes) {
+        processed = text_style::process_colour_and_font_codes_cached(text_without_newlines_view, initial_format);
 
-            // Work around DirectWrite not rendering trailing whitespace
-            // for centre- and right-aligned text
-            processed_text->push_back(L'\u200b');
-        }
+        if (processed->stripped_text)
+            render_text = *processed->stripped_text;
     }
 
+    std::wstring aligned_render_text;
+
+    if (align != ALIGN_LEFT) {
+        // Work around DirectWrite not rendering trailing whitespace
+        // for centre- and right-aligned text
+        aligned_render_text.reserve(render_text.size() + 1);
+        aligned_render_text.append(render_text);
+        aligned_render_text.push_back(L'\u200b');
+        render_text = aligned_render_text;
+    }
+
+    auto layout = std::make_shared<TextLayout>(text_format.create_text_layout(
+        render_text, max_width, max_height, enable_ellipsis, get_text_alignment(align)));
+
+    if (!processed)
+        return layout;
+
+    for (auto& [colour, selected_colour, start_character, character_count] : processed->colour_segments) {
+        layout->set_colour(colour, selected_colour,
+            {gsl::narrow<uint32_t>(start_character), gsl::narrow<uint32_t>(character_count)});
+    }
+
+    set_layout_font_segments(*layout, processed->font_segments);
+
+    return layout;
+}
+
+std::shared_ptr<TextLayout> create_cached_text_layout_styles(const TextFormat& text_format, std::wstring_view text,
+    const RECT& rect, const text_style::FormatPropertiesHandle& initial_format, alignment align,
+    bool enable_colour_codes, bool enable_ellipsis)
+{
+    const auto [max_width, max_height] = get_max_layout_size(rect);
+    const auto dwrite_alignment = get_text_alignment(align);
+
+    if (auto layout = text_format.get_cached_text_layout(
+            text, max_width, max_height, enable_ellipsis, dwrite_alignment, initial_format))
+        return layout;
+
     try {
-        if (!layout) {
-            const auto render_text = processed_text ? *processed_text : text;
+        auto layout = create_text_layout_styles(
+            text_format, text, max_width, max_height, initial_format, align, enable_colour_codes, enable_ellipsis);
 
-            layout = text_format.create_cached_text_layout(
-                render_text, text, max_width, max_height, enable_ellipsis, dwrite_alignment, serialised_initial_format);
+        text_format.put_cached_text_layout(
+            text, max_width, max_height, enable_ellipsis, dwrite_alignment, initial_format, layout);
 
-            for (auto& [colour, selected_colour, start_character, character_count] : colour_segments) {
-                layout->set_colour(colour, selected_colour,
-                    {gsl::narrow<uint32_t>(start_character), gsl::narrow<uint32_t>(character_count)});
-            }
+        // If the text is on one line and isn't trimmed, the width including trailing whitespace is the same as what
+        // measure_text_width_styles() would get, so save it for later
+        if (enable_colour_codes && align == ALIGN_LEFT) {
+            const auto metrics = layout->get_metrics();
 
-            set_layout_font_segments(*layout, font_segments);
+            if (metrics.lineCount == 1 && !(enable_ellipsis && layout->is_trimmed()))
+                text_format.put_cached_text_width(text, initial_format, metrics.widthIncludingTrailingWhitespace);
         }
 
         return layout;
@@ -89,9 +131,21 @@ std::shared_ptr<TextLayout> create_cached_text_layout_styles(const TextFormat& t
     return {};
 }
 
+void render_text_layout(const TextLayout& text_layout, HWND wnd, HDC dc, const RECT& rect, COLORREF default_colour,
+    bool selected, const wil::com_ptr<IDWriteBitmapRenderTarget>& bitmap_render_target,
+    TextRenderBatch* render_batch, HMONITOR monitor)
+{
+    if (render_batch)
+        text_layout.render_with_transparent_background(*render_batch, rect, default_colour, selected);
+    else
+        text_layout.render_with_transparent_background(
+            wnd, dc, rect, default_colour, selected, 0.0f, bitmap_render_target, monitor);
+}
+
 int text_out_styles(const TextFormat& text_format, HWND wnd, HDC dc, std::wstring_view text, const RECT& rect,
-    bool selected, DWORD default_color, const text_style::FormatProperties& initial_format, alignment align,
-    bool enable_colour_codes, bool enable_ellipsis, wil::com_ptr<IDWriteBitmapRenderTarget> bitmap_render_target)
+    bool selected, DWORD default_color, const text_style::FormatPropertiesHandle& initial_format, alignment align,
+    bool enable_colour_codes, bool enable_ellipsis, wil::com_ptr<IDWriteBitmapRenderTarget> bitmap_render_target,
+    TextRenderBatch* render_batch, HMONITOR monitor)
 {
     if (wil::rect_is_empty(rect))
         return 0;
@@ -101,8 +155,8 @@ int text_out_styles(const TextFormat& text_format, HWND wnd, HDC dc, std::wstrin
         try {
             const auto metrics = text_layout->get_metrics();
 
-            text_layout->render_with_transparent_background(
-                wnd, dc, rect, default_color, selected, 0.0f, bitmap_render_target);
+            render_text_layout(
+                *text_layout, wnd, dc, rect, default_color, selected, bitmap_render_target, render_batch, monitor);
 
             const auto scaling_factor = get_default_scaling_factor();
 
@@ -170,6 +224,366 @@ int for_each_tab_column(std::wstring_view text, int x_offset, int border, const
     return total_width;
 }
 
+/*
+ * Tab columns can also be rendered using a single text layout containing the
+ * text of all columns, each preceded by a spacer that positions it where
+ * for_each_tab_column() would.
+ *
+ * This is only done when no column would be trimmed, as trimming can only
+ * happen at the end of a text layout.
+ */
+
+/** Replaced by a spacer before each column in a tab columns text layout */
+constexpr wchar_t tab_column_spacer_character = L'\uFFFC';
+
+/**
+ * Used in place of a text alignment in the cache keys of tab columns text layouts.
+ *
+ * get_text_alignment() never returns this, so the keys are distinct from those of
+ * other text layouts.
+ */
+constexpr auto tab_columns_layout_alignment_key = DWRITE_TEXT_ALIGNMENT_JUSTIFIED;
+
+struct TabColumnsText {
+    /**
+     * The text of all columns, each preceded by tab_column_spacer_character
+     *
+     * The last column is followed by a zero-width space, as it would be when
+     * right-aligned on its own, so that its trailing whitespace is measured and
+     * rendered in the same way.
+     */
+    std::wstring text;
+    std::vector<text_style::ColourSegment> colour_segments;
+    std::vector<text_style::FontSegment> font_segments;
+    /** The start and length of each column in text (including the zero-width space after the last column) */
+    std::vector<std::pair<size_t, size_t>> column_ranges;
+};
+
+struct TabColumnsLayoutPlan {
+    std::vector<std::wstring_view> columns;
+    TabColumnWidths widths;
+    /** The horizontal positions of columns, in DIPs, relative to the left of the text layout */
+    std::vector<float> positions;
+};
+
+std::vector<std::wstring_view> split_tab_columns(std::wstring_view text)
+{
+    std::vector<std::wstring_view> columns;
+    size_t start{};
+
+    while (true) {
+        const auto end = text.find(L'\t', start);
+        columns.emplace_back(text.substr(start, end == std::wstring_view::npos ? end : end - start));
+
+        if (end == std::wstring_view::npos)
+            break;
+
+        start = end + 1;
+    }
+
+    return columns;
+}
+
+bool contains_right_to_left_characters(std::wstring_view text)
+{
+    return std::ranges::any_of(text, [](wchar_t character) {
+        return (character >= 0x590 && character <= 0x8ff) || (character >= 0xfb1d && character <= 0xfdff)
+            || (character >= 0xfe70 && character <= 0xfeff) || character == 0x61c || character == 0x200f
+            || character == 0x202b || character == 0x202e || character == 0x2067
+            // High surrogates of right-to-left supplementary characters
+            || (character >= 0xd802 && character <= 0xd803) || (character >= 0xd83a && character <= 0xd83b);
+    });
+}
+
+std::optional<TabColumnsText> process_tab_columns_text(
+    std::span<const std::wstring_view> columns, const text_style::FormatPropertiesHandle& initial_format)
+{
+    TabColumnsText result;
+
+    for (auto&& column : columns) {
+        // Font codes can change the height of the line, which would change how
+        // columns are aligned vertically
+        if (text_scan::contains_any_of(column, L'\7'))
+            return {};
+
+        const auto column_without_newlines = text_style::remove_newlines(column);
+        const auto column_without_newlines_view
+            = column_without_newlines ? std::wstring_view(*column_without_newlines) : column;
+        const auto processed
+            = text_style::process_colour_and_font_codes_cached(column_without_newlines_view, initial_format);
+        const auto column_text
+            = processed->stripped_text ? std::wstring_view(*processed->stripped_text) : column_without_newlines_view;
+
+        // The bidirectional algorithm could reorder columns containing right-to-left text
+        if (contains_right_to_left_characters(column_text))
+            return {};
+
+        result.text.push_back(tab_column_spacer_character);
+
+        const auto offset = result.text.size();
+        result.text.append(column_text);
+
+        if (result.column_ranges.size() + 1 == columns.size())
+            result.text.push_back(L'\u200b');
+
+        result.column_ranges.emplace_back(offset, result.text.size() - offset);
+
+        for (auto colour_segment : processed->colour_segments) {
+            colour_segment.start_character += offset;
+            result.colour_segments.emplace_back(colour_segment);
+        }
+
+        for (auto font_segment : processed->font_segments) {
+            font_segment.start_character += offset;
+            result.font_segments.emplace_back(std::move(font_segment));
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Measure the width, in DIPs, of each tab column.
+ *
+ * This lays out the text of all columns in a single text layout. The widths
+ * exclude trailing whitespace, so that they match DWRITE_TEXT_METRICS::width
+ * as used when rendering each column in its own text layout.
+ *
+ * \return  The widths, which are empty if the columns can't be rendered using
+ *          a single text layout
+ */
+TabColumnWidths measure_tab_column_widths(const TextFormat& text_format,
+    std::span<const std::wstring_view> columns, const text_style::FormatPropertiesHandle& initial_format)
+{
+    const auto tab_columns_text = process_tab_columns_text(columns, initial_format);
+
+    if (!tab_columns_text)
+        return {};
+
+    const auto& column_ranges = tab_columns_text->column_ranges;
+    auto text_layout = text_format.create_text_layout(tab_columns_text->text, 65536.f, 65536.f, false);
+    set_layout_font_segments(text_layout, tab_columns_text->font_segments);
+
+    for (auto&& [start, _] : column_ranges)
+        text_layout.set_spacer(gsl::narrow<uint32_t>(start - 1), 0.0f);
+
+    TabColumnWidths widths{
+        std::vector<float>(column_ranges.size()), std::vector<float>(column_ranges.size())};
+    std::vector<float> trailing_whitespace_widths(column_ranges.size());
+    size_t position{};
+    size_t column_index{};
+
+    for (auto&& cluster : text_layout.get_cluster_metrics()) {
+        while (column_index < column_ranges.size()
+            && position >= column_ranges[column_index].first + column_ranges[column_index].second)
+            ++column_index;
+
+        if (column_index == column_ranges.size())
+            break;
+
+        if (position >= column_ranges[column_index].first) {
+            widths.advance_widths[column_index] += cluster.width;
+
+            if (cluster.isWhitespace)
+                trailing_whitespace_widths[column_index] += cluster.width;
+            else
+                trailing_whitespace_widths[column_index] = 0.0f;
+        }
+
+        position += cluster.length;
+    }
+
+    for (const auto index : std::views::iota(size_t{}, column_ranges.size()))
+        widths.widths[index] = widths.advance_widths[index] - trailing_whitespace_widths[index];
+
+    return widths;
+}
+
+/**
+ * Get the width, in DIPs, of each tab column, using the cache of the text format.
+ *
+ * Must be called on the thread that owns the text format.
+ */
+TabColumnWidths get_tab_column_widths(const TextFormat& text_format, std::wstring_view text,
+    std::span<const std::wstring_view> columns, const text_style::FormatPropertiesHandle& initial_format)
+{
+    if (auto widths = text_format.get_cached_tab_column_widths(text, initial_format))
+        return std::move(*widths);
+
+    TabColumnWidths widths;
+
+    try {
+        widths = measure_tab_column_widths(text_format, columns, initial_format);
+    }
+    CATCH_LOG()
+
+    text_format.put_cached_tab_column_widths(text, initial_format, widths);
+    return widths;
+}
+
+/**
+ * Get the positions of tab columns in a single text layout, matching where
+ * for_each_tab_column() would render them.
+ *
+ * \return  The positions, in DIPs, relative to rect.left + x_offset, or nothing
+ *          if any column would be trimmed
+ */
+std::optional<std::vector<float>> get_tab_column_positions(std::span<const std::wstring_view> columns,
+    const TabColumnWidths& widths, int x_offset, int border, const RECT& rect)
+{
+    const auto tab_count = gsl::narrow<int>(columns.size()) - 1;
+    const int total_width = std::max(0, static_cast<int>(wil::rect_width(rect)) - x_offset);
+
+    if (tab_count <= 0 || total_width == 0)
+        return {};
+
+    const auto scaling_factor = get_default_scaling_factor();
+    const auto origin = rect.left + x_offset;
+    std::vector<float> positions(columns.size());
+    auto right = rect.right;
+
+    for (const auto cell_index : std::views::iota(0, tab_count + 1)) {
+        const auto column_index = gsl::narrow_cast<size_t>(tab_count - cell_index);
+        const auto width = widths.widths[column_index];
+
+        if (columns[column_index].empty())
+            continue;
+
+        right -= border;
+
+        const auto left = cell_index == 0
+            ? origin
+            : std::min(rect.right - MulDiv(cell_index, total_width, tab_count) + border, right);
+
+        if (width > gsl::narrow_cast<float>(right - left) / scaling_factor)
+            return {};
+
+        if (cell_index == 0) {
+            // The last column is right-aligned
+            positions[column_index] = gsl::narrow_cast<float>(right - origin) / scaling_factor - width;
+            right -= gsl::narrow_cast<int>(width * scaling_factor + 1) + border;
+        } else {
+            positions[column_index] = gsl::narrow_cast<float>(left - origin) / scaling_factor;
+            right = left - border;
+        }
+    }
+
+    // Empty columns aren't rendered, but they still have spacers
+    for (const auto column_index : std::views::iota(size_t{}, columns.size())) {
+        if (columns[column_index].empty())
+            positions[column_index]
+                = column_index == 0 ? 0.0f : positions[column_index - 1] + widths.advance_widths[column_index - 1];
+    }
+
+    return positions;
+}
+
+bool can_use_tab_columns_layout(std::wstring_view text, const TextOutOptions& options)
+{
+    return options.enable_tab_columns && options.enable_style_codes && text.find(L'\t') != std::wstring_view::npos;
+}
+
+std::optional<TabColumnsLayoutPlan> plan_tab_columns_layout(std::vector<std::wstring_view> columns,
+    TabColumnWidths widths, int x_offset, int border, const RECT& rect)
+{
+    if (widths.widths.empty())
+        return {};
+
+    auto positions = get_tab_column_positions(columns, widths, x_offset, border, rect);
+
+    if (!positions)
+        return {};
+
+    return TabColumnsLayoutPlan{std::move(columns), std::move(widths), std::move(*positions)};
+}
+
+std::optional<TabColumnsLayoutPlan> plan_tab_columns_layout(const TextFormat& text_format, std::wstring_view text,
+    int x_offset, int border, const RECT& rect, const TextOutOptions& options)
+{
+    if (!can_use_tab_columns_layout(text, options))
+        return {};
+
+    auto columns = split_tab_columns(text);
+    auto widths = get_tab_column_widths(text_format, text, columns, options.initial_format);
+
+    return plan_tab_columns_layout(std::move(columns), std::move(widths), x_offset, border, rect);
+}
+
+RECT get_tab_columns_layout_rect(int x_offset, const RECT& rect)
+{
+    return {rect.left + x_offset, rect.top, rect.right, rect.bottom};
+}
+
+std::shared_ptr<TextLayout> create_tab_columns_text_layout(const TextFormat& text_format,
+    std::span<const std::wstring_view> columns, const TabColumnWidths& widths, std::span<const float> positions,
+    float max_width, float max_height, const text_style::FormatPropertiesHandle& initial_format)
+{
+    const auto tab_columns_text = process_tab_columns_text(columns, initial_format);
+
+    if (!tab_columns_text)
+        return {};
+
+    auto layout = std::make_shared<TextLayout>(text_format.create_text_layout(
+        tab_columns_text->text, max_width, max_height, false, DWRITE_TEXT_ALIGNMENT_LEADING));
+
+    float x{};
+
+    for (const auto column_index : std::views::iota(size_t{}, columns.size())) {
+        const auto spacer_width = std::max(0.0f, positions[column_index] - x);
+        const auto spacer_position = tab_columns_text->column_ranges[column_index].first - 1;
+
+        layout->set_spacer(gsl::narrow<uint32_t>(spacer_position), spacer_width);
+        x += spacer_width + widths.advance_widths[column_index];
+    }
+
+    for (auto& [colour, selected_colour, start_character, character_count] : tab_columns_text->colour_segments) {
+        layout->set_colour(colour, selected_colour,
+            {gsl::narrow<uint32_t>(start_character), gsl::narrow<uint32_t>(character_count)});
+    }
+
+    set_layout_font_segments(*layout, tab_columns_text->font_segments);
+
+    return layout;
+}
+
+/**
+ * Get the layout variant used in the cache keys of tab columns text layouts.
+ *
+ * The column positions depend on the border as well as the width of the text
+ * layout.
+ */
+uint32_t get_tab_columns_layout_variant(int border)
+{
+    return static_cast<uint32_t>(border);
+}
+
+std::shared_ptr<TextLayout> create_cached_tab_columns_text_layout(const TextFormat& text_format,
+    std::wstring_view text, const TabColumnsLayoutPlan& plan, int border, const RECT& layout_rect,
+    const TextOutOptions& options)
+{
+    const auto [max_width, max_height] = get_max_layout_size(layout_rect);
+    const auto layout_variant = get_tab_columns_layout_variant(border);
+
+    // The column positions depend on the width, so layouts can't be reused at a different width
+    if (auto layout = text_format.get_cached_text_layout(text, max_width, max_height, options.enable_ellipses,
+            tab_columns_layout_alignment_key, options.initial_format, false, layout_variant))
+        return layout;
+
+    try {
+        auto layout = create_tab_columns_text_layout(
+            text_format, plan.columns, plan.widths, plan.positions, max_width, max_height, options.initial_format);
+
+        if (layout)
+            text_format.put_cached_text_layout(text, max_width, max_height, options.enable_ellipses,
+                tab_columns_layout_alignment_key, options.initial_format, layout, layout_variant);
+
+        return layout;
+    }
+    CATCH_LOG()
+
+    return {};
+}
+
 } // namespace
 
 DWRITE_TEXT_ALIGNMENT get_text_alignment(alignment alignment_)
@@ -185,7 +599,7 @@ DWRITE_TEXT_ALIGNMENT get_text_alignment(alignment alignment_)
 }
 
 int measure_text_width_columns_and_styles(const TextFormat& text_format, std::wstring_view text, int x_offset,
-    int border, const text_style::FormatProperties& initial_format)
+    int border, const text_style::FormatPropertiesHandle& initial_format)
 {
     if (text.empty())
         return 0;
@@ -218,6 +632,10 @@ int is_text_trimmed_columns_and_styles(const TextFormat& text_format, std::wstri
         return false;
 
     const RECT rect{0, 0, max_width, max_height};
+
+    if (plan_tab_columns_layout(text_format, text, x_offset, border, rect, options))
+        return false;
+
     bool is_trimmed{};
 
     for_each_tab_column(text, x_offset, border, rect, options,
@@ -255,11 +673,25 @@ int text_out_columns_and_styles(const TextFormat& text_format, HWND wnd, HDC dc,
     if (wil::rect_is_empty(rect) || text.empty())
         return 0;
 
+    if (const auto plan = plan_tab_columns_layout(text_format, text, x_offset, border, rect, options)) {
+        const auto layout_rect = get_tab_columns_layout_rect(x_offset, rect);
+
+        if (const auto text_layout
+            = create_cached_tab_columns_text_layout(text_format, text, *plan, border, layout_rect, options)) {
+            try {
+                render_text_layout(*text_layout, wnd, dc, layout_rect, default_colour, options.is_selected,
+                    options.bitmap_render_target, options.render_batch, options.monitor);
+                return std::max(0, static_cast<int>(wil::rect_width(rect)) - x_offset);
+            }
+            CATCH_LOG()
+        }
+    }
+
     return for_each_tab_column(text, x_offset, border, rect, options,
         [&](std::wstring_view cell_text, const RECT& cell_rect, int cell_index, alignment align) -> std::optional<int> {
             return text_out_styles(text_format, wnd, dc, cell_text, cell_rect, options.is_selected, default_colour,
                 options.initial_format, align, options.enable_style_codes, options.enable_ellipses,
-                options.bitmap_render_target);
+                options.bitmap_render_target, options.render_batch, options.monitor);
         });
 }
 
@@ -267,7 +699,172 @@ int text_out_columns_and_styles(const TextFormat& text_format, HWND wnd, HDC dc,
     int border, const RECT& rect, COLORREF default_colour, const TextOutOptions& options)
 {
     return text_out_columns_and_styles(
-        text_format, wnd, dc, mmh::to_utf16(text), x_offset, border, rect, default_colour, options);
+        text_format, wnd, dc, utf8_to_utf16(text), x_offset, border, rect, default_colour, options);
+}
+
+void TextLayoutPrefetcher::prefetch(std::vector<TextLayoutPrefetchRequest> requests)
+{
+    try {
+        for (auto&& request : requests)
+            request.text_format->prepare_for_background_layout_creation();
+    }
+    CATCH_LOG_RETURN()
+
+    {
+        std::scoped_lock lock(m_mutex);
+        m_pending_requests = std::move(requests);
+    }
+
+    if (!m_thread)
+        start_thread();
+
+    m_condition.notify_one();
+}
+
+void TextLayoutPrefetcher::cancel()
+{
+    m_thread.reset();
+
+    std::scoped_lock lock(m_mutex);
+    m_pending_requests.clear();
+    m_prefetched_layouts.clear();
+    m_prefetched_tab_column_widths.clear();
+}
+
+void TextLayoutPrefetcher::commit()
+{
+    std::vector<PrefetchedLayout> prefetched_layouts;
+    std::vector<PrefetchedTabColumnWidths> prefetched_tab_column_widths;
+
+    {
+        std::scoped_lock lock(m_mutex);
+        prefetched_layouts = std::move(m_prefetched_layouts);
+        m_prefetched_layouts.clear();
+        prefetched_tab_column_widths = std::move(m_prefetched_tab_column_widths);
+        m_prefetched_tab_column_widths.clear();
+    }
+
+    for (auto&& [text_format, text_key, initial_format, widths] : prefetched_tab_column_widths)
+        text_format->put_cached_tab_column_widths(text_key, initial_format, std::move(widths));
+
+    // Layouts that are on screen are more useful than prefetched ones, so they're not evicted
+    for (auto&& prefetched_layout : prefetched_layouts) {
+        prefetched_layout.text_format->put_cached_text_layout(prefetched_layout.text_key, prefetched_layout.max_width,
+            prefetched_layout.max_height, prefetched_layout.enable_ellipsis, prefetched_layout.alignment,
+            prefetched_layout.initial_format, std::move(prefetched_layout.layout), prefetched_layout.layout_variant,
+            false);
+    }
+}
+
+void TextLayoutPrefetcher::start_thread()
+{
+    m_thread = std::jthread([this](std::stop_token stop_token) {
+        mmh::set_thread_description(GetCurrentThread(), thread_name.c_str());
+
+        while (true) {
+            std::vector<TextLayoutPrefetchRequest> requests;
+
+            {
+                std::unique_lock lock(m_mutex);
+
+                if (!m_condition.wait(lock, stop_token, [this] { return !m_pending_requests.empty(); }))
+                    return;
+
+                requests = std::move(m_pending_requests);
+                m_pending_requests.clear();
+            }
+
+            for (auto&& request : requests) {
+                // Newer requests supersede older ones (e.g. if the scroll target changed)
+                if (stop_token.stop_requested() || has_pending_requests())
+                    break;
+
+                process_request(request);
+            }
+
+            if (stop_token.stop_requested())
+                return;
+
+            m_on_layouts_ready();
+        }
+    });
+}
+
+bool TextLayoutPrefetcher::has_pending_requests()
+{
+    std::scoped_lock lock(m_mutex);
+    return !m_pending_requests.empty();
+}
+
+void TextLayoutPrefetcher::process_request(const TextLayoutPrefetchRequest& request)
+{
+    if (wil::rect_is_empty(request.rect) || request.text.empty())
+        return;
+
+    const auto& options = request.options;
+    std::vector<PrefetchedLayout> prefetched_layouts;
+
+    if (can_use_tab_columns_layout(request.text, options)) {
+        auto columns = split_tab_columns(request.text);
+        TabColumnWidths widths;
+
+        try {
+            widths = measure_tab_column_widths(*request.text_format, columns, options.initial_format);
+        }
+        CATCH_LOG()
+
+        const auto plan = plan_tab_columns_layout(columns, widths, request.x_offset, request.border, request.rect);
+
+        {
+            std::scoped_lock lock(m_mutex);
+            m_prefetched_tab_column_widths.emplace_back(PrefetchedTabColumnWidths{
+                request.text_format, request.text, options.initial_format, std::move(widths)});
+        }
+
+        if (plan) {
+            const auto layout_rect = get_tab_columns_layout_rect(request.x_offset, request.rect);
+            const auto [max_width, max_height] = get_max_layout_size(layout_rect);
+
+            try {
+                if (auto layout = create_tab_columns_text_layout(*request.text_format, plan->columns, plan->widths,
+                        plan->positions, max_width, max_height, options.initial_format)) {
+                    std::scoped_lock lock(m_mutex);
+                    m_prefetched_layouts.emplace_back(PrefetchedLayout{request.text_format, request.text,
+                        max_width, max_height, options.enable_ellipses, tab_columns_layout_alignment_key,
+                        options.initial_format, std::move(layout), get_tab_columns_layout_variant(request.border)});
+                    return;
+                }
+            }
+            CATCH_LOG()
+        }
+    }
+
+    for_each_tab_column(request.text, request.x_offset, request.border, request.rect, options,
+        [&](std::wstring_view cell_text, const RECT& cell_rect, int cell_index, alignment align) -> std::optional<int> {
+            if (wil::rect_is_empty(cell_rect))
+                return 0;
+
+            const auto [max_width, max_height] = get_max_layout_size(cell_rect);
+
+            try {
+                auto layout = create_text_layout_styles(*request.text_format, cell_text, max_width, max_height,
+                    options.initial_format, align, options.enable_style_codes, options.enable_ellipses);
+
+                const auto metrics = layout->get_metrics();
+
+                prefetched_layouts.emplace_back(PrefetchedLayout{request.text_format, std::wstring(cell_text),
+                    max_width, max_height, options.enable_ellipses, get_text_alignment(align),
+                    options.initial_format, std::move(layout)});
+
+                return gsl::narrow_cast<int>(metrics.width * get_default_scaling_factor() + 1);
+            } catch (...) {
+                LOG_CAUGHT_EXCEPTION();
+                return 0;
+            }
+        });
+
+    std::scoped_lock lock(m_mutex);
+    std::ranges::move(prefetched_layouts, std::back_inserter(m_prefetched_layouts));
 }
 
 } // namespace uih::direct_write
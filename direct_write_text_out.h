@@ -7,12 +7,19 @@ DWRITE_TEXT_ALIGNMENT get_text_alignment(alignment alignment_);
 
 struct TextOutOptions {
     wil::com_ptr<IDWriteBitmapRenderTarget> bitmap_render_target;
+    /** If set, text is rendered as part of this batch (and bitmap_render_target is not used) */
+    TextRenderBatch* render_batch{};
+    /**
+     * The monitor returned by get_window_monitor() for the window. If null, it's
+     * determined from the window for each text layout rendered.
+     */
+    HMONITOR monitor{};
     bool is_selected{};
     alignment align{ALIGN_LEFT};
     bool enable_ellipses{true};
     bool enable_style_codes{true};
     bool enable_tab_columns{true};
-    text_style::FormatProperties initial_format;
+    text_style::FormatPropertiesHandle initial_format;
 };
 
 int text_out_columns_and_styles(const TextFormat& text_format, HWND wnd, HDC dc, std::wstring_view text, int x_offset,
@@ -25,6 +32,101 @@ int is_text_trimmed_columns_and_styles(const TextFormat& text_format, std::wstri
     int max_width, int max_height, const TextOutOptions& options);
 
 int measure_text_width_columns_and_styles(const TextFormat& text_format, std::wstring_view text, int x_offset,
-    int border, const text_style::FormatProperties& initial_format = {});
+    int border, const text_style::FormatPropertiesHandle& initial_format = {});
+
+/**
+ * Text that is expected to be rendered soon using text_out_columns_and_styles().
+ *
+ * The parameters should match those that will be passed to text_out_columns_and_styles().
+ */
+struct TextLayoutPrefetchRequest {
+    const TextFormat* text_format{};
+    std::wstring text;
+    int x_offset{};
+    int border{};
+    RECT rect{};
+    TextOutOptions options;
+};
+
+/**
+ * Creates text layouts on a background thread so that they are already cached
+ * when they're needed for rendering.
+ *
+ * Text layouts are created on a worker thread, and then added to the text layout
+ * caches of the relevant text formats when commit() is called. on_layouts_ready
+ * is called on the worker thread when there are layouts ready to commit.
+ */
+class TextLayoutPrefetcher {
+public:
+    using LayoutsReadyFunc = std::function<void()>;
+
+    static constexpr wil::zwstring_view thread_name{L"[UI helpers] Text layout prefetch thread"};
+
+    explicit TextLayoutPrefetcher(LayoutsReadyFunc on_layouts_ready) : m_on_layouts_ready(std::move(on_layouts_ready))
+    {
+    }
+
+    ~TextLayoutPrefetcher() { cancel(); }
+
+    TextLayoutPrefetcher(const TextLayoutPrefetcher&) = delete;
+    TextLayoutPrefetcher& operator=(const TextLayoutPrefetcher&) = delete;
+
+    /**
+     * Start creating text layouts for the passed requests.
+     *
+     * Replaces any requests that have not been processed yet.
+     */
+    void prefetch(std::vector<TextLayoutPrefetchRequest> requests);
+
+    /**
+     * Discard all outstanding requests and prefetched layouts, and wait for the
+     * worker thread to exit.
+     *
+     * This must be called before a text format referenced by a request is destroyed.
+     */
+    void cancel();
+
+    /**
+     * Add prefetched layouts to the text layout caches of their text formats.
+     *
+     * Prefetched layouts don't evict layouts used in the current frame, so
+     * layouts that don't fit are discarded.
+     *
+     * Must be called on the thread that owns the text formats.
+     */
+    void commit();
+
+private:
+    struct PrefetchedLayout {
+        const TextFormat* text_format{};
+        std::wstring text_key;
+        float max_width{};
+        float max_height{};
+        bool enable_ellipsis{};
+        DWRITE_TEXT_ALIGNMENT alignment{};
+        text_style::FormatPropertiesHandle initial_format;
+        std::shared_ptr<TextLayout> layout;
+        uint32_t layout_variant{};
+    };
+
+    struct PrefetchedTabColumnWidths {
+        const TextFormat* text_format{};
+        std::wstring text_key;
+        text_style::FormatPropertiesHandle initial_format;
+        TabColumnWidths widths;
+    };
+
+    void start_thread();
+    bool has_pending_requests();
+    void process_request(const TextLayoutPrefetchRequest& request);
+
+    LayoutsReadyFunc m_on_layouts_ready;
+    std::mutex m_mutex;
+    std::condition_variable_any m_condition;
+    std::vector<TextLayoutPrefetchRequest> m_pending_requests;
+    std::vector<PrefetchedLayout> m_prefetched_layouts;
+    std::vector<PrefetchedTabColumnWidths> m_prefetched_tab_column_widths;
+    std::optional<std::jthread> m_thread;
+};
 
 } // namespace uih::direct_write
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "emoji_table.h"
+
 namespace uih::emoji {
 
 struct EmojiProperties {
@@ -9,6 +11,30 @@ struct EmojiProperties {
     bool component{};
 };
 
-extern const std::unordered_map<char32_t, EmojiProperties> emojis;
+/**
+ * Get the emoji properties of a code point.
+ *
+ * \return  The properties, or nothing if the code point is not an emoji, an
+ *          emoji component or the base of an emoji variation sequence
+ */
+constexpr std::optional<EmojiProperties> get_emoji_properties(char32_t code_point)
+{
+    const auto block_index = code_point >> detail::emoji_table_block_bits;
+
+    if (block_index >= detail::emoji_table_block_indices.size())
+        return {};
+
+    const auto& block = detail::emoji_table_blocks[detail::emoji_table_block_indices[block_index]];
+    const auto offset = code_point & ((1u << detail::emoji_table_block_bits) - 1);
+    const auto flags = (block[offset / 2] >> (offset % 2 * 4)) & 0xf;
+
+    if (flags == 0)
+        return {};
+
+    return EmojiProperties{.emoji = (flags & 0x1) != 0,
+        .emoji_presentation = (flags & 0x2) != 0,
+        .has_variation = (flags & 0x4) != 0,
+        .component = (flags & 0x8) != 0};
+}
 
 } // namespace uih::emoji
@@ -0,0 +1,275 @@
+#pragma once
+
+#include "emoji.h"
+
+/*
+ * Splits UTF-16 text into emoji sequences (as defined by UTS #51) and runs of
+ * other text.
+ *
+ * This has no dependencies on Windows, so that it can be used and tested on
+ * other platforms.
+ */
+
+namespace uih::emoji {
+
+enum class SegmentType {
+    /** Text that isn't part of an emoji sequence */
+    Text,
+    /** A single emoji character, without a variation selector */
+    EmojiCharacter,
+    /**
+     * An emoji presentation, keycap, modifier, flag, tag or ZWJ sequence.
+     *
+     * These should always be rendered using an emoji font.
+     */
+    EmojiSequence,
+    /** An emoji character followed by U+FE0E VARIATION SELECTOR-15 */
+    TextPresentationSequence,
+};
+
+struct Segment {
+    SegmentType type{};
+    /** The length of the segment, in UTF-16 code units */
+    size_t length{};
+    /** The first code point of the segment */
+    char32_t code_point{};
+    /** The emoji properties of the first code point (not set for Text segments) */
+    EmojiProperties properties{};
+};
+
+struct DecodedCodePoint {
+    char32_t code_point{};
+    /** The length of the code point, in UTF-16 code units */
+    size_t length{};
+};
+
+constexpr char32_t zero_width_joiner = 0x200d;
+constexpr char32_t combining_enclosing_keycap = 0x20e3;
+constexpr char32_t text_variation_selector = 0xfe0e;
+constexpr char32_t emoji_variation_selector = 0xfe0f;
+constexpr char32_t cancel_tag = 0xe007f;
+
+constexpr bool is_keycap_base(char32_t code_point)
+{
+    return (code_point >= U'0' && code_point <= U'9') || code_point == U'#' || code_point == U'*';
+}
+
+constexpr bool is_regional_indicator(char32_t code_point)
+{
+    return code_point >= 0x1f1e6 && code_point <= 0x1f1ff;
+}
+
+constexpr bool is_emoji_modifier(char32_t code_point)
+{
+    return code_point >= 0x1f3fb && code_point <= 0x1f3ff;
+}
+
+constexpr bool is_tag_spec(char32_t code_point)
+{
+    return code_point >= 0xe0020 && code_point <= 0xe007e;
+}
+
+/**
+ * Decode the code point at a position in UTF-16 text.
+ *
+ * Unpaired surrogates are returned as is.
+ */
+template <class Char>
+constexpr DecodedCodePoint decode_utf16(std::basic_string_view<Char> text, size_t position)
+{
+    static_assert(sizeof(Char) == 2);
+
+    const auto unit = static_cast<char32_t>(static_cast<char16_t>(text[position]));
+
+    if (unit >= 0xd800 && unit <= 0xdbff && position + 1 < text.size()) {
+        const auto low_unit = static_cast<char32_t>(static_cast<char16_t>(text[position + 1]));
+
+        if (low_unit >= 0xdc00 && low_unit <= 0xdfff)
+            return {0x10000 + ((unit - 0xd800) << 10) + (low_unit - 0xdc00), 2};
+    }
+
+    return {unit, 1};
+}
+
+namespace detail {
+
+/** Code points below this, other than keycap bases, U+00A9 and U+00AE, have no emoji properties */
+constexpr char32_t first_emoji_above_latin = 0x203c;
+
+template <class Char>
+constexpr std::optional<char32_t> peek_code_point(std::basic_string_view<Char> text, size_t position)
+{
+    if (position >= text.size())
+        return {};
+
+    return decode_utf16(text, position).code_point;
+}
+
+/**
+ * Get the emoji properties of a code point if an emoji sequence can start with it.
+ */
+template <class Char>
+constexpr std::optional<EmojiProperties> get_sequence_start_properties(
+    std::basic_string_view<Char> text, DecodedCodePoint decoded, size_t position)
+{
+    const auto code_point = decoded.code_point;
+
+    if (code_point < first_emoji_above_latin) {
+        if (is_keycap_base(code_point)) {
+            // Keycap bases are only emoji when followed by U+FE0F or U+20E3
+            const auto next = peek_code_point(text, position + decoded.length);
+
+            if (next != emoji_variation_selector && next != combining_enclosing_keycap)
+                return {};
+        } else if (code_point != 0xa9 && code_point != 0xae) {
+            return {};
+        }
+    }
+
+    const auto properties = get_emoji_properties(code_point);
+
+    if (!properties || !properties->emoji)
+        return {};
+
+    return properties;
+}
+
+/**
+ * Match an emoji ZWJ element (an emoji character, optionally followed by a
+ * presentation selector, an emoji modifier or a tag specification).
+ *
+ * \return  The end of the element, and whether it's longer than a single code point
+ */
+template <class Char>
+constexpr std::pair<size_t, bool> match_zwj_element(
+    std::basic_string_view<Char> text, size_t position, DecodedCodePoint decoded)
+{
+    const auto start = position;
+    position += decoded.length;
+
+    if (is_regional_indicator(decoded.code_point)) {
+        if (position < text.size()) {
+            const auto next = decode_utf16(text, position);
+
+            if (is_regional_indicator(next.code_point))
+                position += next.length;
+        }
+
+        return {position, position - start > decoded.length};
+    }
+
+    if (peek_code_point(text, position) == emoji_variation_selector)
+        ++position;
+
+    if (position < text.size()) {
+        const auto next = decode_utf16(text, position);
+
+        if (is_emoji_modifier(next.code_point))
+            position += next.length;
+    }
+
+    if (position < text.size() && is_tag_spec(decode_utf16(text, position).code_point)) {
+        while (position < text.size()) {
+            const auto tag = decode_utf16(text, position);
+
+            if (!is_tag_spec(tag.code_point) && tag.code_point != cancel_tag)
+                break;
+
+            position += tag.length;
+
+            if (tag.code_point == cancel_tag)
+                break;
+        }
+    }
+
+    return {position, position - start > decoded.length};
+}
+
+/**
+ * Match an emoji sequence at a position where get_sequence_start_properties()
+ * returned properties.
+ */
+template <class Char>
+constexpr Segment match_emoji_sequence(
+    std::basic_string_view<Char> text, size_t position, DecodedCodePoint decoded, EmojiProperties properties)
+{
+    const auto start = position;
+    const auto next = peek_code_point(text, position + decoded.length);
+
+    if (next == text_variation_selector && properties.has_variation)
+        return {SegmentType::TextPresentationSequence, decoded.length + 1, decoded.code_point, properties};
+
+    if (is_keycap_base(decoded.code_point)) {
+        auto end = position + decoded.length;
+
+        if (next == emoji_variation_selector)
+            ++end;
+
+        if (peek_code_point(text, end) == combining_enclosing_keycap)
+            ++end;
+
+        return {SegmentType::EmojiSequence, end - start, decoded.code_point, properties};
+    }
+
+    auto [end, is_sequence] = match_zwj_element(text, position, decoded);
+
+    while (peek_code_point(text, end) == zero_width_joiner && end + 1 < text.size()) {
+        const auto element_start = end + 1;
+        const auto element = decode_utf16(text, element_start);
+        const auto element_properties = get_emoji_properties(element.code_point);
+
+        if (!element_properties || !element_properties->emoji)
+            break;
+
+        end = match_zwj_element(text, element_start, element).first;
+        is_sequence = true;
+    }
+
+    // A variation selector on a character without variations has no effect
+    // (other than being part of the character's segment)
+    if (!is_sequence && next == text_variation_selector)
+        ++end;
+
+    return {is_sequence ? SegmentType::EmojiSequence : SegmentType::EmojiCharacter, end - start, decoded.code_point,
+        properties};
+}
+
+} // namespace detail
+
+/**
+ * Get the segment starting at a position in UTF-16 text.
+ *
+ * Call this repeatedly, advancing position by the length of each segment, to
+ * split text into segments in a single forward pass.
+ */
+template <class Char>
+constexpr Segment get_next_segment(std::basic_string_view<Char> text, size_t position)
+{
+    const auto decoded = decode_utf16(text, position);
+
+    if (const auto properties = detail::get_sequence_start_properties(text, decoded, position))
+        return detail::match_emoji_sequence(text, position, decoded, *properties);
+
+    auto end = position + decoded.length;
+
+    while (end < text.size()) {
+        const auto unit = static_cast<char16_t>(text[end]);
+
+        // Fast path for text without emoji
+        if (unit < detail::first_emoji_above_latin && !is_keycap_base(unit) && unit != 0xa9 && unit != 0xae) {
+            ++end;
+            continue;
+        }
+
+        const auto next_decoded = decode_utf16(text, end);
+
+        if (detail::get_sequence_start_properties(text, next_decoded, end))
+            break;
+
+        end += next_decoded.length;
+    }
+
+    return {SegmentType::Text, end - position, decoded.code_point};
+}
+
+} // namespace uih::emoji
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "list_view_layout.h"
+#include "list_view_sub_items.h"
 #include "list_view_search.h"
 #include "list_view_renderer.h"
 #include "../scroll.h"
@@ -25,13 +27,13 @@ public:
 
     static constexpr unsigned MSG_KILL_INLINE_EDIT = WM_USER + 3;
     static constexpr unsigned MSG_SMOOTH_SCROLL = WM_USER + 4;
+    static constexpr unsigned MSG_COMMIT_PREFETCHED_TEXT_LAYOUTS = WM_USER + 5;
 
     enum {
         TIMER_SCROLL_UP = 1001,
         TIMER_SCROLL_DOWN = 1002,
         TIMER_END_SEARCH,
         EDIT_TIMER_ID,
-        SMOOTH_SCROLL_TIMER_ID,
         TIMER_BASE
     };
 
@@ -74,7 +76,6 @@ public:
     class Item : public pfc::refcounted_object_root {
     public:
         t_uint8 m_line_count{1};
-        string_array m_subitems;
         std::vector<t_group_ptr> m_groups;
 
         size_t m_display_index{0};
@@ -84,7 +85,7 @@ public:
         void update_line_count()
         {
             m_line_count = 1;
-            for (auto&& subitem : m_subitems) {
+            for (auto&& subitem : m_subitems.get()) {
                 t_uint8 lc = 1;
                 const char* ptr = subitem.c_str();
                 while (*ptr) {
@@ -97,6 +98,31 @@ public:
                 m_line_count = std::max(m_line_count, lc);
             }
         }
+
+        const string_array& get_subitems() const { return m_subitems.get(); }
+
+        /**
+         * Get the sub-items for updating them.
+         *
+         * This discards the UTF-16 copies of the sub-items, so the returned
+         * reference should only be used to update the sub-items immediately.
+         */
+        string_array& get_subitems_for_update() { return m_subitems.get_for_update(); }
+
+        void set_subitems(string_array subitems) { m_subitems.set(std::move(subitems)); }
+
+        /**
+         * Get a UTF-16 copy of a sub-item, creating it if needed.
+         *
+         * The column must be less than the number of sub-items.
+         */
+        std::wstring_view get_subitem_utf16(size_t column);
+
+        void clear_subitems_utf16() { m_subitems.clear_utf16(); }
+
+    private:
+        /** Includes UTF-16 copies of the sub-items, if enabled (see set_cache_item_text_utf16()) */
+        lv::SubItems<pfc::string_simple> m_subitems;
     };
 
     class InsertItem {
@@ -242,8 +268,8 @@ public:
 
     [[nodiscard]] size_t get_group_count() const { return m_group_count; }
 
-    int get_columns_width();
-    int get_columns_display_width();
+    int get_columns_width() const;
+    int get_columns_display_width() const;
     int get_column_display_width(size_t index);
     alignment get_column_alignment(size_t index);
     size_t get_column_count();
@@ -263,6 +289,14 @@ public:
 
     void set_variable_height_items(bool b_variable_height_items) { m_variable_height_items = b_variable_height_items; }
 
+    /**
+     * Set whether UTF-16 copies of item text are kept, so that the text of
+     * unchanged items isn't converted from UTF-8 every time it's rendered.
+     *
+     * This uses more memory, and is disabled by default.
+     */
+    void set_cache_item_text_utf16(bool value);
+
     void set_selection_mode(SelectionMode mode) { m_selection_mode = mode; }
 
     void set_alternate_selection_model(bool b_alternate_selection) { m_alternate_selection = b_alternate_selection; }
@@ -376,36 +410,35 @@ public:
     void invalidate_items(const pfc::bit_array& mask);
 
     RECT get_item_group_info_area_render_rect(
-        size_t index, const std::optional<RECT>& items_rect = {}, std::optional<int> scroll_position = {});
+        size_t index, const std::optional<RECT>& items_rect = {}, std::optional<int> scroll_position = {}) const;
     void invalidate_item_group_info_area(size_t index);
 
     void update_items(size_t index, size_t count, bool invalidate = true);
     void update_all_items();
 
+    /**
+     * \brief                  Computes what would be drawn for an area of the items viewport.
+     * \param items_rect       The items area, relative to the client area
+     * \param paint_rect       The area being painted, relative to the client area
+     * \param scroll_position  Vertical scroll position to use instead of the current one
+     * \return                 Group headers, group info areas, items and the insert mark, in drawing order
+     */
+    [[nodiscard]] lv::DisplayList build_display_list(
+        const RECT& items_rect, const RECT& paint_rect, std::optional<int> scroll_position = {}) const
+    {
+        return get_layout().build_display_list(items_rect, paint_rect, scroll_position.value_or(m_scroll_position));
+    }
+
     // Current implementation clears sub-items.
     void reorder_items_partial(size_t base, const size_t* order, size_t count, bool update_focus_item = true);
 
-    enum class VerticalPositionCategory {
-        OnItem,
-        OnGroupHeader,
-        BetweenGroupHeaderAndItem,
-        BetweenItems,
-        NoItems,
-    };
+    using VerticalPositionCategory = lv::VerticalPositionCategory;
+    using VerticalHitTestResult = lv::VerticalHitTestResult;
 
-    struct VerticalHitTestResult {
-        VerticalPositionCategory position_category{};
-        /** The item at the y-position if position_category == OnItem, or the item before it if position_category ==
-         * BetweenItems */
-        int item_leftmost{};
-        /** The item at the y-position if position_category == OnItem, or the item after it if position_category ==
-         * BetweenItems */
-        int item_rightmost{};
-        size_t group_index{};
-        bool is_on_stuck_group_header{};
-    };
-
-    [[nodiscard]] VerticalHitTestResult underlying_items_vertical_hit_test(int y) const;
+    [[nodiscard]] VerticalHitTestResult underlying_items_vertical_hit_test(int y) const
+    {
+        return get_layout().vertical_hit_test(y);
+    }
     [[nodiscard]] VerticalHitTestResult visible_items_vertical_hit_test(int y) const;
 
     [[nodiscard]] int get_item_at_or_before(int y_position) const
@@ -443,11 +476,7 @@ public:
 
     [[nodiscard]] int get_item_group_header_total_height(size_t index) const
     {
-        if (index >= m_items.size())
-            return 0;
-
-        return gsl::narrow<int>(get_item_display_group_count(index)) * m_group_height
-            + get_leaf_group_header_bottom_margin(index);
+        return get_layout().get_item_group_header_total_height(index);
     }
 
     [[nodiscard]] int get_item_position(size_t index, bool b_include_headers = false) const
@@ -455,12 +484,10 @@ public:
         if (index >= m_items.size())
             return 0;
 
-        const int position = m_items[index]->m_display_position;
-
         if (b_include_headers)
-            return position - get_item_group_header_total_height(index);
+            return get_layout().get_item_position(index, true);
 
-        return position;
+        return m_items[index]->m_display_position;
     }
 
     [[nodiscard]] int get_item_position_bottom(size_t index) const
@@ -479,35 +506,7 @@ public:
     int get_leaf_group_header_bottom_margin(std::optional<size_t> index = {}) const;
     int get_stuck_leaf_group_header_bottom_margin() const;
 
-    int get_item_group_bottom(size_t index) const
-    {
-        if (index >= m_items.size()) {
-            assert(false);
-            return 0;
-        }
-
-        const auto [group_start, group_size] = get_item_group_range(index, m_group_count ? m_group_count - 1 : 0);
-
-        assert(group_size > 0);
-
-        if (group_size > 0)
-            index = group_start + group_size - 1;
-
-        int ret = get_item_position(index) + m_item_height - 1;
-
-        if (get_show_group_info_area() && m_visible_group_count > 0) {
-            int gheight = gsl::narrow<int>(group_size) * m_item_height;
-            int group_cy = get_group_info_area_total_height();
-            const auto bottom_margin = get_group_items_bottom_margin(index);
-
-            if (gheight < group_cy)
-                ret += std::max(bottom_margin, group_cy - gheight);
-            else
-                ret += bottom_margin;
-        }
-
-        return ret;
-    }
+    int get_item_group_bottom(size_t index) const { return get_layout().get_item_group_bottom(index); }
 
     void refresh_item_positions();
 
@@ -599,6 +598,16 @@ public:
 
     const char* get_item_text(size_t index, size_t column);
 
+    /**
+     * Get item text converted to UTF-16.
+     *
+     * \param buffer  Storage for the converted text, used if UTF-16 item text
+     *                isn't being cached
+     * \return        The converted text. This is valid until the item is next
+     *                updated or buffer is next modified.
+     */
+    std::wstring_view get_item_text_utf16(size_t index, size_t column, std::wstring& buffer);
+
     size_t get_item_count() { return m_items.size(); }
 
     void activate_inline_editing(size_t column_start = 0);
@@ -653,7 +662,12 @@ protected:
 
     Item* get_item(size_t index) { return m_items[index].get_ptr(); }
 
-    string_array& get_item_subitems(size_t index) { return m_items[index]->m_subitems; }
+    /**
+     * Get the sub-items of an item for updating them (for example, in update_item_data()).
+     *
+     * The returned reference should only be used to update the sub-items immediately.
+     */
+    string_array& get_item_subitems(size_t index) { return m_items[index]->get_subitems_for_update(); }
 
     size_t get_item_display_index(size_t index) { return m_items[index]->m_display_index; }
 
@@ -732,12 +746,7 @@ protected:
         }
     }
 
-    struct GroupInfoAreaPadding {
-        int left{};
-        int top{};
-        int right{};
-        int bottom{};
-    };
+    using GroupInfoAreaPadding = lv::GroupInfoAreaPadding;
 
     GroupInfoAreaPadding get_group_info_area_padding() const;
 
@@ -790,27 +799,49 @@ protected:
     int get_total_indentation() const;
     [[nodiscard]] int get_stuck_group_headers_height(std::optional<int> scroll_position = {}) const;
 
-    struct StuckGroupHeadersInfo {
-        int height{};
-        size_t last_index{};
+    using StuckGroupHeadersInfo = lv::StuckGroupHeadersInfo;
 
-        auto operator<=>(const StuckGroupHeadersInfo&) const = default;
-    };
+    [[nodiscard]] StuckGroupHeadersInfo get_stuck_group_headers_info(std::optional<int> scroll_position = {}) const
+    {
+        return get_layout().get_stuck_group_headers_info(scroll_position.value_or(m_scroll_position));
+    }
 
-    [[nodiscard]] StuckGroupHeadersInfo get_stuck_group_headers_info(std::optional<int> scroll_position = {}) const;
+    using GroupHeaderRenderInfo = lv::GroupHeaderRenderInfo;
 
-    struct GroupHeaderRenderInfo {
-        size_t group_start{};
-        size_t group_count{};
-        int items_viewport_y{};
-        int height{};
-        bool is_display_leaf{};
-        bool is_hidden{};
-        bool is_stuck{};
+    GroupHeaderRenderInfo get_group_header_render_info(
+        size_t item_index, size_t group_index, std::optional<int> scroll_position = {}) const
+    {
+        return get_layout().get_group_header_render_info(
+            item_index, group_index, scroll_position.value_or(m_scroll_position));
+    }
+
+    /** Items of the list view, as seen by lv::ItemsLayout */
+    class LayoutItems {
+    public:
+        explicit LayoutItems(const ListView& list_view) : m_list_view(&list_view) {}
+
+        size_t size() const { return m_list_view->m_items.size(); }
+        size_t group_count() const { return m_list_view->m_group_count; }
+        int get_position(size_t index) const { return m_list_view->m_items[index]->m_display_position; }
+        int get_height(size_t index) const { return m_list_view->get_item_height(index); }
+
+        const Group* get_group(size_t index, size_t level) const
+        {
+            return m_list_view->m_items[index]->m_groups[level].get_ptr();
+        }
+
+        bool is_group_hidden(size_t index, size_t level) const
+        {
+            return m_list_view->m_items[index]->m_groups[level]->is_hidden();
+        }
+
+    private:
+        const ListView* m_list_view;
     };
 
-    GroupHeaderRenderInfo get_group_header_render_info(
-        size_t item_index, size_t group_index, std::optional<int> scroll_position = {}) const;
+    [[nodiscard]] lv::LayoutMetrics get_layout_metrics() const;
+
+    [[nodiscard]] lv::ItemsLayout<LayoutItems> get_layout() const { return {LayoutItems(*this), get_layout_metrics()}; }
 
     ColourData render_get_colour_data()
     {
@@ -895,11 +926,19 @@ private:
     virtual Item* storage_create_item() { return new Item; }
     virtual Group* storage_create_group() { return new Group; }
 
+    /**
+     * Get the initial format of the text of a cell.
+     *
+     * This is called for every cell measured or rendered, and the result is
+     * interned. It should return one of a small number of distinct formats (such
+     * as one per column).
+     */
     virtual std::optional<std::reference_wrapper<text_style::FormatProperties>> get_initial_format(
         size_t item_index, size_t column_index)
     {
         return {};
     }
+    text_style::FormatPropertiesHandle get_initial_format_handle(size_t item_index, size_t column_index);
     int measure_text_width(size_t item_index, size_t column_index);
 
     virtual bool render_drag_image(LPSHDRAGIMAGE lpsdi);
@@ -946,6 +985,16 @@ private:
     LRESULT on_message(HWND wnd, UINT msg, WPARAM wp, LPARAM lp);
 
     void render_items(HDC dc, const RECT& rc_update);
+    void update_text_layout_cache_sizes(const RECT& items_rect);
+    void clear_items_text_layout_cache_size() const;
+    void clear_group_text_layout_cache_size() const;
+    std::vector<lv::RendererSubItem> get_renderer_sub_items(size_t index);
+
+    /**
+     * \brief Starts creating text layouts for items that will become visible
+     *        during the current smooth scroll animation.
+     */
+    void prefetch_text_layouts();
     void insert_items_in_internal_state(size_t index_start, size_t count, const InsertItem* items);
     bool replace_items_in_internal_state(size_t index_start, size_t count, const InsertItem* items);
     void remove_item_in_internal_state(size_t remove_index);
@@ -1033,6 +1082,9 @@ private:
     mutable std::optional<int> m_space_width;
     std::optional<direct_write::TextFormat> m_header_text_format;
     std::optional<direct_write::TextFormat> m_group_text_format;
+    std::optional<direct_write::TextLayoutPrefetcher> m_text_layout_prefetcher;
+    /** The range of scroll positions, including the viewport, of the last prefetch requests */
+    std::optional<std::pair<int, int>> m_prefetched_scroll_range;
 
     std::optional<D2DDragImageCreator> m_drag_image_creator;
 
@@ -1074,6 +1126,7 @@ private:
     int m_vertical_item_padding{};
 
     bool m_variable_height_items{false};
+    bool m_cache_item_text_utf16{};
 
     bool m_ignore_next_wm_char_message{};
     bool m_ignore_next_wm_syschar_message{};
@@ -4,13 +4,13 @@
 
 namespace uih {
 
-int ListView::get_columns_width()
+int ListView::get_columns_width() const
 {
     return std::accumulate(
         m_columns.begin(), m_columns.end(), 0, [](auto&& value, auto&& column) { return value + column.m_size; });
 }
 
-int ListView::get_columns_display_width()
+int ListView::get_columns_display_width() const
 {
     return std::accumulate(m_columns.begin(), m_columns.end(), 0,
         [](auto&& value, auto&& column) { return value + column.m_display_size; });
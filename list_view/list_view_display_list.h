@@ -0,0 +1,38 @@
+#pragma once
+
+namespace uih::lv {
+
+enum class DisplayListEntryType {
+    GroupHeader,
+    GroupInfo,
+    Item,
+    InsertMark,
+};
+
+struct DisplayListEntry {
+    DisplayListEntryType type{};
+    /** First item of the group for group headers and group info areas, otherwise the item index */
+    size_t item_index{};
+    size_t group_index{};
+    int indentation{};
+    RECT rect{};
+    /** Stuck group headers need to be excluded from the clip region before this entry is drawn */
+    bool exclude_stuck_headers{};
+    /** Area to exclude from the clip region after this entry is drawn (stuck group headers only) */
+    std::optional<RECT> exclude_rect_after;
+};
+
+/**
+ * The headers, items, group info areas and insert mark that would be drawn for a
+ * particular viewport and scroll position, in the order they would be drawn.
+ *
+ * Building a display list requires no device context, so it can be used to
+ * measure or verify viewport computation independently of painting.
+ */
+struct DisplayList {
+    std::vector<DisplayListEntry> entries;
+    RECT items_rect{};
+    int stuck_headers_height{};
+};
+
+} // namespace uih::lv
@@ -187,51 +187,6 @@ int ListView::get_first_unobscured_item(bool use_target_position)
     return index;
 }
 
-ListView::VerticalHitTestResult ListView::underlying_items_vertical_hit_test(int y) const
-{
-    const auto item_count = gsl::narrow<int>(m_items.size());
-
-    if (item_count == 0)
-        return {VerticalPositionCategory::NoItems};
-
-    auto max = item_count;
-    auto min = 0;
-
-    while (min <= max) {
-        const auto middle = (min + max) / 2;
-        const auto item_group_headers_top = get_item_position(middle, true);
-        const auto item_top = get_item_position(middle);
-        const auto item_bottom = get_item_position_bottom(middle);
-        if (y >= item_bottom)
-            min = middle + 1;
-        else if (y < item_group_headers_top)
-            max = middle - 1;
-        else if (y < item_top) {
-            assert(m_group_count > 0);
-
-            if (y >= item_top - get_leaf_group_header_bottom_margin())
-                return {VerticalPositionCategory::BetweenGroupHeaderAndItem, middle, middle};
-
-            const auto group_headers_bottom = item_top - get_leaf_group_header_bottom_margin() - 1;
-            const auto display_group_reverse_index = (group_headers_bottom - y) / m_group_height;
-            const auto group_index = display_group_reverse_index_to_group_index(middle, display_group_reverse_index);
-
-            return {
-                VerticalPositionCategory::OnGroupHeader,
-                middle,
-                middle,
-                group_index,
-            };
-        } else
-            return {VerticalPositionCategory::OnItem, middle, middle};
-    }
-
-    const int index_before = std::clamp(max, 0, item_count - 1);
-    const int index_after = std::clamp(min, 0, item_count);
-
-    return {VerticalPositionCategory::BetweenItems, index_before, index_after};
-}
-
 ListView::VerticalHitTestResult ListView::visible_items_vertical_hit_test(int y) const
 {
     const auto result = underlying_items_vertical_hit_test(y);
@@ -2,79 +2,77 @@
 
 #include "list_view.h"
 
+#include "../text_encoding.h"
+
 #define GROUP_STRING_COMPARE strcmp
 
 namespace uih {
 
+std::wstring_view ListView::Item::get_subitem_utf16(size_t column)
+{
+    return m_subitems.get_utf16(column, [](const pfc::string_simple& text) { return utf8_to_utf16(text.c_str()); });
+}
+
 const char* ListView::get_item_text(size_t index, size_t column)
 {
     if (index >= m_items.size())
         return "";
-    if (m_items[index]->m_subitems.size() != get_column_count())
+    if (m_items[index]->get_subitems().size() != get_column_count())
         update_item_data(index);
-    if (column >= m_items[index]->m_subitems.size())
+    if (column >= m_items[index]->get_subitems().size())
         return "";
-    return m_items[index]->m_subitems[column];
+    return m_items[index]->get_subitems()[column];
 }
 
-bool ListView::get_is_new_group(size_t index) const
+std::wstring_view ListView::get_item_text_utf16(size_t index, size_t column, std::wstring& buffer)
 {
-    if (m_group_count == 0)
-        return false;
+    const char* text = get_item_text(index, column);
 
-    if (index == 0)
-        return true;
+    if (!m_cache_item_text_utf16) {
+        utf8_to_utf16(text, buffer);
+        return buffer;
+    }
+
+    // The text is empty in this case
+    if (index >= m_items.size() || column >= m_items[index]->get_subitems().size())
+        return {};
 
-    return m_items[index - 1]->m_groups.back() != m_items[index]->m_groups.back();
+    return m_items[index]->get_subitem_utf16(column);
 }
 
-size_t ListView::display_group_reverse_index_to_group_index(size_t item_index, size_t display_group_reverse_index) const
+void ListView::set_cache_item_text_utf16(bool value)
 {
-    assert(m_group_count > 0);
-
-    auto levels_remaining = display_group_reverse_index + 1;
-    auto group_index = m_group_count - 1;
+    m_cache_item_text_utf16 = value;
 
-    for (auto&& [index, group] : ranges::views::enumerate(m_items[item_index]->m_groups) | ranges::views::reverse) {
-        if (!group->is_hidden())
-            --levels_remaining;
-
-        if (levels_remaining == 0) {
-            group_index = index;
-            break;
-        }
-
-        assert(index > 0);
+    if (!m_cache_item_text_utf16) {
+        for (auto&& item : m_items)
+            item->clear_subitems_utf16();
     }
+}
+
+bool ListView::get_is_new_group(size_t index) const
+{
+    return lv::is_new_group(LayoutItems(*this), index);
+}
 
-    return group_index;
+size_t ListView::display_group_reverse_index_to_group_index(size_t item_index, size_t display_group_reverse_index) const
+{
+    return lv::display_group_reverse_index_to_group_index(LayoutItems(*this), item_index, display_group_reverse_index);
 }
 
 size_t ListView::get_cumulative_item_display_group_count(size_t index, std::optional<size_t> max_groups) const
 {
-    return ranges::count_if(m_items[index]->m_groups | ranges::views::take(max_groups.value_or(m_group_count)),
-        [](auto& group) { return !group->is_hidden(); });
+    return lv::get_cumulative_display_group_count(LayoutItems(*this), index, max_groups);
 }
 
 size_t ListView::get_item_display_group_count(size_t index, std::optional<size_t> max_groups) const
 {
-    if (index == 0)
-        return get_cumulative_item_display_group_count(index, max_groups);
-
-    auto zipped_groups = ranges::views::zip(m_items[index - 1]->m_groups, m_items[index]->m_groups);
-
-    return ranges::count_if(
-        zipped_groups | ranges::views::take(max_groups.value_or(m_group_count)), [](const auto& pair) {
-            const auto& [previous_item_group, this_item_group] = pair;
-
-            return previous_item_group != this_item_group && !this_item_group->is_hidden();
-        });
+    return lv::get_display_group_count(LayoutItems(*this), index, max_groups);
 }
 
 size_t ListView::get_item_cumulative_display_group_count(size_t index, std::optional<size_t> max_groups) const
 {
-    return ranges::count_if(m_items[index]->m_groups | ranges::views::take(max_groups.value_or(m_group_count)),
-        [](auto& group) { return !group->is_hidden(); });
+    return lv::get_cumulative_display_group_count(LayoutItems(*this), index, max_groups);
 }
 
 bool ListView::is_group_visible(size_t item_index, size_t group_index) const
@@ -204,7 +202,7 @@ bool ListView::replace_items_in_internal_state(size_t index_start, size_t replac
         {
             item = storage_create_item();
             item->m_selected = m_items[absolute_index]->m_selected;
-            item->m_subitems = items[relative_index].m_subitems;
+            item->set_subitems(items[relative_index].m_subitems);
             m_items[absolute_index] = item;
             item->m_display_index = absolute_index ? m_items[absolute_index - 1]->m_display_index + 1 : 0;
             item->m_groups.resize(m_group_count);
@@ -338,7 +336,7 @@ void ListView::insert_items_in_internal_state(size_t index_start, size_t insert_
             Item* item;
             item = storage_create_item();
             p_items[index] = item;
-            item->m_subitems = items[l].m_subitems;
+            item->set_subitems(items[l].m_subitems);
             item->m_groups.resize(count);
         });
 
@@ -349,7 +347,7 @@ void ListView::insert_items_in_internal_state(size_t index_start, size_t insert_
 
             item->m_display_index = index ? p_items[index - 1]->m_display_index + 1 : 0;
             if (m_variable_height_items) {
-                if (item->m_subitems.size() != get_column_count())
+                if (item->get_subitems().size() != get_column_count())
                     update_item_data(index);
                 item->update_line_count();
             }
@@ -448,54 +446,8 @@ void ListView::insert_items_in_internal_state(size_t index_start, size_t insert_
 
 void ListView::calculate_item_positions(size_t index_start)
 {
-    if (index_start >= get_item_count())
-        return;
-
-    int y_pointer = 0;
-
-    if (m_group_count > 0) {
-        if (m_visible_group_count == 0) {
-            index_start = 0;
-        } else {
-            while (index_start > 0 && !get_is_new_group(index_start))
-                --index_start;
-        }
-    }
-
-    if (index_start > 0) {
-        if (m_visible_group_count > 0)
-            y_pointer = get_item_group_bottom(index_start - 1) + 1;
-        else
-            y_pointer = get_item_position(index_start - 1) + get_item_height(index_start - 1);
-    }
-
-    size_t count = m_items.size();
-    int group_height_counter = 0;
-    const auto group_minimum_inner_height = get_group_minimum_inner_height();
-
-    for (size_t i = index_start; i < count; i++) {
-        const auto is_new_group = get_is_new_group(i);
-        const auto display_group_count = gsl::narrow<int>(get_item_display_group_count(i));
-
-        if (is_new_group) {
-            const auto bottom_margin = i > index_start ? get_group_items_bottom_margin(i - 1) : 0;
-
-            if (group_height_counter > 0) {
-                if (group_height_counter < group_minimum_inner_height)
-                    y_pointer += std::max(bottom_margin, group_minimum_inner_height - group_height_counter);
-                else
-                    y_pointer += bottom_margin;
-            }
-
-            group_height_counter = 0;
-
-            y_pointer += get_leaf_group_header_bottom_margin(i);
-        }
-        group_height_counter += get_item_height(i);
-        y_pointer += display_group_count * m_group_height;
-        m_items[i]->m_display_position = y_pointer;
-        y_pointer += get_item_height(i);
-    }
+    get_layout().calculate_item_positions(
+        index_start, [this](size_t index, int position) { m_items[index]->m_display_position = position; });
 }
 
 void ListView::calculate_visible_group_count()
@@ -0,0 +1,689 @@
+#pragma once
+
+#include "list_view_display_list.h"
+
+/*
+ * Vertical layout of list view items and group headers.
+ *
+ * Nothing here depends on a window, so that it can be used (and tested) with
+ * plain item heights and group assignments.
+ */
+
+namespace uih::lv {
+
+/**
+ * \brief Items and their groups, as seen by the layout functions.
+ *
+ * Adjacent items are in the same group at a level if get_group() returns equal
+ * values for them. Hidden groups (groups with no text) have no header.
+ */
+template <class Items>
+concept LayoutItems = requires(const Items& items, size_t index, size_t level) {
+    { items.size() } -> std::convertible_to<size_t>;
+    { items.group_count() } -> std::convertible_to<size_t>;
+    /** The top of the item (below its group headers), set using calculate_item_positions() */
+    { items.get_position(index) } -> std::convertible_to<int>;
+    { items.get_height(index) } -> std::convertible_to<int>;
+    { items.get_group(index, level) } -> std::equality_comparable;
+    { items.is_group_hidden(index, level) } -> std::convertible_to<bool>;
+};
+
+struct GroupInfoAreaPadding {
+    int left{};
+    int top{};
+    int right{};
+    int bottom{};
+};
+
+/**
+ * Sizes and settings that the layout depends on, other than the items
+ * themselves.
+ */
+struct LayoutMetrics {
+    /** The height of an item with one line of text */
+    int item_height{1};
+    int group_height{1};
+    /** The maximum number of group headers shown above any item */
+    size_t visible_group_count{};
+    /** Whether group headers stick to the top of the viewport (only when groups are visible) */
+    bool sticky_group_headers{};
+    /** Whether group info areas are shown (only when groups are visible) */
+    bool show_group_info_area{};
+    bool is_group_info_area_sticky{};
+    int group_info_area_width{};
+    int group_info_area_height{};
+    GroupInfoAreaPadding group_info_area_padding{};
+    /** The minimum height of the items of a leaf group, so that its group info area fits */
+    int group_minimum_inner_height{};
+    /** Space between the last group header of a new group and its first item */
+    int leaf_group_header_bottom_margin{};
+    /** Space below the last stuck group header */
+    int stuck_leaf_group_header_bottom_margin{};
+    /** Space after the last item of a group, when followed by another group */
+    int group_items_bottom_margin{};
+    int root_group_indentation_amount{};
+    int indentation_step{};
+    /** Total indentation of items, including group info areas */
+    int total_indentation{};
+    int columns_display_width{};
+    int horizontal_scroll_position{};
+    /** The insert mark is drawn before this item (or after the last item, if equal to the item count) */
+    std::optional<size_t> insert_mark_index;
+    int insert_mark_height{};
+};
+
+enum class VerticalPositionCategory {
+    OnItem,
+    OnGroupHeader,
+    BetweenGroupHeaderAndItem,
+    BetweenItems,
+    NoItems,
+};
+
+struct VerticalHitTestResult {
+    VerticalPositionCategory position_category{};
+    /** The item at the y-position if position_category == OnItem, or the item before it if position_category ==
+     * BetweenItems */
+    int item_leftmost{};
+    /** The item at the y-position if position_category == OnItem, or the item after it if position_category ==
+     * BetweenItems */
+    int item_rightmost{};
+    size_t group_index{};
+    bool is_on_stuck_group_header{};
+};
+
+struct GroupHeaderRenderInfo {
+    size_t group_start{};
+    size_t group_count{};
+    int items_viewport_y{};
+    int height{};
+    bool is_display_leaf{};
+    bool is_hidden{};
+    bool is_stuck{};
+};
+
+struct StuckGroupHeadersInfo {
+    int height{};
+    size_t last_index{};
+
+    auto operator<=>(const StuckGroupHeadersInfo&) const = default;
+};
+
+template <LayoutItems Items>
+bool is_new_group(const Items& items, size_t index)
+{
+    if (items.group_count() == 0)
+        return false;
+
+    if (index == 0)
+        return true;
+
+    const auto leaf_level = items.group_count() - 1;
+    return items.get_group(index - 1, leaf_level) != items.get_group(index, leaf_level);
+}
+
+/**
+ * The number of group headers that aren't hidden that an item is in, including
+ * headers shown above earlier items.
+ */
+template <LayoutItems Items>
+size_t get_cumulative_display_group_count(const Items& items, size_t index, std::optional<size_t> max_groups = {})
+{
+    const auto level_count = std::min(max_groups.value_or(items.group_count()), items.group_count());
+    size_t count{};
+
+    for (size_t level{}; level < level_count; ++level)
+        if (!items.is_group_hidden(index, level))
+            ++count;
+
+    return count;
+}
+
+/** The number of group headers shown directly above an item */
+template <LayoutItems Items>
+size_t get_display_group_count(const Items& items, size_t index, std::optional<size_t> max_groups = {})
+{
+    if (index == 0)
+        return get_cumulative_display_group_count(items, index, max_groups);
+
+    const auto level_count = std::min(max_groups.value_or(items.group_count()), items.group_count());
+    size_t count{};
+
+    for (size_t level{}; level < level_count; ++level)
+        if (items.get_group(index - 1, level) != items.get_group(index, level) && !items.is_group_hidden(index, level))
+            ++count;
+
+    return count;
+}
+
+/** Converts an index counting up from the leaf group header above an item, skipping hidden groups, to a level */
+template <LayoutItems Items>
+size_t display_group_reverse_index_to_group_index(
+    const Items& items, size_t item_index, size_t display_group_reverse_index)
+{
+    assert(items.group_count() > 0);
+
+    auto levels_remaining = display_group_reverse_index + 1;
+
+    for (auto level = items.group_count(); level > 0; --level) {
+        if (!items.is_group_hidden(item_index, level - 1))
+            --levels_remaining;
+
+        if (levels_remaining == 0)
+            return level - 1;
+
+        assert(level > 1);
+    }
+
+    return items.group_count() - 1;
+}
+
+/** The first item and number of items in the group at a level that an item is in */
+template <LayoutItems Items>
+std::tuple<size_t, size_t> get_group_range(const Items& items, size_t index, size_t level)
+{
+    if (items.group_count() == 0)
+        return {size_t{}, items.size()};
+
+    const auto group = items.get_group(index, level);
+    size_t start{index};
+
+    while (start > 0 && items.get_group(start - 1, level) == group)
+        --start;
+
+    size_t end{index};
+
+    while (end + 1 < items.size() && items.get_group(end + 1, level) == group)
+        ++end;
+
+    return {start, end - start + 1};
+}
+
+/**
+ * \brief Vertical layout of items, group headers and group info areas.
+ *
+ * Positions are relative to the top of the items area when not scrolled, and
+ * 'items viewport' y-coordinates are relative to the top of the items area at
+ * the passed scroll position.
+ */
+template <LayoutItems Items>
+class ItemsLayout {
+public:
+    ItemsLayout(Items items, const LayoutMetrics& metrics) : m_items(std::move(items)), m_metrics(metrics) {}
+
+    [[nodiscard]] const LayoutMetrics& metrics() const { return m_metrics; }
+
+    [[nodiscard]] int get_leaf_group_header_bottom_margin(std::optional<size_t> index = {}) const
+    {
+        if (index && !is_new_group(m_items, *index))
+            return 0;
+
+        return m_metrics.leaf_group_header_bottom_margin;
+    }
+
+    [[nodiscard]] int get_group_items_bottom_margin(size_t index) const
+    {
+        return index + 1 == m_items.size() ? 0 : m_metrics.group_items_bottom_margin;
+    }
+
+    [[nodiscard]] int get_item_group_header_total_height(size_t index) const
+    {
+        if (index >= m_items.size())
+            return 0;
+
+        return gsl::narrow<int>(get_display_group_count(m_items, index)) * m_metrics.group_height
+            + get_leaf_group_header_bottom_margin(index);
+    }
+
+    [[nodiscard]] int get_item_position(size_t index, bool include_headers = false) const
+    {
+        if (index >= m_items.size())
+            return 0;
+
+        const int position = m_items.get_position(index);
+
+        if (include_headers)
+            return position - get_item_group_header_total_height(index);
+
+        return position;
+    }
+
+    [[nodiscard]] int get_item_position_bottom(size_t index) const
+    {
+        if (index >= m_items.size())
+            return 0;
+
+        return get_item_position(index) + m_items.get_height(index);
+    }
+
+    /** The last y-position used by the group of an item, including its group info area and bottom margin */
+    [[nodiscard]] int get_item_group_bottom(size_t index) const
+    {
+        if (index >= m_items.size()) {
+            assert(false);
+            return 0;
+        }
+
+        const auto [group_start, group_size]
+            = get_group_range(m_items, index, m_items.group_count() ? m_items.group_count() - 1 : 0);
+
+        assert(group_size > 0);
+
+        if (group_size > 0)
+            index = group_start + group_size - 1;
+
+        int ret = get_item_position(index) + m_metrics.item_height - 1;
+
+        if (m_metrics.show_group_info_area) {
+            const int group_items_height = gsl::narrow<int>(group_size) * m_metrics.item_height;
+            const auto bottom_margin = get_group_items_bottom_margin(index);
+
+            if (group_items_height < m_metrics.group_minimum_inner_height)
+                ret += std::max(bottom_margin, m_metrics.group_minimum_inner_height - group_items_height);
+            else
+                ret += bottom_margin;
+        }
+
+        return ret;
+    }
+
+    /**
+     * \brief Calculates the positions of items from their heights and groups.
+     *
+     * \param index_start   The first item whose position may have changed
+     * \param set_position  Called with the index and position of each item from (about) index_start onwards
+     */
+    template <class SetPosition>
+    void calculate_item_positions(size_t index_start, SetPosition&& set_position) const
+    {
+        if (index_start >= m_items.size())
+            return;
+
+        int y_pointer = 0;
+
+        if (m_items.group_count() > 0) {
+            if (m_metrics.visible_group_count == 0) {
+                index_start = 0;
+            } else {
+                while (index_start > 0 && !is_new_group(m_items, index_start))
+                    --index_start;
+            }
+        }
+
+        if (index_start > 0) {
+            if (m_metrics.visible_group_count > 0)
+                y_pointer = get_item_group_bottom(index_start - 1) + 1;
+            else
+                y_pointer = get_item_position(index_start - 1) + m_items.get_height(index_start - 1);
+        }
+
+        const size_t count = m_items.size();
+        int group_height_counter = 0;
+
+        for (size_t i = index_start; i < count; i++) {
+            const auto display_group_count = gsl::narrow<int>(get_display_group_count(m_items, i));
+
+            if (is_new_group(m_items, i)) {
+                const auto bottom_margin = i > index_start ? get_group_items_bottom_margin(i - 1) : 0;
+
+                if (group_height_counter > 0) {
+                    if (group_height_counter < m_metrics.group_minimum_inner_height)
+                        y_pointer
+                            += std::max(bottom_margin, m_metrics.group_minimum_inner_height - group_height_counter);
+                    else
+                        y_pointer += bottom_margin;
+                }
+
+                group_height_counter = 0;
+
+                y_pointer += get_leaf_group_header_bottom_margin(i);
+            }
+
+            const auto item_height = m_items.get_height(i);
+            group_height_counter += item_height;
+            y_pointer += display_group_count * m_metrics.group_height;
+            set_position(i, y_pointer);
+            y_pointer += item_height;
+        }
+    }
+
+    /** Finds the item or group header at a position, ignoring stuck group headers */
+    [[nodiscard]] VerticalHitTestResult vertical_hit_test(int y) const
+    {
+        const auto item_count = gsl::narrow<int>(m_items.size());
+
+        if (item_count == 0)
+            return {VerticalPositionCategory::NoItems};
+
+        auto max = item_count;
+        auto min = 0;
+
+        while (min <= max) {
+            const auto middle = (min + max) / 2;
+            const auto item_group_headers_top = get_item_position(middle, true);
+            const auto item_top = get_item_position(middle);
+            const auto item_bottom = get_item_position_bottom(middle);
+            if (y >= item_bottom)
+                min = middle + 1;
+            else if (y < item_group_headers_top)
+                max = middle - 1;
+            else if (y < item_top) {
+                assert(m_items.group_count() > 0);
+
+                if (y >= item_top - get_leaf_group_header_bottom_margin())
+                    return {VerticalPositionCategory::BetweenGroupHeaderAndItem, middle, middle};
+
+                const auto group_headers_bottom = item_top - get_leaf_group_header_bottom_margin() - 1;
+                const auto display_group_reverse_index = (group_headers_bottom - y) / m_metrics.group_height;
+                const auto group_index
+                    = display_group_reverse_index_to_group_index(m_items, middle, display_group_reverse_index);
+
+                return {
+                    VerticalPositionCategory::OnGroupHeader,
+                    middle,
+                    middle,
+                    group_index,
+                };
+            } else
+                return {VerticalPositionCategory::OnItem, middle, middle};
+        }
+
+        const int index_before = std::clamp(max, 0, item_count - 1);
+        const int index_after = std::clamp(min, 0, item_count);
+
+        return {VerticalPositionCategory::BetweenItems, index_before, index_after};
+    }
+
+    [[nodiscard]] int get_item_at_or_before(int y_position) const
+    {
+        return vertical_hit_test(y_position).item_leftmost;
+    }
+
+    [[nodiscard]] int get_item_at_or_after(int y_position) const
+    {
+        return vertical_hit_test(y_position).item_rightmost;
+    }
+
+    [[nodiscard]] GroupHeaderRenderInfo get_group_header_render_info(
+        size_t item_index, size_t group_index, int scroll_position) const
+    {
+        assert(item_index < m_items.size());
+        assert(group_index < m_items.group_count());
+
+        const auto group_height = m_metrics.group_height;
+        auto [group_start, group_item_count] = get_group_range(m_items, item_index, group_index);
+
+        const auto display_group_count = get_display_group_count(m_items, group_start);
+        const auto display_group_index = get_display_group_count(m_items, group_start, group_index);
+        const auto is_leaf = display_group_index + 1 == display_group_count;
+        const auto is_hidden = static_cast<bool>(m_items.is_group_hidden(item_index, group_index));
+        const auto height = is_hidden ? 0 : group_height;
+
+        const auto min_group_top = get_item_position(group_start) - scroll_position
+            - group_height * gsl::narrow<int>(display_group_count - display_group_index)
+            - get_leaf_group_header_bottom_margin();
+
+        if (!m_metrics.sticky_group_headers)
+            return GroupHeaderRenderInfo{
+                group_start, group_item_count, min_group_top, height, is_leaf, is_hidden, false};
+
+        const auto leaf_level = m_items.group_count() - 1;
+        auto [final_leaf_group_start, final_leaf_group_item_count]
+            = get_group_range(m_items, group_start + group_item_count - 1, leaf_level);
+        const auto final_leaf_group_first_item_top = get_item_position(final_leaf_group_start) - scroll_position;
+        const auto group_bottom = final_leaf_group_first_item_top
+            + std::max(m_metrics.group_minimum_inner_height,
+                gsl::narrow<int>(final_leaf_group_item_count) * m_metrics.item_height);
+
+        const auto cumulative_display_group_index
+            = get_cumulative_display_group_count(m_items, group_start, group_index);
+
+        const auto max_group_top = group_bottom
+            - group_height * gsl::narrow<int>(display_group_count - display_group_index)
+            - m_metrics.stuck_leaf_group_header_bottom_margin;
+
+        const auto render_pos = std::max(
+            min_group_top, std::min(gsl::narrow<int>(cumulative_display_group_index) * group_height, max_group_top));
+
+        const auto is_stuck = render_pos != min_group_top;
+
+        return GroupHeaderRenderInfo{group_start, group_item_count, render_pos, height, is_leaf, is_hidden, is_stuck};
+    }
+
+    [[nodiscard]] StuckGroupHeadersInfo get_stuck_group_headers_info(int scroll_position) const
+    {
+        if (!m_metrics.sticky_group_headers || scroll_position == 0)
+            return {};
+
+        const auto vht_result = vertical_hit_test(scroll_position);
+
+        if (vht_result.position_category == VerticalPositionCategory::NoItems)
+            return {};
+
+        const auto leaf_level = m_items.group_count() - 1;
+        const auto item_index = gsl::narrow<size_t>(vht_result.item_leftmost);
+        const auto render_info = get_group_header_render_info(item_index, leaf_level, scroll_position);
+
+        if (!render_info.is_stuck)
+            return {};
+
+        const auto next_child_group_index = render_info.group_start + render_info.group_count;
+
+        if (next_child_group_index < m_items.size()) {
+            const auto next_render_info
+                = get_group_header_render_info(next_child_group_index, leaf_level, scroll_position);
+
+            if (next_render_info.is_stuck)
+                return {next_render_info.items_viewport_y + next_render_info.height
+                        + m_metrics.stuck_leaf_group_header_bottom_margin,
+                    next_render_info.group_start};
+        }
+
+        return {render_info.items_viewport_y + render_info.height + m_metrics.stuck_leaf_group_header_bottom_margin,
+            render_info.group_start};
+    }
+
+    [[nodiscard]] int get_stuck_group_headers_height(int scroll_position) const
+    {
+        return get_stuck_group_headers_info(scroll_position).height;
+    }
+
+    /** The rect of the group info area of the leaf group of an item, relative to the client area */
+    [[nodiscard]] RECT get_item_group_info_area_render_rect(
+        size_t index, const RECT& items_rect, int scroll_position) const
+    {
+        if (!m_metrics.show_group_info_area) {
+            assert(false);
+            return {};
+        }
+
+        const auto leaf_level = m_items.group_count() - 1;
+        const auto leaf_group_header_render_info = get_group_header_render_info(index, leaf_level, scroll_position);
+
+        const auto artwork_indentation = m_metrics.root_group_indentation_amount
+            + m_metrics.indentation_step * (gsl::narrow<int>(m_metrics.visible_group_count) - 1);
+        const auto& padding = m_metrics.group_info_area_padding;
+
+        const auto [group_first_item, group_item_count] = get_group_range(m_items, index, leaf_level);
+
+        const auto group_first_item_top = get_item_position(group_first_item) - scroll_position;
+        const auto group_leaf_header_bottom = m_metrics.is_group_info_area_sticky
+                && leaf_group_header_render_info.is_stuck
+            ? leaf_group_header_render_info.items_viewport_y + leaf_group_header_render_info.height
+                + get_leaf_group_header_bottom_margin()
+            : group_first_item_top;
+        const auto group_bottom = group_first_item_top
+            + std::max(m_metrics.group_minimum_inner_height,
+                gsl::narrow<int>(group_item_count) * m_metrics.item_height);
+
+        const auto left = 0 - m_metrics.horizontal_scroll_position + artwork_indentation + padding.left;
+        const auto right = left + m_metrics.group_info_area_width;
+
+        int top = group_leaf_header_bottom + static_cast<int>(items_rect.top) + padding.top;
+
+        if (top < items_rect.top && m_metrics.is_group_info_area_sticky) {
+            const auto sticky_pos = static_cast<int>(items_rect.top);
+            top = std::max(top, sticky_pos);
+        }
+
+        const auto items_bottom_minus_info_height = group_bottom - m_metrics.group_info_area_height
+            + static_cast<int>(items_rect.top) - padding.bottom;
+        top = std::min(top, items_bottom_minus_info_height);
+
+        const auto bottom = top + m_metrics.group_info_area_height;
+
+        return {left, top, right, bottom};
+    }
+
+    /**
+     * \brief                  Computes what would be drawn for an area of the items viewport.
+     * \param items_rect       The items area, relative to the client area
+     * \param paint_rect       The area being painted, relative to the client area
+     * \param scroll_position  Vertical scroll position
+     * \return                 Group headers, group info areas, items and the insert mark, in drawing order
+     */
+    [[nodiscard]] DisplayList build_display_list(
+        const RECT& items_rect, const RECT& paint_rect, int scroll_position) const
+    {
+        DisplayList display_list{.items_rect = items_rect};
+
+        if (paint_rect.bottom <= paint_rect.top || paint_rect.bottom < items_rect.top)
+            return display_list;
+
+        const auto count = m_items.size();
+        const auto group_count = m_items.group_count();
+        const auto indentation_step = m_metrics.visible_group_count > 0 ? m_metrics.indentation_step : 0;
+        const auto item_indentation = m_metrics.total_indentation;
+        const auto cx = m_metrics.columns_display_width + item_indentation;
+        const auto items_top = static_cast<int>(items_rect.top);
+        const auto paint_top = static_cast<int>(paint_rect.top);
+        const auto paint_bottom = static_cast<int>(paint_rect.bottom);
+
+        size_t i = gsl::narrow<size_t>(
+            get_item_at_or_before((paint_top > items_top ? paint_top - items_top : 0) + scroll_position));
+
+        const size_t i_start = i;
+        const size_t i_end = gsl::narrow<size_t>(
+            get_item_at_or_after((paint_bottom > items_top + 1 ? paint_bottom - items_top - 1 : 0) + scroll_position));
+
+        display_list.stuck_headers_height
+            = paint_top > items_top ? get_stuck_group_headers_height(scroll_position) : 0;
+        bool has_excluded_stuck_headers{};
+
+        auto should_exclude_stuck_headers = [&](const RECT& render_area) {
+            if (!has_excluded_stuck_headers && display_list.stuck_headers_height > 0
+                && render_area.bottom > items_top + display_list.stuck_headers_height) {
+                has_excluded_stuck_headers = true;
+                return true;
+            }
+            return false;
+        };
+
+        for (; i <= i_end && i < count; i++) {
+            const auto is_first_item = i == i_start;
+            [[maybe_unused]] size_t display_group_index{};
+            size_t indentation_level{};
+
+            for (size_t group_index = 0; group_index < group_count; group_index++) {
+                const auto is_hidden = static_cast<bool>(m_items.is_group_hidden(i, group_index));
+                const auto previous_indentation_level = indentation_level;
+
+                if (!is_hidden)
+                    ++indentation_level;
+
+                if (i > 0 && m_items.get_group(i, group_index) == m_items.get_group(i - 1, group_index)) {
+                    // Should be impossible for groups to be the same if one was already rendered.
+                    assert(m_metrics.sticky_group_headers || display_group_index == 0);
+
+                    if (!(m_metrics.sticky_group_headers && is_first_item))
+                        continue;
+                }
+
+                if (is_hidden)
+                    continue;
+
+                const auto header_info = get_group_header_render_info(i, group_index, scroll_position);
+
+                const auto y = header_info.items_viewport_y + items_top;
+                const int x = -m_metrics.horizontal_scroll_position + static_cast<int>(items_rect.left);
+
+                const RECT rc = {x, y, x + cx, y + m_metrics.group_height};
+
+                if (rc.top >= paint_rect.bottom)
+                    break;
+
+                const auto indentation = m_metrics.root_group_indentation_amount
+                    + indentation_step * gsl::narrow<int>(previous_indentation_level);
+
+                std::optional<RECT> exclude_rect_after;
+
+                if (header_info.is_stuck)
+                    exclude_rect_after = RECT{rc.left, rc.top, rc.right,
+                        rc.bottom
+                            + (header_info.is_display_leaf ? m_metrics.stuck_leaf_group_header_bottom_margin : 0)};
+
+                display_list.entries.emplace_back(DisplayListEntry{.type = DisplayListEntryType::GroupHeader,
+                    .item_index = header_info.group_start,
+                    .group_index = group_index,
+                    .indentation = indentation,
+                    .rect = rc,
+                    .exclude_rect_after = exclude_rect_after});
+
+                ++display_group_index;
+            }
+
+            if (m_metrics.show_group_info_area) {
+                const auto [item_group_start, _] = get_group_range(m_items, i, group_count ? group_count - 1 : 0);
+
+                if (is_first_item || i == item_group_start) {
+                    const auto rc_group_info
+                        = get_item_group_info_area_render_rect(item_group_start, items_rect, scroll_position);
+
+                    if (rc_group_info.top < paint_rect.bottom)
+                        display_list.entries.emplace_back(DisplayListEntry{.type = DisplayListEntryType::GroupInfo,
+                            .item_index = item_group_start,
+                            .rect = rc_group_info,
+                            .exclude_stuck_headers = should_exclude_stuck_headers(rc_group_info)});
+                }
+            }
+
+            const auto item_top = get_item_position(i) - scroll_position + items_top;
+            const RECT rc_item = {0 - m_metrics.horizontal_scroll_position + item_indentation, item_top,
+                cx - m_metrics.horizontal_scroll_position, item_top + m_items.get_height(i)};
+
+            if (rc_item.top >= paint_rect.bottom)
+                break;
+
+            display_list.entries.emplace_back(DisplayListEntry{.type = DisplayListEntryType::Item,
+                .item_index = i,
+                .rect = rc_item,
+                .exclude_stuck_headers = should_exclude_stuck_headers(rc_item)});
+        }
+
+        if (m_metrics.insert_mark_index && *m_metrics.insert_mark_index <= count) {
+            const auto insert_mark_index = *m_metrics.insert_mark_index;
+            int y_pos = 0;
+
+            if (count) {
+                if (insert_mark_index == count)
+                    y_pos = get_item_position_bottom(count - 1) - scroll_position + items_top - 1;
+                else
+                    y_pos = get_item_position(insert_mark_index) - scroll_position + items_top - 1;
+            }
+
+            const RECT rc_line{item_indentation - m_metrics.horizontal_scroll_position, y_pos,
+                cx - m_metrics.horizontal_scroll_position, y_pos + m_metrics.insert_mark_height};
+
+            display_list.entries.emplace_back(DisplayListEntry{
+                .type = DisplayListEntryType::InsertMark, .item_index = insert_mark_index, .rect = rc_line});
+        }
+
+        return display_list;
+    }
+
+private:
+    Items m_items;
+    LayoutMetrics m_metrics;
+};
+
+} // namespace uih::lv
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 
 #include "list_view.h"
+#include "../text_encoding.h"
 #include "../text_style.h"
 
 using namespace std::chrono_literals;
@@ -16,11 +17,7 @@ void ListView::on_first_show()
 
 int ListView::get_group_items_bottom_margin(size_t index) const
 {
-    if (!get_show_group_info_area() || !m_is_group_info_area_header_spacing_enabled || m_visible_group_count == 0
-        || index + 1 == m_items.size())
-        return 0;
-
-    return m_group_height / 6;
+    return get_layout().get_group_items_bottom_margin(index);
 }
 
 int ListView::get_leaf_group_header_bottom_margin(std::optional<size_t> index) const
@@ -70,46 +67,35 @@ int ListView::get_total_indentation() const
         + get_group_info_area_total_width();
 }
 
-ListView::GroupHeaderRenderInfo ListView::get_group_header_render_info(
-    size_t item_index, size_t group_index, std::optional<int> scroll_position) const
-{
-    assert(item_index < m_items.size());
-    assert(group_index < m_group_count);
-
-    const auto resolved_scroll_position = scroll_position.value_or(m_scroll_position);
-    auto [group_start, group_item_count] = get_item_group_range(item_index, group_index);
-
-    const auto display_group_count = get_item_display_group_count(group_start);
-    const auto display_group_index = get_item_display_group_count(group_start, group_index);
-    const auto is_leaf = display_group_index + 1 == display_group_count;
-    const auto is_hidden = m_items[item_index]->m_groups[group_index]->is_hidden();
-    const auto height = is_hidden ? 0 : m_group_height;
-
-    const auto min_group_top = get_item_position(group_start) - resolved_scroll_position
-        - m_group_height * gsl::narrow<int>(display_group_count - display_group_index)
-        - get_leaf_group_header_bottom_margin();
-
-    if (!are_group_headers_sticky_active())
-        return GroupHeaderRenderInfo{group_start, group_item_count, min_group_top, height, is_leaf, is_hidden, false};
-
-    auto [final_leaf_group_start, final_leaf_group_item_count]
-        = get_item_group_range(group_start + group_item_count - 1, m_group_count - 1);
-    const auto final_leaf_group_first_item_top = get_item_position(final_leaf_group_start) - resolved_scroll_position;
-    const auto group_bottom = final_leaf_group_first_item_top
-        + std::max(get_group_minimum_inner_height(), gsl::narrow<int>(final_leaf_group_item_count) * m_item_height);
-
-    const auto cumulative_display_group_index = get_item_cumulative_display_group_count(group_start, group_index);
-
-    const auto max_group_top = group_bottom
-        - m_group_height * gsl::narrow<int>(display_group_count - display_group_index)
-        - get_stuck_leaf_group_header_bottom_margin();
-
-    const auto render_pos = std::max(
-        min_group_top, std::min(gsl::narrow<int>(cumulative_display_group_index) * m_group_height, max_group_top));
-
-    const auto is_stuck = render_pos != min_group_top;
-
-    return GroupHeaderRenderInfo{group_start, group_item_count, render_pos, height, is_leaf, is_hidden, is_stuck};
+lv::LayoutMetrics ListView::get_layout_metrics() const
+{
+    const auto show_group_info_area = get_show_group_info_area() && m_visible_group_count > 0;
+
+    return lv::LayoutMetrics{
+        .item_height = m_item_height,
+        .group_height = m_group_height,
+        .visible_group_count = m_visible_group_count,
+        .sticky_group_headers = are_group_headers_sticky_active(),
+        .show_group_info_area = show_group_info_area,
+        .is_group_info_area_sticky = m_is_group_info_area_sticky,
+        .group_info_area_width = get_group_info_area_width(),
+        .group_info_area_height = get_group_info_area_height(),
+        .group_info_area_padding = get_group_info_area_padding(),
+        .group_minimum_inner_height = get_group_minimum_inner_height(),
+        .leaf_group_header_bottom_margin = get_leaf_group_header_bottom_margin(),
+        .stuck_leaf_group_header_bottom_margin = get_stuck_leaf_group_header_bottom_margin(),
+        .group_items_bottom_margin = show_group_info_area && m_is_group_info_area_header_spacing_enabled
+            ? m_group_height / 6
+            : 0,
+        .root_group_indentation_amount = m_root_group_indentation_amount,
+        .indentation_step = get_indentation_step(),
+        .total_indentation = get_total_indentation(),
+        .columns_display_width = get_columns_display_width(),
+        .horizontal_scroll_position = m_horizontal_scroll_position,
+        .insert_mark_index = m_insert_mark_index != pfc_infinite ? std::make_optional(m_insert_mark_index)
+                                                                 : std::nullopt,
+        .insert_mark_height = MulDiv(3, get_system_dpi_cached().cx, USER_DEFAULT_SCREEN_DPI * 2),
+    };
 }
 
 int ListView::get_stuck_group_headers_height(std::optional<int> scroll_position) const
@@ -117,43 +103,6 @@ int ListView::get_stuck_group_headers_height(std::optional<int> scroll_position)
     return get_stuck_group_headers_info(scroll_position).height;
 }
 
-ListView::StuckGroupHeadersInfo ListView::get_stuck_group_headers_info(std::optional<int> scroll_position) const
-{
-    if (!are_group_headers_sticky_active())
-        return {};
-
-    const auto resolved_scroll_position = scroll_position.value_or(m_scroll_position);
-
-    if (resolved_scroll_position == 0)
-        return {};
-
-    const auto vht_result = underlying_items_vertical_hit_test(resolved_scroll_position);
-
-    if (vht_result.position_category == VerticalPositionCategory::NoItems)
-        return {};
-
-    const auto item_index = vht_result.item_leftmost;
-    const auto render_info = get_group_header_render_info(item_index, m_group_count - 1, resolved_scroll_position);
-
-    if (!render_info.is_stuck)
-        return {};
-
-    const auto next_child_group_index = render_info.group_start + render_info.group_count;
-
-    if (next_child_group_index < m_items.size()) {
-        const auto next_render_info
-            = get_group_header_render_info(next_child_group_index, m_group_count - 1, resolved_scroll_position);
-
-        if (next_render_info.is_stuck)
-            return {next_render_info.items_viewport_y + next_render_info.height
-                    + get_stuck_leaf_group_header_bottom_margin(),
-                next_render_info.group_start};
-    }
-
-    return {render_info.items_viewport_y + render_info.height + get_stuck_leaf_group_header_bottom_margin(),
-        gsl::narrow<size_t>(render_info.group_start)};
-}
-
 void ListView::refresh_item_positions()
 {
     const auto position = save_scroll_position();
@@ -489,7 +438,7 @@ void ListView::invalidate_all(bool b_children, bool non_client)
 void ListView::update_items(size_t index, size_t count, bool invalidate)
 {
     for (size_t i{}; i < count; ++i)
-        m_items[i + index]->m_subitems.resize(0);
+        m_items[i + index]->set_subitems({});
 
     if (invalidate)
         invalidate_items(index, count);
@@ -610,50 +559,10 @@ void ListView::set_is_group_info_area_header_spacing_enabled(bool value)
 }
 
 RECT ListView::get_item_group_info_area_render_rect(
-    size_t index, const std::optional<RECT>& items_rect, std::optional<int> scroll_position)
+    size_t index, const std::optional<RECT>& items_rect, std::optional<int> scroll_position) const
 {
-    if (!get_show_group_info_area() || m_visible_group_count == 0) {
-        assert(false);
-        return {};
-    }
-
-    const auto resolved_items_rect = items_rect ? *items_rect : get_items_rect();
-    const auto resolved_scroll_position = scroll_position.value_or(m_scroll_position);
-
-    const auto leaf_group_header_render_info
-        = get_group_header_render_info(index, m_group_count - 1, resolved_scroll_position);
-
-    const auto artwork_indentation
-        = m_root_group_indentation_amount + get_indentation_step() * (gsl::narrow<int>(m_visible_group_count) - 1);
-    const auto group_info_area_padding = get_group_info_area_padding();
-
-    const auto [group_first_item, group_item_count] = get_item_group_range(index, m_group_count - 1);
-
-    const auto group_first_item_top = get_item_position(group_first_item) - resolved_scroll_position;
-    const auto group_leaf_header_bottom = m_is_group_info_area_sticky && leaf_group_header_render_info.is_stuck
-        ? leaf_group_header_render_info.items_viewport_y + leaf_group_header_render_info.height
-            + get_leaf_group_header_bottom_margin()
-        : group_first_item_top;
-    const auto group_bottom = group_first_item_top
-        + std::max(get_group_minimum_inner_height(), gsl::narrow<int>(group_item_count) * m_item_height);
-
-    const auto left = 0 - m_horizontal_scroll_position + artwork_indentation + group_info_area_padding.left;
-    const auto right = left + get_group_info_area_width();
-
-    int top = group_leaf_header_bottom + resolved_items_rect.top + group_info_area_padding.top;
-
-    if (top < resolved_items_rect.top && m_is_group_info_area_sticky) {
-        const auto sticky_pos = static_cast<int>(resolved_items_rect.top);
-        top = std::max(top, sticky_pos);
-    }
-
-    const auto items_bottom_minus_info_height = group_bottom - get_group_info_area_height()
-        + static_cast<int>(resolved_items_rect.top) - group_info_area_padding.bottom;
-    top = std::min(top, items_bottom_minus_info_height);
-
-    const auto bottom = top + get_group_info_area_height();
-
-    return {left, top, right, bottom};
+    return get_layout().get_item_group_info_area_render_rect(
+        index, items_rect ? *items_rect : get_items_rect(), scroll_position.value_or(m_scroll_position));
 }
 
 void ListView::invalidate_item_group_info_area(size_t index)
@@ -668,21 +577,7 @@ void ListView::invalidate_item_group_info_area(size_t index)
 
 std::tuple<size_t, size_t> ListView::get_item_group_range(size_t index, size_t level) const
 {
-    if (m_group_count == 0)
-        return {size_t{}, m_items.size()};
-
-    const auto& group = m_items[index]->m_groups[level];
-    size_t start{index};
-
-    while (start > 0 && m_items[start - 1]->m_groups[level] == group)
-        --start;
-
-    size_t end{index};
-
-    while (end + 1 < m_items.size() && m_items[end + 1]->m_groups[level] == group)
-        ++end;
-
-    return {start, end - start + 1};
+    return lv::get_group_range(LayoutItems(*this), index, level);
 }
 
 void ListView::set_highlight_item(size_t index)
@@ -799,9 +694,9 @@ void ListView::on_search_string_change(WCHAR new_char)
 
         if (strchr(item_text, 3)) {
             const auto cleaned_item_text = uih::text_style::remove_colour_and_font_codes(item_text);
-            mmh::to_utf16(cleaned_item_text, item_text_utf16);
+            utf8_to_utf16(cleaned_item_text, item_text_utf16);
         } else {
-            mmh::to_utf16(item_text, item_text_utf16);
+            utf8_to_utf16(item_text, item_text_utf16);
         }
 
         if ((b_all_same && mmh::search_starts_with({&new_char, 1}, item_text_utf16, false))
@@ -879,7 +774,7 @@ void ListView::set_font_from_log_font(const LOGFONT& log_font)
     std::optional<direct_write::TextFormat> text_format;
 
     if (m_direct_write_context) {
-        text_format = m_direct_write_context->create_text_format_with_fallback(log_font);
+        text_format = m_direct_write_context->get_shared_text_format_with_fallback(log_font);
     }
 
     set_font(text_format, log_font);
@@ -887,6 +782,13 @@ void ListView::set_font_from_log_font(const LOGFONT& log_font)
 
 void ListView::set_font(std::optional<direct_write::TextFormat> text_format, const LOGFONT& log_font)
 {
+    if (m_text_layout_prefetcher)
+        m_text_layout_prefetcher->cancel();
+
+    m_prefetched_scroll_range.reset();
+
+    clear_items_text_layout_cache_size();
+
     m_items_log_font = log_font;
     m_items_text_format = std::move(text_format);
     m_space_width.reset();
@@ -945,6 +847,13 @@ std::optional<float> ListView::get_items_font_size_pt() const
 
 void ListView::set_group_font(std::optional<direct_write::TextFormat> text_format)
 {
+    if (m_text_layout_prefetcher)
+        m_text_layout_prefetcher->cancel();
+
+    m_prefetched_scroll_range.reset();
+
+    clear_group_text_layout_cache_size();
+
     m_group_text_format = text_format;
 
     if (m_initialised) {
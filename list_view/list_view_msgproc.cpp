@@ -23,7 +23,7 @@ LRESULT ListView::on_message(HWND wnd, UINT msg, WPARAM wp, LPARAM lp)
     case WM_CREATE:
         m_buffered_paint_initialiser.emplace();
         m_smooth_scroll_helper.emplace(
-            wnd, MSG_SMOOTH_SCROLL, SMOOTH_SCROLL_TIMER_ID,
+            wnd, MSG_SMOOTH_SCROLL,
             [this](ScrollAxis axis) {
                 return axis == ScrollAxis::Vertical ? m_scroll_position : m_horizontal_scroll_position;
             },
@@ -65,15 +65,17 @@ LRESULT ListView::on_message(HWND wnd, UINT msg, WPARAM wp, LPARAM lp)
 
         if (m_direct_write_context) {
             if (!m_items_text_format && m_items_log_font)
-                m_items_text_format = m_direct_write_context->create_text_format_with_fallback(*m_items_log_font);
+                m_items_text_format = m_direct_write_context->get_shared_text_format_with_fallback(*m_items_log_font);
 
             if (!m_header_text_format && m_header_log_font)
-                m_header_text_format = m_direct_write_context->create_text_format_with_fallback(*m_header_log_font);
+                m_header_text_format = m_direct_write_context->get_shared_text_format_with_fallback(*m_header_log_font);
         }
 
         if (!m_group_text_format)
             m_group_text_format = m_items_text_format;
 
+        m_text_layout_prefetcher.emplace([wnd] { PostMessage(wnd, MSG_COMMIT_PREFETCHED_TEXT_LAYOUTS, 0, 0); });
+
         refresh_items_font();
         refresh_group_font();
 
@@ -99,6 +101,9 @@ LRESULT ListView::on_message(HWND wnd, UINT msg, WPARAM wp, LPARAM lp)
         m_dummy_theme_window.reset();
         m_items.clear();
         m_columns.clear();
+        m_text_layout_prefetcher.reset();
+        clear_items_text_layout_cache_size();
+        clear_group_text_layout_cache_size();
         m_items_text_format.reset();
         m_header_text_format.reset();
         m_group_text_format.reset();
@@ -663,9 +668,6 @@ LRESULT ListView::on_message(HWND wnd, UINT msg, WPARAM wp, LPARAM lp)
             }
             return 0;
         }
-        case SMOOTH_SCROLL_TIMER_ID:
-            m_smooth_scroll_helper->on_timer();
-            return 0;
         default:
             if (notify_on_timer(wp))
                 return 0;
@@ -675,6 +677,10 @@ LRESULT ListView::on_message(HWND wnd, UINT msg, WPARAM wp, LPARAM lp)
     case MSG_SMOOTH_SCROLL:
         m_smooth_scroll_helper->on_message();
         break;
+    case MSG_COMMIT_PREFETCHED_TEXT_LAYOUTS:
+        if (m_text_layout_prefetcher)
+            m_text_layout_prefetcher->commit();
+        return 0;
     case MSG_KILL_INLINE_EDIT:
         m_inline_edit_prevent_kill = true;
 
@@ -2,6 +2,7 @@
 
 #include "list_view.h"
 #include "../text_style.h"
+#include "../text_encoding.h"
 #include "../direct_write_text_out.h"
 
 using namespace std::string_view_literals;
@@ -43,12 +44,19 @@ int ListView::get_default_indentation_step() const
     return *m_space_width * _level_spacing_size;
 }
 
-int ListView::measure_text_width(size_t item_index, size_t column_index)
+text_style::FormatPropertiesHandle ListView::get_initial_format_handle(size_t item_index, size_t column_index)
 {
-    const char* text = get_item_text(item_index, column_index);
     const auto initial_format = get_initial_format(item_index, column_index);
-    return direct_write::measure_text_width_columns_and_styles(*m_items_text_format, mmh::to_utf16(text), 1_spx, 3_spx,
-        initial_format ? *initial_format : text_style::FormatProperties{});
+    return initial_format ? text_style::FormatPropertiesHandle(initial_format->get())
+                          : text_style::FormatPropertiesHandle{};
+}
+
+int ListView::measure_text_width(size_t item_index, size_t column_index)
+{
+    std::wstring buffer;
+    const auto text = get_item_text_utf16(item_index, column_index, buffer);
+    return direct_write::measure_text_width_columns_and_styles(
+        *m_items_text_format, text, 1_spx, 3_spx, get_initial_format_handle(item_index, column_index));
 }
 
 void ListView::render_items(HDC dc, const RECT& paint_rect)
@@ -63,9 +71,9 @@ void ListView::render_items(HDC dc, const RECT& paint_rect)
     }
 
     ColourData colours = render_get_colour_data();
-    lv::RendererContext context
-        = {colours, m_use_dark_mode, m_is_high_contrast_active, get_wnd(), dc, m_list_view_theme.get(),
-            m_items_view_theme.get(), m_items_text_format, m_group_text_format, m_bitmap_render_target};
+    lv::RendererContext context = {colours, m_use_dark_mode, m_is_high_contrast_active, get_wnd(), dc,
+        m_list_view_theme.get(), m_items_view_theme.get(), m_items_text_format, m_group_text_format,
+        m_bitmap_render_target, direct_write::get_window_monitor(get_wnd())};
 
     size_t highlight_index = get_highlight_item();
     size_t index_focus = get_focus_item();
@@ -75,6 +83,15 @@ void ListView::render_items(HDC dc, const RECT& paint_rect)
     bool b_window_focused = (wnd_focus == get_wnd()) || IsChild(get_wnd(), wnd_focus);
     const auto rc_items = get_items_rect();
 
+    update_text_layout_cache_sizes(rc_items);
+
+    if (m_items_text_format)
+        m_items_text_format->begin_text_layout_cache_frame();
+
+    if (m_group_text_format
+        && !(m_items_text_format && m_group_text_format->shares_caches_with(*m_items_text_format)))
+        m_group_text_format->begin_text_layout_cache_frame();
+
     m_renderer->render_begin(context);
 
     RECT items_paint_rect{};
@@ -91,164 +108,224 @@ void ListView::render_items(HDC dc, const RECT& paint_rect)
 
     m_renderer->render_background(context, &items_paint_rect);
 
-    if (items_paint_rect.bottom <= items_paint_rect.top || items_paint_rect.bottom < rc_items.top)
-        return;
+    const auto display_list = build_display_list(rc_items, items_paint_rect);
 
-    size_t i;
-    size_t count = m_items.size();
-    const auto indentation_step = m_visible_group_count > 0 ? get_indentation_step() : 0;
-    const auto item_indentation = get_total_indentation();
-    const auto cx = get_columns_display_width() + item_indentation;
+    for (auto&& entry : display_list.entries) {
+        if (entry.exclude_stuck_headers)
+            ExcludeClipRect(dc, display_list.items_rect.left, display_list.items_rect.top,
+                display_list.items_rect.right, display_list.items_rect.top + display_list.stuck_headers_height);
 
-    bool b_show_group_info_area = get_show_group_info_area() && m_visible_group_count > 0;
+        if (!RectVisible(dc, &entry.rect))
+            continue;
 
-    i = gsl::narrow<size_t>(get_item_at_or_before(
-        (items_paint_rect.top > rc_items.top ? items_paint_rect.top - rc_items.top : 0) + m_scroll_position));
+        switch (entry.type) {
+        case lv::DisplayListEntryType::GroupHeader: {
+            const auto& group = m_items[entry.item_index]->m_groups[entry.group_index];
 
-    size_t i_start = i;
-    size_t i_end = gsl::narrow<size_t>(get_item_at_or_after(
-        (items_paint_rect.bottom > rc_items.top + 1 ? items_paint_rect.bottom - rc_items.top - 1 : 0)
-        + m_scroll_position));
+            m_renderer->render_group(
+                context, entry.item_index, entry.group_index, group->m_text.get_ptr(), entry.indentation, entry.rect);
 
-    const auto stuck_headers_height = items_paint_rect.top > rc_items.top ? get_stuck_group_headers_height() : 0;
-    bool has_excluded_stuck_headers{};
+            if (entry.exclude_rect_after)
+                ExcludeClipRect(dc, entry.exclude_rect_after->left, entry.exclude_rect_after->top,
+                    entry.exclude_rect_after->right, entry.exclude_rect_after->bottom);
+            break;
+        }
+        case lv::DisplayListEntryType::GroupInfo:
+            m_renderer->render_group_info(context, entry.item_index, entry.rect);
+            break;
+        case lv::DisplayListEntryType::Item: {
+            const auto i = entry.item_index;
+            const auto is_selected = get_item_selected(i) || i == m_highlight_selected_item_index;
+            const auto show_item_focus = index_focus == i && (b_window_focused || m_always_show_focus);
 
-    auto exclude_sticky_headers_from_clip_region = [&](const RECT& render_area) {
-        if (!has_excluded_stuck_headers && stuck_headers_height > 0
-            && render_area.bottom > rc_items.top + stuck_headers_height) {
-            has_excluded_stuck_headers = true;
-            ExcludeClipRect(dc, rc_items.left, rc_items.top, rc_items.right, rc_items.top + stuck_headers_height);
+            m_renderer->render_item(context, i, get_renderer_sub_items(i), 0 /*item_indentation*/, is_selected,
+                b_window_focused, (m_highlight_item_index == i) || (highlight_index == i), should_hide_focus,
+                show_item_focus, entry.rect);
+            break;
         }
-    };
+        case lv::DisplayListEntryType::InsertMark:
+            SetDCBrushColor(dc, colours.m_text);
+            PatBlt(dc, entry.rect.left, entry.rect.top, wil::rect_width(entry.rect), wil::rect_height(entry.rect),
+                PATCOPY);
+            break;
+        }
+    }
 
-    for (; i <= i_end && i < count; i++) {
-        const auto is_first_item = i == i_start;
-        const size_t group_count = m_items[i]->m_groups.size();
-        [[maybe_unused]] size_t display_group_index{};
-        size_t indentation_level{};
+    /*if (m_search_editbox)
+    {
+        RECT rc_search;
+        get_search_box_rect(&rc_search);
+        rc_search.right = rc_search.left;
+        rc_search.left = 0;
+        if (rc_update.bottom >= rc_search.top)
+        {
+            FillRect(dc, &rc_search, GetSysColorBrush(COLOR_BTNFACE));
+            //render_background(dc, &rc_search);
+            uih::text_out_colours_tab(dc, m_search_label.get_ptr(), m_search_label.get_length(), 0, 2, &rc_search,
+    false, GetSysColor(COLOR_WINDOWTEXT), false, false, false, uih::ALIGN_LEFT, NULL);
+        }
+    }*/
+}
 
-        for (size_t group_index = 0; group_index < group_count; group_index++) {
-            const auto group = m_items[i]->m_groups[group_index];
+void ListView::update_text_layout_cache_sizes(const RECT& items_rect)
+{
+    if (m_item_height <= 0)
+        return;
 
-            auto _scope_exit = wil::scope_exit([&] {
-                if (!group->is_hidden())
-                    ++indentation_level;
-            });
+    // Allow for partially visible rows at the top and bottom
+    const auto visible_row_count = gsl::narrow<size_t>(std::max(0, wil::rect_height(items_rect) / m_item_height + 2));
 
-            if (i > 0 && group == m_items[i - 1]->m_groups[group_index]) {
-                // Should be impossible for groups to be the same if one was already rendered.
-                assert(are_group_headers_sticky_active() || display_group_index == 0);
+    // Items and groups are separate users of the text layout cache, so that
+    // their counts are added together if they use the same text format
+    if (m_items_text_format)
+        m_items_text_format->set_expected_visible_cell_count(
+            &m_items_text_format, visible_row_count * std::max(m_columns.size(), size_t{1}));
 
-                if (!(are_group_headers_sticky_active() && is_first_item))
-                    continue;
-            }
+    if (m_group_text_format)
+        m_group_text_format->set_expected_visible_cell_count(&m_group_text_format, visible_row_count);
+}
 
-            if (group->is_hidden())
-                continue;
+void ListView::clear_items_text_layout_cache_size() const
+{
+    if (m_items_text_format)
+        m_items_text_format->set_expected_visible_cell_count(&m_items_text_format, 0);
+}
 
-            const auto header_info = get_group_header_render_info(i, group_index);
+void ListView::clear_group_text_layout_cache_size() const
+{
+    if (m_group_text_format)
+        m_group_text_format->set_expected_visible_cell_count(&m_group_text_format, 0);
+}
 
-            const auto y = header_info.items_viewport_y + rc_items.top;
-            const int x = -m_horizontal_scroll_position + rc_items.left;
+std::vector<lv::RendererSubItem> ListView::get_renderer_sub_items(size_t index)
+{
+    std::vector<lv::RendererSubItem> sub_items;
 
-            const RECT rc = {x, y, x + cx, y + m_group_height};
+    for (size_t column_index{}; column_index < m_columns.size(); ++column_index) {
+        const auto text = get_item_text(index, column_index);
+        auto& column = m_columns[column_index];
 
-            if (rc.top >= items_paint_rect.bottom)
-                break;
+        std::optional<std::wstring_view> utf16_text;
 
-            const auto indentation
-                = m_root_group_indentation_amount + indentation_step * gsl::narrow<int>(indentation_level);
+        if (m_cache_item_text_utf16) {
+            // The buffer isn't used when UTF-16 item text is being cached
+            std::wstring buffer;
+            utf16_text = get_item_text_utf16(index, column_index, buffer);
+        }
 
-            if (RectVisible(dc, &rc)) {
-                m_renderer->render_group(
-                    context, header_info.group_start, group_index, group->m_text.get_ptr(), indentation, rc);
+        sub_items.emplace_back(lv::RendererSubItem{text, column.m_display_size, column.m_alignment, utf16_text});
+    }
 
-                if (header_info.is_stuck)
-                    ExcludeClipRect(dc, rc.left, rc.top, rc.right,
-                        rc.bottom + (header_info.is_display_leaf ? get_stuck_leaf_group_header_bottom_margin() : 0));
-            }
+    return sub_items;
+}
 
-            ++display_group_index;
-        }
+void ListView::prefetch_text_layouts()
+{
+    if (!m_text_layout_prefetcher || !m_items_text_format)
+        return;
 
-        if (b_show_group_info_area) {
-            const auto [item_group_start, _] = get_item_group_range(i, m_group_count ? m_group_count - 1 : 0);
+    const auto rc_items = get_items_rect();
+    const auto viewport_height = wil::rect_height(rc_items);
 
-            if (is_first_item || i == item_group_start) {
-                RECT rc_group_info = get_item_group_info_area_render_rect(item_group_start, rc_items);
+    if (viewport_height <= 0)
+        return;
 
-                if (rc_group_info.top < items_paint_rect.bottom) {
-                    exclude_sticky_headers_from_clip_region(rc_group_info);
+    const auto target_position = clamp_scroll_position(
+        get_wnd(), ScrollAxis::Vertical, m_smooth_scroll_helper->current_target(ScrollAxis::Vertical));
 
-                    if (RectVisible(dc, &rc_group_info))
-                        m_renderer->render_group_info(context, item_group_start, rc_group_info);
-                }
-            }
-        }
+    if (target_position == m_scroll_position) {
+        m_prefetched_scroll_range.reset();
+        return;
+    }
 
-        RECT rc_item = {0 - m_horizontal_scroll_position + item_indentation,
-            get_item_position(i) - m_scroll_position + rc_items.top, cx - m_horizontal_scroll_position,
-            get_item_position(i) + get_item_height(i) - m_scroll_position + rc_items.top};
+    // Over long distances, intermediate items are only on screen briefly (if at all),
+    // so only prefetch the items that will be visible at the target position
+    const auto include_intermediate_items = std::abs(target_position - m_scroll_position) <= viewport_height * 2;
+    const auto start_position
+        = include_intermediate_items ? std::min(m_scroll_position, target_position) : target_position;
+    const auto end_position
+        = include_intermediate_items ? std::max(m_scroll_position, target_position) : target_position;
+
+    // Nothing new will come into view if the target hasn't moved past what has already been requested
+    // (e.g. for each mouse wheel notch while scrolling back)
+    if (m_prefetched_scroll_range && start_position >= m_prefetched_scroll_range->first
+        && end_position + viewport_height <= m_prefetched_scroll_range->second)
+        return;
 
-        if (rc_item.top >= items_paint_rect.bottom)
-            break;
+    m_prefetched_scroll_range = {start_position, end_position + viewport_height};
 
-        exclude_sticky_headers_from_clip_region(rc_item);
+    const RECT prefetch_rect{
+        rc_items.left, rc_items.top, rc_items.right, rc_items.top + end_position - start_position + viewport_height};
+    auto display_list = build_display_list(rc_items, prefetch_rect, start_position);
 
-        if (RectVisible(dc, &rc_item)) {
-            const auto is_selected = get_item_selected(i) || i == m_highlight_selected_item_index;
-            const auto show_item_focus = index_focus == i && (b_window_focused || m_always_show_focus);
+    // Start with whatever will be scrolled into view first
+    if (target_position < m_scroll_position)
+        std::ranges::reverse(display_list.entries);
 
-            std::vector<lv::RendererSubItem> sub_items;
+    // The layouts of visible cells are still in use, so only prefetch as many
+    // layouts as will fit in the caches alongside them (estimating the visible
+    // cells as in update_text_layout_cache_sizes())
+    const auto visible_row_count = gsl::narrow<size_t>(viewport_height / std::max(m_item_height, 1) + 2);
 
-            for (size_t column_index{}; column_index < m_columns.size(); ++column_index) {
-                const auto text = get_item_text(i, column_index);
-                auto& column = m_columns[column_index];
+    const auto get_max_request_count = [](const std::optional<direct_write::TextFormat>& text_format,
+                                           size_t visible_count) -> size_t {
+        if (!text_format)
+            return 0;
 
-                sub_items.emplace_back(lv::RendererSubItem{text, column.m_display_size, column.m_alignment});
-            }
+        const auto capacity = text_format->get_text_layout_cache_capacity();
+        return capacity > visible_count ? capacity - visible_count : 0;
+    };
 
-            m_renderer->render_item(context, i, sub_items, 0 /*item_indentation*/, is_selected, b_window_focused,
-                (m_highlight_item_index == i) || (highlight_index == i), should_hide_focus, show_item_focus, rc_item);
-        }
-    }
+    auto remaining_item_request_count = get_max_request_count(
+        m_items_text_format, visible_row_count * std::max(m_columns.size(), size_t{1}));
+    auto remaining_group_request_count = get_max_request_count(m_group_text_format, visible_row_count);
 
-    /*if (m_search_editbox)
-    {
-        RECT rc_search;
-        get_search_box_rect(&rc_search);
-        rc_search.right = rc_search.left;
-        rc_search.left = 0;
-        if (rc_update.bottom >= rc_search.top)
-        {
-            FillRect(dc, &rc_search, GetSysColorBrush(COLOR_BTNFACE));
-            //render_background(dc, &rc_search);
-            uih::text_out_colours_tab(dc, m_search_label.get_ptr(), m_search_label.get_length(), 0, 2, &rc_search,
-    false, GetSysColor(COLOR_WINDOWTEXT), false, false, false, uih::ALIGN_LEFT, NULL);
-        }
-    }*/
+    ColourData colours = render_get_colour_data();
+    lv::RendererContext context
+        = {colours, m_use_dark_mode, m_is_high_contrast_active, get_wnd(), nullptr, m_list_view_theme.get(),
+            m_items_view_theme.get(), m_items_text_format, m_group_text_format, m_bitmap_render_target};
 
-    if (m_insert_mark_index != pfc_infinite && (m_insert_mark_index <= count)) {
-        RECT rc_line{};
-        rc_line.left = item_indentation - m_horizontal_scroll_position;
-        rc_line.right = cx - m_horizontal_scroll_position;
-        int y_pos = 0;
-        if (count) {
-            if (m_insert_mark_index == count)
-                y_pos
-                    = get_item_position(count - 1) + get_item_height(count - 1) - m_scroll_position + rc_items.top - 1;
-            else
-                y_pos = get_item_position(m_insert_mark_index) - m_scroll_position + rc_items.top - 1;
+    std::vector<direct_write::TextLayoutPrefetchRequest> requests;
+
+    for (auto&& entry : display_list.entries) {
+        if (remaining_item_request_count == 0 && remaining_group_request_count == 0)
+            break;
+
+        const auto top = entry.rect.top - rc_items.top + start_position;
+        const auto bottom = entry.rect.bottom - rc_items.top + start_position;
+
+        // Layouts for anything currently visible should already be cached
+        if (bottom > m_scroll_position && top < m_scroll_position + viewport_height)
+            continue;
+
+        std::vector<direct_write::TextLayoutPrefetchRequest> entry_requests;
+        size_t* remaining_request_count{};
+
+        if (entry.type == lv::DisplayListEntryType::GroupHeader && remaining_group_request_count > 0) {
+            const auto& group = m_items[entry.item_index]->m_groups[entry.group_index];
+            entry_requests = m_renderer->get_group_prefetch_requests(
+                context, entry.item_index, entry.group_index, group->m_text.get_ptr(), entry.indentation, entry.rect);
+            remaining_request_count = &remaining_group_request_count;
+        } else if (entry.type == lv::DisplayListEntryType::Item && remaining_item_request_count > 0) {
+            entry_requests = m_renderer->get_item_prefetch_requests(
+                context, entry.item_index, get_renderer_sub_items(entry.item_index), 0, entry.rect);
+            remaining_request_count = &remaining_item_request_count;
         }
-        const auto line_height = MulDiv(3, get_system_dpi_cached().cx, USER_DEFAULT_SCREEN_DPI * 2);
-        rc_line.top = y_pos;
-        rc_line.bottom = y_pos + line_height;
 
-        if (RectVisible(dc, &rc_line)) {
-            SetDCBrushColor(dc, colours.m_text);
-            PatBlt(dc, rc_line.left, rc_line.top, wil::rect_width(rc_line), wil::rect_height(rc_line), PATCOPY);
+        if (!remaining_request_count)
+            continue;
+
+        if (entry_requests.size() > *remaining_request_count) {
+            *remaining_request_count = 0;
+            continue;
         }
+
+        *remaining_request_count -= entry_requests.size();
+        std::ranges::move(entry_requests, std::back_inserter(requests));
     }
+
+    if (!requests.empty())
+        m_text_layout_prefetcher->prefetch(std::move(requests));
 }
 
 void ListView::render_get_colour_data(ColourData& p_out)
@@ -318,7 +395,10 @@ void lv::DefaultRenderer::render_group(const RendererContext& context, size_t it
     const auto border = 3_spx;
     const auto text_width
         = direct_write::text_out_columns_and_styles(*context.group_text_format, context.wnd, context.dc, text, x_offset,
-            border, rc, cr, {.bitmap_render_target = context.bitmap_render_target, .enable_tab_columns = false});
+            border, rc, cr,
+            {.bitmap_render_target = context.bitmap_render_target,
+                .monitor = context.monitor,
+                .enable_tab_columns = false});
 
     const auto line_height = 1_spx;
     const auto line_top = rc.top + wil::rect_height(rc) / 2 - line_height / 2;
@@ -380,26 +460,86 @@ void lv::DefaultRenderer::render_item(const RendererContext& context, size_t ind
 
     RECT rc_subitem = rc;
 
+    // Render the text of all columns in one pass, rather than copying the
+    // background to and from the bitmap render target for each column
+    std::optional<direct_write::TextRenderBatch> text_render_batch;
+
+    if (context.item_text_format && context.bitmap_render_target)
+        text_render_batch.emplace(context.wnd, context.dc, rc, context.bitmap_render_target, context.monitor);
+
     for (size_t column_index{0}; column_index < sub_items.size(); ++column_index) {
         auto& sub_item = sub_items[column_index];
         rc_subitem.right = rc_subitem.left + sub_item.width;
 
-        if (context.item_text_format && context.bitmap_render_target)
-            direct_write::text_out_columns_and_styles(*context.item_text_format, context.wnd, context.dc, sub_item.text,
-                1_spx + (column_index == 0 ? indentation : 0), 3_spx, rc_subitem, cr_text,
-                {.bitmap_render_target = context.bitmap_render_target,
-                    .is_selected = b_selected,
-                    .align = sub_item.alignment,
-                    .enable_tab_columns = m_enable_item_tab_columns});
+        if (text_render_batch) {
+            const direct_write::TextOutOptions options{.bitmap_render_target = context.bitmap_render_target,
+                .render_batch = &*text_render_batch,
+                .is_selected = b_selected,
+                .align = sub_item.alignment,
+                .enable_tab_columns = m_enable_item_tab_columns};
+            const auto x_offset = 1_spx + (column_index == 0 ? indentation : 0);
+
+            if (sub_item.utf16_text)
+                direct_write::text_out_columns_and_styles(*context.item_text_format, context.wnd, context.dc,
+                    *sub_item.utf16_text, x_offset, 3_spx, rc_subitem, cr_text, options);
+            else
+                direct_write::text_out_columns_and_styles(*context.item_text_format, context.wnd, context.dc,
+                    sub_item.text, x_offset, 3_spx, rc_subitem, cr_text, options);
+        }
 
         rc_subitem.left = rc_subitem.right;
     }
 
+    if (text_render_batch)
+        text_render_batch->end();
+
     if (b_focused) {
         render_focus_rect(context, should_hide_focus, rc);
     }
 }
 
+std::vector<direct_write::TextLayoutPrefetchRequest> lv::DefaultRenderer::get_group_prefetch_requests(
+    const RendererContext& context, size_t item_index, size_t group_index, std::string_view text, int indentation,
+    RECT rc)
+{
+    if (!context.group_text_format)
+        return {};
+
+    return {direct_write::TextLayoutPrefetchRequest{.text_format = &*context.group_text_format,
+        .text = utf8_to_utf16(text),
+        .x_offset = 1_spx + indentation,
+        .border = 3_spx,
+        .rect = rc,
+        .options = {.enable_tab_columns = false}}};
+}
+
+std::vector<direct_write::TextLayoutPrefetchRequest> lv::DefaultRenderer::get_item_prefetch_requests(
+    const RendererContext& context, size_t index, const std::vector<RendererSubItem>& sub_items, int indentation,
+    RECT rc)
+{
+    if (!context.item_text_format)
+        return {};
+
+    std::vector<direct_write::TextLayoutPrefetchRequest> requests;
+    RECT rc_subitem = rc;
+
+    for (size_t column_index{0}; column_index < sub_items.size(); ++column_index) {
+        auto& sub_item = sub_items[column_index];
+        rc_subitem.right = rc_subitem.left + sub_item.width;
+
+        requests.emplace_back(direct_write::TextLayoutPrefetchRequest{.text_format = &*context.item_text_format,
+            .text = sub_item.utf16_text ? std::wstring(*sub_item.utf16_text) : utf8_to_utf16(sub_item.text),
+            .x_offset = 1_spx + (column_index == 0 ? indentation : 0),
+            .border = 3_spx,
+            .rect = rc_subitem,
+            .options = {.align = sub_item.alignment, .enable_tab_columns = m_enable_item_tab_columns}});
+
+        rc_subitem.left = rc_subitem.right;
+    }
+
+    return requests;
+}
+
 void lv::DefaultRenderer::render_focus_rect(const RendererContext& context, bool should_hide_focus, RECT rc) const
 {
     const auto use_themed_rect = context.colours.m_themed && !context.colours.m_use_custom_active_item_frame
@@ -464,15 +604,15 @@ bool ListView::is_item_clipped(size_t item_index, size_t column_index)
     if (!m_items_text_format)
         return false;
 
-    const auto text = get_item_text(item_index, column_index);
-    const auto initial_format = get_initial_format(item_index, column_index);
+    std::wstring buffer;
+    const auto text = get_item_text_utf16(item_index, column_index, buffer);
     const auto& column = m_columns[column_index];
 
-    return direct_write::is_text_trimmed_columns_and_styles(*m_items_text_format, mmh::to_utf16(text), 1_spx, 3_spx,
+    return direct_write::is_text_trimmed_columns_and_styles(*m_items_text_format, text, 1_spx, 3_spx,
         column.m_display_size, m_item_height,
         {.align = column.m_alignment,
             .enable_tab_columns = m_renderer->are_tab_columns_enabled(),
-            .initial_format = initial_format ? *initial_format : text_style::FormatProperties{}});
+            .initial_format = get_initial_format_handle(item_index, column_index)});
 }
 
 } // namespace uih
@@ -1,5 +1,7 @@
 #pragma once
 #include "../direct_write.h"
+#include "../direct_write_text_out.h"
+#include "list_view_display_list.h"
 
 namespace uih::lv {
 
@@ -21,6 +23,8 @@ struct RendererSubItem {
     std::string_view text;
     int width{};
     alignment alignment{};
+    /** The text converted to UTF-16, if available */
+    std::optional<std::wstring_view> utf16_text;
 };
 
 struct RendererContext {
@@ -34,6 +38,8 @@ struct RendererContext {
     std::optional<direct_write::TextFormat>& item_text_format;
     std::optional<direct_write::TextFormat>& group_text_format;
     wil::com_ptr<IDWriteBitmapRenderTarget> bitmap_render_target;
+    /** The monitor used for text rendering parameters, determined once per paint */
+    HMONITOR monitor{};
 };
 
 class RendererBase {
@@ -53,6 +59,32 @@ public:
         int indentation, bool b_selected, bool b_window_focused, bool b_highlight, bool should_hide_focus,
         bool b_focused, RECT rc) = 0;
 
+    /**
+     * \brief Gets the text that render_group() will render for a group header.
+     *
+     * Used to create text layouts in advance while smooth scrolling. Renderers
+     * that don't use text_out_columns_and_styles() don't need to implement this.
+     */
+    virtual std::vector<direct_write::TextLayoutPrefetchRequest> get_group_prefetch_requests(
+        const RendererContext& context, size_t item_index, size_t group_index, std::string_view text, int indentation,
+        RECT rc)
+    {
+        return {};
+    }
+
+    /**
+     * \brief Gets the text that render_item() will render for an item.
+     *
+     * Used to create text layouts in advance while smooth scrolling. Renderers
+     * that don't use text_out_columns_and_styles() don't need to implement this.
+     */
+    virtual std::vector<direct_write::TextLayoutPrefetchRequest> get_item_prefetch_requests(
+        const RendererContext& context, size_t index, const std::vector<RendererSubItem>& sub_items, int indentation,
+        RECT rc)
+    {
+        return {};
+    }
+
     virtual ~RendererBase() = default;
 };
 
@@ -71,6 +103,12 @@ public:
         int indentation, bool b_selected, bool b_window_focused, bool b_highlight, bool should_hide_focus,
         bool b_focused, RECT rc) override;
 
+    std::vector<direct_write::TextLayoutPrefetchRequest> get_group_prefetch_requests(const RendererContext& context,
+        size_t item_index, size_t group_index, std::string_view text, int indentation, RECT rc) override;
+
+    std::vector<direct_write::TextLayoutPrefetchRequest> get_item_prefetch_requests(const RendererContext& context,
+        size_t index, const std::vector<RendererSubItem>& sub_items, int indentation, RECT rc) override;
+
 protected:
     void render_group_line(const RendererContext& context, const RECT* rc);
 
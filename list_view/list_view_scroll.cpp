@@ -99,6 +99,9 @@ void ListView::absolute_scroll(
 
     if (m_use_smooth_scroll && !computed_suppress_smooth_scroll) {
         m_smooth_scroll_helper->absolute_scroll(axis, new_position, duration);
+
+        if (axis == ScrollAxis::Vertical)
+            prefetch_text_layouts();
         return;
     }
 
@@ -114,6 +117,9 @@ void ListView::delta_scroll(int delta, ScrollAxis axis, bool suppress_smooth_scr
 
     if (m_use_smooth_scroll && !computed_suppress_smooth_scroll) {
         m_smooth_scroll_helper->delta_scroll(axis, delta);
+
+        if (axis == ScrollAxis::Vertical)
+            prefetch_text_layouts();
         return;
     }
 
@@ -0,0 +1,66 @@
+#pragma once
+
+namespace uih::lv {
+
+/**
+ * The text of the sub-items of a list view item, with UTF-16 copies that are
+ * created when first requested.
+ *
+ * The UTF-16 copies are discarded whenever the text may have changed (that is,
+ * when it's set, or when it's retrieved for updating).
+ */
+template <class String>
+class SubItems {
+public:
+    using Strings = std::vector<String>;
+
+    const Strings& get() const { return m_text; }
+
+    /**
+     * Get the text for updating it.
+     *
+     * This discards the UTF-16 copies, so the returned reference should only be
+     * used to update the text immediately.
+     */
+    Strings& get_for_update()
+    {
+        m_utf16_text.clear();
+        return m_text;
+    }
+
+    void set(Strings text)
+    {
+        m_text = std::move(text);
+        m_utf16_text.clear();
+    }
+
+    /**
+     * Get a UTF-16 copy of a sub-item, creating it using to_utf16 if needed.
+     *
+     * The column must be less than the number of sub-items.
+     */
+    template <class ToUtf16>
+    std::wstring_view get_utf16(size_t column, ToUtf16&& to_utf16)
+    {
+        if (m_utf16_text.size() != m_text.size()) {
+            m_utf16_text.clear();
+            m_utf16_text.resize(m_text.size());
+        }
+
+        auto& utf16_text = m_utf16_text[column];
+
+        if (!utf16_text)
+            utf16_text = to_utf16(m_text[column]);
+
+        return *utf16_text;
+    }
+
+    /** Discard the UTF-16 copies, freeing their memory */
+    void clear_utf16() { m_utf16_text = {}; }
+
+private:
+    Strings m_text;
+    std::vector<std::optional<std::wstring>> m_utf16_text;
+};
+
+} // namespace uih::lv
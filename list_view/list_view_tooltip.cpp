@@ -2,6 +2,7 @@
 
 #include "list_view.h"
 #include "../direct_write_text_out.h"
+#include "../text_encoding.h"
 #include "../text_style.h"
 
 using namespace std::string_view_literals;
@@ -243,7 +244,7 @@ void ListView::handle_mousemove_for_tooltip(POINT pt)
     }
 
     const auto cleaned_text = clean_tooltip_text(get_item_text(hit_result.index, hit_result.column));
-    m_tooltip_text = mmh::to_utf16(cleaned_text);
+    m_tooltip_text = utf8_to_utf16(cleaned_text);
 
     m_tooltip_alignment = m_columns[hit_result.column].m_alignment;
 
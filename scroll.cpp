@@ -139,10 +139,10 @@ void SmoothScrollHelper::absolute_scroll(ScrollAxis axis, int target_position, D
     const auto now = std::chrono::steady_clock::now();
     update_state(axis, target_position - current_position, false, duration, now);
 
-    const auto has_exiting_timer = m_timer_thread.has_value();
-    start_timer_thread();
+    const auto was_animating = m_is_animating;
+    start_animating();
 
-    if (!has_exiting_timer)
+    if (!was_animating)
         on_message();
 }
 
@@ -151,26 +151,25 @@ void SmoothScrollHelper::delta_scroll(ScrollAxis axis, int delta, Duration durat
     const auto now = std::chrono::steady_clock::now();
     update_state(axis, delta, true, duration, now);
 
-    const auto has_exiting_timer = m_timer_thread.has_value();
-    start_timer_thread();
+    const auto was_animating = m_is_animating;
+    start_animating();
 
-    if (!has_exiting_timer)
+    if (!was_animating)
         on_message();
 }
 
 void SmoothScrollHelper::abandon_animation(ScrollAxis axis, bool update_scroll_position)
 {
-    auto& state = axis_state(axis);
+    auto& animation = axis_state(axis).animation;
 
-    if (!state.scroll_state)
+    if (!animation.is_active())
         return;
 
-    pause_timer_thread();
-
     if (update_scroll_position)
-        m_handle_scroll(axis, state.scroll_state->start_position + state.scroll_state->target_delta);
+        m_handle_scroll(axis, animation.target_position());
 
-    state.scroll_state.reset();
+    animation.reset();
+    stop_animating_if_idle();
 }
 
 bool SmoothScrollHelper::should_smooth_scroll_mouse_wheel(ScrollAxis axis, int wheel_delta)
@@ -195,198 +194,195 @@ bool SmoothScrollHelper::should_smooth_scroll_mouse_wheel(ScrollAxis axis, int w
 
 void SmoothScrollHelper::scroll(ScrollAxis axis)
 {
-    auto& state = axis_state(axis);
-    auto& scroll_state = *state.scroll_state;
-
-    const auto now = std::chrono::steady_clock::now();
-    const auto normalised_time = (now - scroll_state.start_time) / scroll_state.duration;
-
-    const auto scroll_distance = scroll_state.target_delta;
-    const auto progress = scroll_state.easing_function == EasingFunction::Linear
-        ? normalised_time
-        : 1. - std::pow(1. - normalised_time, 3);
-
-    const auto scroll_amount = static_cast<int>(std::round(scroll_distance * progress));
-
-    const auto new_scroll_position = scroll_state.start_position + scroll_amount;
-    const auto bounded_new_scroll_position
-        = std::clamp(new_scroll_position, scroll_state.start_position + std::min(scroll_state.target_delta, 0),
-            scroll_state.start_position + std::max(scroll_state.target_delta, 0));
-    m_handle_scroll(axis, bounded_new_scroll_position);
+    auto& animation = axis_state(axis).animation;
 
-    const auto updated_position = m_current_position(axis);
+    animation.advance(std::chrono::steady_clock::now(), [this, axis](int position) {
+        m_handle_scroll(axis, position);
+        return m_current_position(axis);
+    });
 
-    if (updated_position != new_scroll_position
-        || updated_position == scroll_state.start_position + scroll_state.target_delta) {
-        pause_timer_thread();
-        state.scroll_state.reset();
-    }
+    if (!animation.is_active())
+        stop_animating_if_idle();
 }
 
-void SmoothScrollHelper::update_state(ScrollAxis axis, int delta, bool accumulate, Duration duration,
-    std::chrono::time_point<std::chrono::steady_clock> now)
+void SmoothScrollHelper::update_state(
+    ScrollAxis axis, int delta, bool accumulate, Duration duration, ScrollAnimation::TimePoint now)
 {
-    auto& state = axis_state(axis);
-    auto& scroll_state = state.scroll_state;
-    auto current_position = m_current_position(axis);
+    axis_state(axis).animation.scroll_by(m_current_position(axis), delta, accumulate, duration, now,
+        [this, axis](int position) { return m_clamp_position(axis, position); });
+}
 
-    if (!scroll_state || !accumulate) {
-        const auto clamped_delta = m_clamp_position(axis, current_position + delta) - current_position;
-        scroll_state.emplace(now - 8ms, current_position, clamped_delta, clamped_delta, duration);
+AnimationClock::~AnimationClock()
+{
+    if (!m_thread)
         return;
-    }
 
-    if (scroll_state->easing_function == EasingFunction::Linear && delta == scroll_state->last_delta) {
-        scroll_state->target_delta += delta;
-        scroll_state->duration = now - scroll_state->start_time + duration / 2.;
-    } else {
-        scroll_state->target_delta += scroll_state->start_position - current_position + delta;
-        scroll_state->last_delta = delta;
-        scroll_state->start_position = current_position;
-        scroll_state->duration = duration / 2.;
-        scroll_state->start_time = now;
-        scroll_state->easing_function = EasingFunction::Linear;
-    }
+    m_thread->request_stop();
+    m_stop_event.SetEvent();
+    m_thread.reset();
 }
 
-void SmoothScrollHelper::start_timer_thread()
+void AnimationClock::add_animation(const void* animation, HWND wnd, uint32_t message_id)
 {
-    m_timer_active.store(true, std::memory_order_release);
-    stop_thread_shutdown_timer();
+    {
+        std::scoped_lock lock(m_mutex);
 
-    if (m_timer_thread)
-        return;
+        if (const auto iter = std::ranges::find(m_animations, animation, &Animation::id); iter != m_animations.end())
+            *iter = {animation, wnd, message_id};
+        else
+            m_animations.emplace_back(animation, wnd, message_id);
+    }
 
-    if (m_shutdown_event)
-        m_shutdown_event.ResetEvent();
-    else
-        m_shutdown_event.create();
+    if (!m_thread) {
+        m_stop_event.create();
+        m_thread = std::jthread([this](std::stop_token stop_token) { run(stop_token); });
+    }
 
-    m_timer_thread = std::jthread([this](std::stop_token stop_token) {
-        mmh::set_thread_description(GetCurrentThread(), thread_name.c_str());
+    m_animations_changed.notify_one();
+}
 
-        dcomp::DcompApi dcomp_api;
-        wil::com_ptr<IDXGIOutput> primary_output;
-        FrameTimeAverager frame_time_averager;
-        FrameTimeMinimum vblank_time_minimum;
+void AnimationClock::remove_animation(const void* animation)
+{
+    std::scoped_lock lock(m_mutex);
+    std::erase_if(m_animations, [animation](auto&& item) { return item.id == animation; });
+}
 
-        if (!dcomp_api.has_wait_for_composition_clock() && mmh::is_windows_8_or_newer()) {
-            try {
-                const auto dxgi_factory = dxgi::create_dxgi_factory();
-                primary_output = dxgi::get_primary_output(dxgi_factory);
-            } catch (const wil::ResultException&) {
+void AnimationClock::run(std::stop_token stop_token)
+{
+    mmh::set_thread_description(GetCurrentThread(), thread_name.c_str());
+
+    dcomp::DcompApi dcomp_api;
+    wil::com_ptr<IDXGIOutput> primary_output;
+    FrameTimeAverager frame_time_averager;
+    FrameTimeMinimum vblank_time_minimum;
+    std::vector<Animation> animations;
+
+    if (!dcomp_api.has_wait_for_composition_clock() && mmh::is_windows_8_or_newer()) {
+        try {
+            const auto dxgi_factory = dxgi::create_dxgi_factory();
+            primary_output = dxgi::get_primary_output(dxgi_factory);
+        } catch (const wil::ResultException&) {
 #ifdef _DEBUG
-                LOG_CAUGHT_EXCEPTION();
+            LOG_CAUGHT_EXCEPTION();
 #endif
-            }
         }
+    }
 
-        auto last_vblank_time_point = std::chrono::steady_clock::now() - 16ms;
-
-        while (!stop_token.stop_requested()) {
-            double vblank_time_ms{};
+    auto last_vblank_time_point = std::chrono::steady_clock::now() - 16ms;
 
-            const auto wait_for_vblank = [&] {
-                if (dcomp_api.has_wait_for_composition_clock()) {
-                    const auto event = m_shutdown_event.get();
-                    [[maybe_unused]] const auto dcomp_status
-                        = dcomp_api.wait_for_composition_clock(m_shutdown_event ? 1 : 0, &event, 50);
+    const auto wait_for_vblank = [&] {
+        if (dcomp_api.has_wait_for_composition_clock()) {
+            const auto event = m_stop_event.get();
+            [[maybe_unused]] const auto dcomp_status
+                = dcomp_api.wait_for_composition_clock(m_stop_event ? 1 : 0, &event, 50);
 
 #ifdef _DEBUG
-                    LOG_IF_NTSTATUS_FAILED(dcomp_status);
+            LOG_IF_NTSTATUS_FAILED(dcomp_status);
 #endif
-                } else if (primary_output) {
-                    [[maybe_unused]] const auto hr = primary_output->WaitForVBlank();
+        } else if (primary_output) {
+            [[maybe_unused]] const auto hr = primary_output->WaitForVBlank();
 #ifdef _DEBUG
-                    LOG_IF_FAILED(hr);
+            LOG_IF_FAILED(hr);
 #endif
-                } else {
-                    [[maybe_unused]] const auto hr = DwmFlush();
+        } else {
+            [[maybe_unused]] const auto hr = DwmFlush();
 #ifdef _DEBUG
-                    LOG_IF_FAILED(hr);
+            LOG_IF_FAILED(hr);
 #endif
-                }
+        }
 
-                const auto vblank_time_point = std::chrono::steady_clock::now();
+        const auto vblank_time_point = std::chrono::steady_clock::now();
+        const auto vblank_time_ms = (vblank_time_point - last_vblank_time_point) / 1.ms;
 
-                vblank_time_ms = (vblank_time_point - last_vblank_time_point) / 1.ms;
+        if (vblank_time_ms > 1.)
+            vblank_time_minimum.add_frame_time(vblank_time_ms);
 
-                if (vblank_time_ms > 1.)
-                    vblank_time_minimum.add_frame_time(vblank_time_ms);
+        last_vblank_time_point = vblank_time_point;
+        return vblank_time_ms;
+    };
 
-                last_vblank_time_point = vblank_time_point;
-            };
+    while (!stop_token.stop_requested()) {
+        {
+            std::unique_lock lock(m_mutex);
 
-            wait_for_vblank();
+            if (m_animations.empty()) {
+                if (!m_animations_changed.wait(lock, stop_token, [this] { return !m_animations.empty(); }))
+                    return;
+
+                // Don't count the time spent parked as a frame
+                last_vblank_time_point = std::chrono::steady_clock::now() - 16ms;
+            }
+        }
 
-            // Possibly this could happen in scenarios like the display being off or RDP being in use
-            const auto need_to_sleep = vblank_time_ms < 1.;
+        const auto vblank_time_ms = wait_for_vblank();
 
-            if (stop_token.stop_requested())
-                return;
+        // Possibly this could happen in scenarios like the display being off or RDP being in use
+        const auto need_to_sleep = vblank_time_ms < 1.;
 
-            if (m_timer_active.load(std::memory_order_acquire)) {
-                if (!need_to_sleep) {
-                    // Throttle if the average frame time is more than 50% of minimum time between vblanks
-                    const auto num_frames_to_skip = std::max(
-                        0, static_cast<int>(frame_time_averager.get_average() * 2 / vblank_time_minimum.get_minimum()));
+        if (stop_token.stop_requested())
+            return;
 
-                    for (int index{}; index < num_frames_to_skip; ++index) {
-                        wait_for_vblank();
+        if (!need_to_sleep) {
+            // Throttle if the average frame time is more than 50% of minimum time between vblanks
+            const auto num_frames_to_skip = std::max(
+                0, static_cast<int>(frame_time_averager.get_average() * 2 / vblank_time_minimum.get_minimum()));
 
-                        if (stop_token.stop_requested())
-                            return;
-                    }
-                }
+            for (int index{}; index < num_frames_to_skip; ++index) {
+                wait_for_vblank();
 
-                const auto frame_start = std::chrono::steady_clock::now();
-                SendMessageTimeout(m_wnd, m_message_id, 0, 0, SMTO_BLOCK, 50, nullptr);
-                const auto frame_time = (std::chrono::steady_clock::now() - frame_start) / 1.ms;
-                frame_time_averager.add_frame(frame_time);
+                if (stop_token.stop_requested())
+                    return;
             }
+        }
+
+        {
+            std::scoped_lock lock(m_mutex);
+            animations.assign(m_animations.begin(), m_animations.end());
+        }
+
+        // The frame time covers all animations, so that the frame rate is
+        // throttled if the UI thread can't keep up with them together
+        const auto frame_start = std::chrono::steady_clock::now();
 
-            if (stop_token.stop_requested())
-                return;
+        for (auto&& animation : animations)
+            SendMessageTimeout(animation.wnd, animation.message_id, 0, 0, SMTO_BLOCK, 50, nullptr);
 
-            // Will typically sleep for longer in practice (as the usual Windows timer resolution is 15.6ms)
-            if (need_to_sleep)
-                Sleep(15);
+        if (!animations.empty()) {
+            const auto frame_time = (std::chrono::steady_clock::now() - frame_start) / 1.ms;
+            frame_time_averager.add_frame(frame_time);
         }
-    });
-}
 
-void SmoothScrollHelper::pause_timer_thread()
-{
-    m_timer_active.store(false, std::memory_order_release);
-    start_thread_shutdown_timer();
-}
+        if (stop_token.stop_requested())
+            return;
 
-void SmoothScrollHelper::stop_timer_thread()
-{
-    if (m_timer_thread) {
-        m_timer_thread->request_stop();
-        m_shutdown_event.SetEvent();
+        // Will typically sleep for longer in practice (as the usual Windows timer resolution is 15.6ms)
+        if (need_to_sleep)
+            Sleep(15);
     }
-
-    m_timer_thread.reset();
 }
 
-void SmoothScrollHelper::start_thread_shutdown_timer()
+void SmoothScrollHelper::start_animating()
 {
-    if (m_shutdown_timer_active)
-        stop_thread_shutdown_timer();
+    if (m_is_animating)
+        return;
 
-    SetTimer(m_wnd, m_timer_id, 2500, nullptr);
-    m_shutdown_timer_active = true;
+    m_is_animating = true;
+    m_clock->add_animation(this, m_wnd, m_message_id);
 }
 
-void SmoothScrollHelper::stop_thread_shutdown_timer()
+void SmoothScrollHelper::stop_animating()
 {
-    if (!m_shutdown_timer_active)
+    if (!m_is_animating)
         return;
 
-    m_shutdown_timer_active = false;
-    KillTimer(m_wnd, m_timer_id);
+    m_is_animating = false;
+    m_clock->remove_animation(this);
+}
+
+void SmoothScrollHelper::stop_animating_if_idle()
+{
+    if (!m_vertical_state.animation.is_active() && !m_horizontal_state.animation.is_active())
+        stop_animating();
 }
 
 } // namespace uih
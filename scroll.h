@@ -1,5 +1,7 @@
 #pragma once
 
+#include "scroll_animation.h"
+
 namespace uih {
 
 enum class ScrollAxis {
@@ -15,88 +17,124 @@ constexpr auto scroll_axis_to_win32_type(ScrollAxis axis)
 int set_scroll_position(HWND wnd, ScrollAxis axis, int old_position, int new_position);
 int clamp_scroll_position(HWND wnd, ScrollAxis axis, int position);
 
+/**
+ * Process-wide clock that paces animations to display refreshes.
+ *
+ * A single thread waits for each frame and then sends a message to the window
+ * of each running animation. The thread is parked while nothing is animating.
+ *
+ * This must be created and used on the UI thread.
+ */
+class AnimationClock {
+public:
+    using Ptr = std::shared_ptr<AnimationClock>;
+
+    static Ptr s_create()
+    {
+        auto ptr = s_ptr.lock();
+
+        if (!ptr) {
+            ptr = std::make_shared<AnimationClock>();
+            s_ptr = ptr;
+        }
+
+        return ptr;
+    }
+
+    AnimationClock() = default;
+    ~AnimationClock();
+
+    AnimationClock(const AnimationClock&) = delete;
+    AnimationClock& operator=(const AnimationClock&) = delete;
+
+    /**
+     * Start sending a message to a window on each frame.
+     *
+     * \param animation  Identifies the animation in remove_animation()
+     */
+    void add_animation(const void* animation, HWND wnd, uint32_t message_id);
+
+    /**
+     * Stop sending messages for an animation.
+     *
+     * A message that was already being sent may still arrive after this returns.
+     */
+    void remove_animation(const void* animation);
+
+private:
+    struct Animation {
+        const void* id{};
+        HWND wnd{};
+        uint32_t message_id{};
+    };
+
+    static constexpr wil::zwstring_view thread_name{L"[UI helpers] Animation clock thread"};
+
+    inline static std::weak_ptr<AnimationClock> s_ptr;
+
+    void run(std::stop_token stop_token);
+
+    std::mutex m_mutex;
+    std::condition_variable_any m_animations_changed;
+    std::vector<Animation> m_animations;
+    wil::unique_event_nothrow m_stop_event;
+    std::optional<std::jthread> m_thread;
+};
+
 class SmoothScrollHelper {
 public:
     using CurrentPositionFunc = std::function<int(ScrollAxis axis)>;
     using ClampPositionFunc = std::function<int(ScrollAxis axis, int position)>;
     using HandleScrollFunc = std::function<void(ScrollAxis axis, int new_position)>;
-    using Duration = std::chrono::duration<double, std::milli>;
+    using Duration = ScrollAnimation::Duration;
     static constexpr auto default_duration = Duration(250.);
 
-    SmoothScrollHelper(HWND wnd, uint32_t message_id, uint32_t timer_id, CurrentPositionFunc current_position,
+    SmoothScrollHelper(HWND wnd, uint32_t message_id, CurrentPositionFunc current_position,
         ClampPositionFunc clamp_position, HandleScrollFunc handle_scroll)
         : m_wnd(wnd)
         , m_message_id(message_id)
-        , m_timer_id(timer_id)
         , m_current_position(std::move(current_position))
         , m_clamp_position(std::move(clamp_position))
         , m_handle_scroll(std::move(handle_scroll))
-
+        , m_clock(AnimationClock::s_create())
     {
     }
-    ~SmoothScrollHelper() { stop_timer_thread(); }
+    ~SmoothScrollHelper() { stop_animating(); }
 
     int current_target(ScrollAxis axis) const
     {
-        auto& state = axis_state(axis);
-        return state.scroll_state ? state.scroll_state->start_position + state.scroll_state->target_delta
-                                  : m_current_position(axis);
+        auto& animation = axis_state(axis).animation;
+        return animation.is_active() ? animation.target_position() : m_current_position(axis);
     }
 
     void absolute_scroll(ScrollAxis axis, int target_position, Duration duration = default_duration);
     void delta_scroll(ScrollAxis axis, int delta, Duration duration = default_duration);
     void abandon_animation(ScrollAxis axis, bool update_scroll_position = true);
 
-    void on_timer()
-    {
-        stop_timer_thread();
-        stop_thread_shutdown_timer();
-    }
-
     void on_message()
     {
-        if (!m_timer_active.load(std::memory_order_acquire))
+        if (!m_is_animating)
             return;
 
-        assert(m_vertical_state.scroll_state || m_horizontal_state.scroll_state);
+        assert(m_vertical_state.animation.is_active() || m_horizontal_state.animation.is_active());
 
-        if (m_vertical_state.scroll_state)
+        if (m_vertical_state.animation.is_active())
             scroll(ScrollAxis::Vertical);
 
-        if (m_horizontal_state.scroll_state)
+        if (m_horizontal_state.animation.is_active())
             scroll(ScrollAxis::Horizontal);
     }
 
     bool should_smooth_scroll_mouse_wheel(ScrollAxis axis, int wheel_delta);
 
-    void shut_down()
-    {
-        stop_thread_shutdown_timer();
-        stop_timer_thread();
-    }
+    void shut_down() { stop_animating(); }
 
 private:
-    enum class EasingFunction {
-        Linear,
-        CubicEaseOut,
-    };
-
-    struct ScrollState {
-        std::chrono::time_point<std::chrono::steady_clock> start_time{};
-        int start_position{};
-        int target_delta{};
-        int last_delta{};
-        Duration duration{default_duration};
-        EasingFunction easing_function{EasingFunction::CubicEaseOut};
-    };
-
     struct AxisState {
-        std::optional<ScrollState> scroll_state;
+        ScrollAnimation animation;
         std::optional<uint64_t> last_mouse_wheel_tick_count;
     };
 
-    static constexpr wil::zwstring_view thread_name{L"[UI helpers] Smooth scroll thread"};
-
     AxisState& axis_state(ScrollAxis axis)
     {
         return axis == ScrollAxis::Vertical ? m_vertical_state : m_horizontal_state;
@@ -108,34 +146,22 @@ private:
 
     void scroll(ScrollAxis axis);
 
-    void update_state(ScrollAxis axis, int delta, bool accumulate, Duration duration,
-        std::chrono::time_point<std::chrono::steady_clock> now);
-
-    int remaining_delta(ScrollAxis axis) const
-    {
-        auto& state = axis_state(axis);
-        return state.scroll_state->target_delta - m_current_position(axis) + state.scroll_state->start_position;
-    }
-
-    void start_timer_thread();
-    void pause_timer_thread();
-    void stop_timer_thread();
+    void update_state(
+        ScrollAxis axis, int delta, bool accumulate, Duration duration, ScrollAnimation::TimePoint now);
 
-    void start_thread_shutdown_timer();
-    void stop_thread_shutdown_timer();
+    void start_animating();
+    void stop_animating();
+    void stop_animating_if_idle();
 
     HWND m_wnd{};
     uint32_t m_message_id{};
-    uint32_t m_timer_id{};
     AxisState m_vertical_state{};
     AxisState m_horizontal_state{};
     CurrentPositionFunc m_current_position;
     ClampPositionFunc m_clamp_position;
     HandleScrollFunc m_handle_scroll;
-    std::atomic<bool> m_timer_active{};
-    bool m_shutdown_timer_active{};
-    wil::unique_event_nothrow m_shutdown_event;
-    std::optional<std::jthread> m_timer_thread;
+    bool m_is_animating{};
+    AnimationClock::Ptr m_clock;
 };
 
 } // namespace uih
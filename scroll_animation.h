@@ -0,0 +1,280 @@
+#pragma once
+
+/*
+ * Scroll animation logic, independent of windows and of the system clock.
+ *
+ * Times are passed in explicitly, so that animations can be driven by a
+ * simulated clock (for example, to replay recorded input). This has no
+ * dependencies on Windows, so that it can be used and tested on other
+ * platforms.
+ */
+
+namespace uih {
+
+class ScrollAnimation {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+    using Duration = std::chrono::duration<double, std::milli>;
+
+    /** Time constant of the exponential deceleration of kinetic scrolling */
+    static constexpr auto kinetic_time_constant = Duration(325.);
+
+    /** Velocity, in pixels per millisecond, below which kinetic scrolling stops */
+    static constexpr double kinetic_min_velocity = 0.02;
+
+    struct Frame {
+        /** The scroll position for this frame */
+        int position{};
+        /** Whether this is the last frame of the animation */
+        bool is_final{};
+    };
+
+    bool is_active() const { return m_state.has_value(); }
+
+    /** Only valid to call this if is_active() returns true. */
+    int target_position() const { return m_state->start_position + m_state->target_delta; }
+
+    /**
+     * Start an animation, replacing any existing animation.
+     *
+     * The delta should already be clamped to the scrollable range.
+     */
+    void start(int current_position, int delta, Duration duration, TimePoint now)
+    {
+        m_state.emplace(now - first_frame_lead, current_position, delta, delta, duration);
+    }
+
+    /**
+     * Add a delta to the current animation.
+     *
+     * Only valid to call this if is_active() returns true. The animation
+     * switches to a linear one, and is extended if the same delta is added
+     * repeatedly (for example, while a mouse wheel is being spun), so that the
+     * scroll speed stays constant.
+     */
+    void accumulate(int current_position, int delta, Duration duration, TimePoint now)
+    {
+        auto& state = *m_state;
+
+        if (state.easing_function == EasingFunction::Linear && delta == state.last_delta) {
+            state.target_delta += delta;
+            state.duration = now - state.start_time + duration / 2.;
+        } else {
+            state.target_delta += state.start_position - current_position + delta;
+            state.last_delta = delta;
+            state.start_position = current_position;
+            state.duration = duration / 2.;
+            state.start_time = now;
+            state.easing_function = EasingFunction::Linear;
+        }
+    }
+
+    /**
+     * Scroll by a delta, either starting a new animation or adding the delta to
+     * the current one.
+     *
+     * \param accumulate        Whether to add the delta to the current animation
+     *                          (if there is one), rather than replacing it
+     * \param clamp_position    Function clamping a position to the scrollable range
+     */
+    template <class ClampPosition>
+    void scroll_by(int current_position, int delta, bool accumulate, Duration duration, TimePoint now,
+        ClampPosition&& clamp_position)
+    {
+        if (!is_active() || !accumulate) {
+            start(current_position, clamp_position(current_position + delta) - current_position, duration, now);
+            return;
+        }
+
+        this->accumulate(current_position, delta, duration, now);
+    }
+
+    /**
+     * Scroll to the position of the frame at a point in time, ending the
+     * animation after its final frame or if the position couldn't be applied
+     * (for example, because the scrollable range shrank).
+     *
+     * Only valid to call this if is_active() returns true.
+     *
+     * \param apply_position    Function scrolling to a position and returning the
+     *                          resulting scroll position
+     * \return                  The resulting scroll position
+     */
+    template <class ApplyPosition>
+    int advance(TimePoint now, ApplyPosition&& apply_position)
+    {
+        const auto frame = get_frame(now);
+        const auto position = apply_position(frame.position);
+
+        if (frame.is_final || position != frame.position)
+            reset();
+
+        return position;
+    }
+
+    /**
+     * Start an animation that continues scrolling at a velocity, decelerating
+     * exponentially until it falls below kinetic_min_velocity.
+     *
+     * \param velocity          Initial velocity, in pixels per millisecond
+     * \param clamp_position    Function clamping a position to the scrollable range
+     * \return                  Whether an animation was started
+     */
+    template <class ClampPosition>
+    bool start_kinetic(int current_position, double velocity, TimePoint now, ClampPosition&& clamp_position)
+    {
+        const auto speed = std::abs(velocity);
+
+        if (speed <= kinetic_min_velocity)
+            return false;
+
+        // The velocity decays by a factor of e every kinetic_time_constant
+        const auto decay_rate = std::log(speed / kinetic_min_velocity);
+        const auto distance = velocity * kinetic_time_constant.count() * (1. - kinetic_min_velocity / speed);
+
+        const auto target_position = clamp_position(current_position + static_cast<int>(std::round(distance)));
+        const auto delta = target_position - current_position;
+
+        if (delta == 0)
+            return false;
+
+        m_state.emplace(now - first_frame_lead, current_position, delta, delta, kinetic_time_constant * decay_rate,
+            EasingFunction::ExponentialDecay, decay_rate);
+        return true;
+    }
+
+    /**
+     * Get the scroll position at a point in time.
+     *
+     * Only valid to call this if is_active() returns true.
+     */
+    Frame get_frame(TimePoint now) const
+    {
+        const auto& state = *m_state;
+        const auto normalised_time = (now - state.start_time) / state.duration;
+        const auto progress = get_progress(state, normalised_time);
+
+        const auto position = state.start_position + static_cast<int>(std::round(state.target_delta * progress));
+        const auto bounded_position = std::clamp(position, state.start_position + std::min(state.target_delta, 0),
+            state.start_position + std::max(state.target_delta, 0));
+
+        return {bounded_position, position != bounded_position || bounded_position == target_position()};
+    }
+
+    void reset() { m_state.reset(); }
+
+private:
+    enum class EasingFunction {
+        Linear,
+        CubicEaseOut,
+        ExponentialDecay,
+    };
+
+    struct State {
+        TimePoint start_time{};
+        int start_position{};
+        int target_delta{};
+        int last_delta{};
+        Duration duration{};
+        EasingFunction easing_function{EasingFunction::CubicEaseOut};
+        /** For ExponentialDecay, the duration divided by the time constant */
+        double decay_rate{};
+    };
+
+    /** Animations start slightly in the past, so that the first frame already moves */
+    static constexpr auto first_frame_lead = std::chrono::milliseconds(8);
+
+    static double get_progress(const State& state, double normalised_time)
+    {
+        switch (state.easing_function) {
+        case EasingFunction::Linear:
+            return normalised_time;
+        case EasingFunction::CubicEaseOut:
+            return 1. - std::pow(1. - normalised_time, 3);
+        case EasingFunction::ExponentialDecay:
+            return (1. - std::exp(-normalised_time * state.decay_rate)) / (1. - std::exp(-state.decay_rate));
+        }
+
+        return 1.;
+    }
+
+    std::optional<State> m_state;
+};
+
+/**
+ * Estimates the velocity of a series of scroll deltas (for example, from a
+ * touchpad).
+ */
+class ScrollVelocityTracker {
+public:
+    using TimePoint = ScrollAnimation::TimePoint;
+
+    void add_delta(int delta, TimePoint now)
+    {
+        // Start again if there was a pause or the direction changed
+        if (!m_samples.empty()
+            && (now - m_samples.back().time > max_sample_gap || (delta < 0) != (m_samples.back().delta < 0)))
+            m_samples.clear();
+
+        m_samples.emplace_back(now, delta);
+
+        if (m_samples.size() > max_samples)
+            m_samples.pop_front();
+    }
+
+    /**
+     * Get the velocity, in pixels per millisecond.
+     *
+     * This is zero if there haven't been any recent deltas.
+     */
+    double get_velocity(TimePoint now) const
+    {
+        if (m_samples.size() < 2 || now - m_samples.back().time > max_sample_gap)
+            return 0.;
+
+        const auto elapsed_ms = ScrollAnimation::Duration(m_samples.back().time - m_samples.front().time).count();
+
+        if (elapsed_ms <= 0.)
+            return 0.;
+
+        // The first delta happened before the elapsed time started
+        auto distance = 0;
+
+        for (auto iter = std::next(m_samples.begin()); iter != m_samples.end(); ++iter)
+            distance += iter->delta;
+
+        return distance / elapsed_ms;
+    }
+
+    void reset() { m_samples.clear(); }
+
+private:
+    struct Sample {
+        TimePoint time{};
+        int delta{};
+    };
+
+    static constexpr size_t max_samples{8};
+    static constexpr auto max_sample_gap = std::chrono::milliseconds(100);
+
+    std::deque<Sample> m_samples;
+};
+
+/**
+ * Continue a series of direct scrolls recorded by a velocity tracker with a
+ * kinetic animation, and reset the tracker.
+ *
+ * \param clamp_position    Function clamping a position to the scrollable range
+ * \return                  Whether an animation was started
+ */
+template <class ClampPosition>
+bool start_kinetic_scroll(ScrollAnimation& animation, ScrollVelocityTracker& velocity_tracker, int current_position,
+    ScrollAnimation::TimePoint now, ClampPosition&& clamp_position)
+{
+    const auto velocity = velocity_tracker.get_velocity(now);
+    velocity_tracker.reset();
+
+    return animation.start_kinetic(current_position, velocity, now, std::forward<ClampPosition>(clamp_position));
+}
+
+} // namespace uih
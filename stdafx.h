@@ -21,11 +21,20 @@
 #endif
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <bitset>
 #include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <iostream>
 #include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <ranges>
 #include <regex>
@@ -33,6 +42,7 @@
 #include <span>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
@@ -0,0 +1,93 @@
+#pragma once
+
+/*
+ * Deterministic synthetic track titles, used as benchmark input.
+ */
+
+namespace uih::benchmarks {
+
+struct CorpusOptions {
+    size_t count{100'000};
+    /** Fraction of titles containing colour and font codes */
+    double formatted_fraction{0.1};
+    /** Fraction of titles containing a line break */
+    double multiline_fraction{0.01};
+    uint32_t seed{1};
+};
+
+/**
+ * Generate track titles of a few words each (for example, "Seven Blue
+ * Mornings (Live)"), some of which contain colour codes (\3...\3), font codes
+ * (\7...\7) and line breaks.
+ */
+inline std::vector<std::wstring> generate_titles(const CorpusOptions& options = {})
+{
+    static constexpr std::array words{L"Love", L"Night", L"Blue", L"Song", L"Heart", L"Dream", L"Fire", L"Rain",
+        L"Summer", L"Light", L"Morning", L"City", L"River", L"Golden", L"Electric", L"Seven", L"Road", L"Shadow",
+        L"Ocean", L"Midnight", L"Silver", L"Wild", L"Home", L"Stars", L"Echo", L"Paradise", L"Winter", L"Angel",
+        L"Sweet", L"Time", L"Café", L"Señorita", L"Nación", L"Straße", L"Ça", L"Déjà", L"Über"};
+    static constexpr std::array suffixes{L" (Live)", L" (Remastered 2011)", L" (Radio Edit)", L" - Acoustic",
+        L" (feat. Someone Else)", L" [Bonus Track]"};
+
+    std::mt19937 engine(options.seed);
+    std::uniform_int_distribution<size_t> word_distribution(0, words.size() - 1);
+    std::uniform_int_distribution<size_t> word_count_distribution(1, 6);
+    std::uniform_int_distribution<size_t> suffix_distribution(0, suffixes.size() * 4 - 1);
+    std::bernoulli_distribution formatted_distribution(options.formatted_fraction);
+    std::bernoulli_distribution multiline_distribution(options.multiline_fraction);
+
+    std::vector<std::wstring> titles;
+    titles.reserve(options.count);
+
+    for (size_t index{}; index < options.count; ++index) {
+        std::wstring title;
+        const auto word_count = word_count_distribution(engine);
+
+        for (size_t word_index{}; word_index < word_count; ++word_index) {
+            if (word_index > 0)
+                title += L' ';
+
+            title += words[word_distribution(engine)];
+        }
+
+        if (const auto suffix_index = suffix_distribution(engine); suffix_index < suffixes.size())
+            title += suffixes[suffix_index];
+
+        if (formatted_distribution(engine))
+            title = L"\3" L"ff0000" L"\3" + title.substr(0, title.size() / 2) + L"\7font-weight: bold\7"
+                + title.substr(title.size() / 2);
+
+        if (multiline_distribution(engine))
+            title.insert(title.size() / 2, L"\r\n");
+
+        titles.emplace_back(std::move(title));
+    }
+
+    return titles;
+}
+
+/** Convert titles to UTF-8 (the generated titles only contain characters below U+0800) */
+inline std::vector<std::string> to_utf8(const std::vector<std::wstring>& titles)
+{
+    std::vector<std::string> utf8_titles;
+    utf8_titles.reserve(titles.size());
+
+    for (auto&& title : titles) {
+        std::string utf8_title;
+
+        for (const auto character : title) {
+            if (character < 0x80) {
+                utf8_title += static_cast<char>(character);
+            } else {
+                utf8_title += static_cast<char>(0xc0 | (character >> 6));
+                utf8_title += static_cast<char>(0x80 | (character & 0x3f));
+            }
+        }
+
+        utf8_titles.emplace_back(std::move(utf8_title));
+    }
+
+    return utf8_titles;
+}
+
+} // namespace uih::benchmarks
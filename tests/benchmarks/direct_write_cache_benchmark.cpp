@@ -0,0 +1,179 @@
+#include <benchmark/benchmark.h>
+
+#include "corpus.h"
+#include "direct_write_cache.h"
+
+using namespace uih::direct_write;
+
+namespace {
+
+using Cache = TextLayoutCache<std::shared_ptr<int>>;
+
+constexpr size_t column_count = 4;
+constexpr size_t visible_row_count = 40;
+constexpr float column_width = 150.f;
+constexpr float row_height = 20.f;
+
+const std::vector<std::wstring>& get_titles()
+{
+    static const auto titles = uih::benchmarks::generate_titles({.count = 20'000});
+    return titles;
+}
+
+Cache::CacheKeyView make_key(std::wstring_view text, float width, size_t column)
+{
+    return {text, width, row_height, true, DWRITE_TEXT_ALIGNMENT_LEADING, static_cast<uint32_t>(column)};
+}
+
+/** Looks up a cell as the list view renderer does, adding it on a miss */
+void get_or_put(Cache& cache, const Cache::CacheKeyView& key, const std::shared_ptr<int>& value)
+{
+    if (auto cached_value = cache.get(key)) {
+        benchmark::DoNotOptimize(cached_value);
+        return;
+    }
+
+    if (auto reused_value = cache.get_with_different_width(key)) {
+        benchmark::DoNotOptimize(reused_value);
+        return;
+    }
+
+    cache.put_new(key, value);
+}
+
+/**
+ * Paint the visible rows of a list view with 5,000 rows, scrolling by the
+ * passed number of rows each frame (3 for mouse wheel scrolling, 1 for smooth
+ * scrolling and a whole page for page down).
+ */
+void scroll(benchmark::State& state)
+{
+    const auto& titles = get_titles();
+    const auto rows_per_frame = static_cast<size_t>(state.range(0));
+    const auto row_count = size_t{5'000};
+    const auto value = std::make_shared<int>();
+
+    Cache cache(32);
+    cache.set_min_size(column_count * visible_row_count * 3 / 2);
+
+    size_t first_row{};
+
+    for (auto _ : state) {
+        cache.start_new_frame();
+
+        for (auto row = first_row; row < first_row + visible_row_count; ++row)
+            for (size_t column{}; column < column_count; ++column)
+                get_or_put(cache, make_key(titles[(row * column_count + column) % titles.size()], column_width, column),
+                    value);
+
+        first_row = (first_row + rows_per_frame) % (row_count - visible_row_count);
+    }
+
+    state.SetItemsProcessed(state.iterations() * column_count * visible_row_count);
+    state.counters["hit_rate"] = static_cast<double>(cache.stats().hits) / static_cast<double>(cache.stats().lookups);
+}
+
+/**
+ * Repaint the same visible rows while a column is being resized, so that the
+ * width changes every frame.
+ */
+void resize_column(benchmark::State& state)
+{
+    const auto& titles = get_titles();
+    const auto value = std::make_shared<int>();
+
+    Cache cache(32);
+    cache.set_min_size(column_count * visible_row_count * 3 / 2);
+
+    auto width = column_width;
+
+    for (auto _ : state) {
+        cache.start_new_frame();
+
+        for (size_t row{}; row < visible_row_count; ++row)
+            for (size_t column{}; column < column_count; ++column)
+                get_or_put(cache,
+                    make_key(titles[row * column_count + column], column == 0 ? width : column_width, column), value);
+
+        width = width >= 300.f ? column_width : width + 1.f;
+    }
+
+    state.SetItemsProcessed(state.iterations() * column_count * visible_row_count);
+}
+
+/**
+ * Look up keys following a Zipf distribution (with an exponent of 1), as with
+ * text that repeats across many rows, such as artist and album names.
+ */
+void zipf(benchmark::State& state)
+{
+    const auto& titles = get_titles();
+    const auto distinct_count = static_cast<size_t>(state.range(0));
+    const auto value = std::make_shared<int>();
+
+    std::vector<double> weights(distinct_count);
+
+    for (size_t index{}; index < distinct_count; ++index)
+        weights[index] = 1. / static_cast<double>(index + 1);
+
+    std::mt19937 engine(1);
+    std::discrete_distribution<size_t> distribution(weights.begin(), weights.end());
+    std::vector<size_t> indices(65'536);
+    std::ranges::generate(indices, [&] { return distribution(engine); });
+
+    Cache cache(256);
+    size_t position{};
+
+    for (auto _ : state) {
+        get_or_put(cache, make_key(titles[indices[position]], column_width, 0), value);
+        position = (position + 1) % indices.size();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["hit_rate"] = static_cast<double>(cache.stats().hits) / static_cast<double>(cache.stats().lookups);
+    state.counters["capacity"] = static_cast<double>(cache.max_size());
+}
+
+/** Look up keys that are never repeated, so that every lookup misses and evicts an entry */
+void unique_keys(benchmark::State& state)
+{
+    const auto& titles = get_titles();
+    const auto value = std::make_shared<int>();
+
+    Cache cache(256);
+    size_t position{};
+
+    for (auto _ : state) {
+        // Varying the width makes keys unique when the titles repeat
+        get_or_put(cache, make_key(titles[position % titles.size()], static_cast<float>(position), 0), value);
+        ++position;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+void generational_text_cache_hits(benchmark::State& state)
+{
+    const auto& titles = get_titles();
+    GenerationalTextCache<float> cache(4096);
+
+    for (size_t index{}; index < 1'000; ++index)
+        cache.put(titles[index], 0, static_cast<float>(index));
+
+    size_t position{};
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.get(titles[position], 0));
+        position = (position + 1) % 1'000;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(scroll)->Arg(1)->Arg(3)->Arg(visible_row_count);
+BENCHMARK(resize_column);
+BENCHMARK(zipf)->Arg(200)->Arg(2'000)->Arg(20'000);
+BENCHMARK(unique_keys);
+BENCHMARK(generational_text_cache_hits);
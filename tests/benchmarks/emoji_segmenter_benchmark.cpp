@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+
+#include "corpus.h"
+#include "emoji_segmenter.h"
+
+using namespace uih;
+
+namespace {
+
+/** Convert titles to UTF-16 (the generated titles only contain characters in the BMP) */
+std::vector<std::u16string> to_utf16(const std::vector<std::wstring>& titles)
+{
+    std::vector<std::u16string> utf16_titles;
+    utf16_titles.reserve(titles.size());
+
+    for (auto&& title : titles)
+        utf16_titles.emplace_back(title.begin(), title.end());
+
+    return utf16_titles;
+}
+
+const std::vector<std::u16string>& get_titles()
+{
+    static const auto titles = to_utf16(benchmarks::generate_titles());
+    return titles;
+}
+
+/** Titles with an emoji sequence inserted into every other one */
+const std::vector<std::u16string>& get_titles_with_emoji()
+{
+    static const auto titles = [] {
+        static constexpr std::array sequences{u"❤️", u"\U0001F44D\U0001F3FD", u"\U0001F1EC\U0001F1E7",
+            u"\U0001F468‍\U0001F469‍\U0001F467", u"1️⃣", u"❤︎", u"\U0001F600"};
+
+        auto titles = get_titles();
+
+        for (size_t index{}; index < titles.size(); index += 2)
+            titles[index].insert(titles[index].size() / 2, sequences[index / 2 % sequences.size()]);
+
+        return titles;
+    }();
+    return titles;
+}
+
+void segment_titles(benchmark::State& state, const std::vector<std::u16string>& titles)
+{
+    size_t code_unit_count{};
+
+    for (auto&& title : titles)
+        code_unit_count += title.size();
+
+    for (auto _ : state) {
+        size_t segment_count{};
+
+        for (auto&& title : titles) {
+            const std::u16string_view view(title);
+
+            for (size_t position{}; position < view.size(); ++segment_count)
+                position += emoji::get_next_segment(view, position).length;
+        }
+
+        benchmark::DoNotOptimize(segment_count);
+    }
+
+    state.SetItemsProcessed(state.iterations() * titles.size());
+    state.SetBytesProcessed(state.iterations() * code_unit_count * sizeof(char16_t));
+}
+
+void segment_text(benchmark::State& state)
+{
+    segment_titles(state, get_titles());
+}
+
+void segment_text_with_emoji(benchmark::State& state)
+{
+    segment_titles(state, get_titles_with_emoji());
+}
+
+/** Look up the emoji properties of every code point in the titles */
+void get_emoji_properties(benchmark::State& state)
+{
+    const auto& titles = get_titles_with_emoji();
+
+    for (auto _ : state) {
+        size_t emoji_count{};
+
+        for (auto&& title : titles) {
+            const std::u16string_view view(title);
+
+            for (size_t position{}; position < view.size();) {
+                const auto [code_point, length] = emoji::decode_utf16(view, position);
+
+                if (emoji::get_emoji_properties(code_point))
+                    ++emoji_count;
+
+                position += length;
+            }
+        }
+
+        benchmark::DoNotOptimize(emoji_count);
+    }
+}
+
+} // namespace
+
+BENCHMARK(segment_text);
+BENCHMARK(segment_text_with_emoji);
+BENCHMARK(get_emoji_properties);
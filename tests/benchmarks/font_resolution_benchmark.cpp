@@ -0,0 +1,108 @@
+/*
+ * Start-up costs of direct_write::Context: creating it, and resolving the
+ * configured fonts individually, in a batch and from the cache.
+ *
+ * This uses DirectWrite, so is only built on Windows, and needs the full
+ * library (see UIH_WINDOWS_LIBRARY in CMakeLists.txt).
+ */
+
+#include "stdafx.h"
+
+#include <benchmark/benchmark.h>
+
+#include "direct_write.h"
+
+using namespace uih::direct_write;
+
+namespace {
+
+/** Fonts that might be configured in a typical application */
+const std::vector<FontNamesQuery>& get_queries()
+{
+    static const std::vector<FontNamesQuery> queries{
+        {L"Segoe UI", L"Segoe UI"},
+        {L"Segoe UI Semibold", L"Segoe UI", DWRITE_FONT_WEIGHT_SEMI_BOLD},
+        {L"Segoe UI", L"Segoe UI", DWRITE_FONT_WEIGHT_BOLD},
+        {L"Segoe UI", L"Segoe UI", DWRITE_FONT_WEIGHT_REGULAR, DWRITE_FONT_STRETCH_NORMAL, DWRITE_FONT_STYLE_ITALIC},
+        {L"Segoe UI Variable Text", L"Segoe UI Variable", DWRITE_FONT_WEIGHT_REGULAR, DWRITE_FONT_STRETCH_NORMAL,
+            DWRITE_FONT_STYLE_NORMAL, {{DWRITE_FONT_AXIS_TAG_OPTICAL_SIZE, 10.5f}}},
+        {L"Consolas", L"Consolas"},
+        {L"Tahoma", L"Tahoma"},
+        {L"Calibri", L"Calibri"},
+    };
+    return queries;
+}
+
+void create_context(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(std::make_shared<Context>());
+}
+
+/** Resolve each font with a separate call, using a new context each time so that nothing is cached */
+void resolve_font_names_individually(benchmark::State& state)
+{
+    const auto& queries = get_queries();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        const auto context = std::make_shared<Context>();
+        state.ResumeTiming();
+
+        for (auto&& query : queries)
+            benchmark::DoNotOptimize(context->resolve_font_names(query.wss_family_name.c_str(),
+                query.typographic_family_name.c_str(), query.weight, query.stretch, query.style, query.axis_values));
+    }
+
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+/** Resolve all fonts with a single call, using a new context each time so that nothing is cached */
+void resolve_font_names_in_batch(benchmark::State& state)
+{
+    const auto& queries = get_queries();
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        const auto context = std::make_shared<Context>();
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(context->resolve_font_names(queries));
+    }
+
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+void resolve_cached_font_names(benchmark::State& state)
+{
+    const auto& queries = get_queries();
+    const auto context = std::make_shared<Context>();
+    (void)context->resolve_font_names(queries);
+
+    for (auto _ : state) {
+        for (auto&& query : queries)
+            benchmark::DoNotOptimize(context->resolve_font_names(query.wss_family_name.c_str(),
+                query.typographic_family_name.c_str(), query.weight, query.stretch, query.style, query.axis_values));
+    }
+
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+void get_font_families(benchmark::State& state)
+{
+    for (auto _ : state) {
+        state.PauseTiming();
+        const auto context = std::make_shared<Context>();
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(context->get_font_families());
+    }
+}
+
+} // namespace
+
+BENCHMARK(create_context)->Unit(benchmark::kMicrosecond);
+BENCHMARK(resolve_font_names_individually)->Unit(benchmark::kMicrosecond);
+BENCHMARK(resolve_font_names_in_batch)->Unit(benchmark::kMicrosecond);
+BENCHMARK(resolve_cached_font_names)->Unit(benchmark::kMicrosecond);
+BENCHMARK(get_font_families)->Unit(benchmark::kMillisecond);
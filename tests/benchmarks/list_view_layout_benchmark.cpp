@@ -0,0 +1,129 @@
+#include <benchmark/benchmark.h>
+
+#include "list_view_model.h"
+
+using namespace uih;
+using namespace uih::benchmarks;
+
+namespace {
+
+constexpr int item_height = 20;
+constexpr int viewport_height = 1'000;
+
+lv::LayoutMetrics make_metrics(bool sticky_group_headers)
+{
+    return {.item_height = item_height,
+        .group_height = 25,
+        .visible_group_count = 2,
+        .sticky_group_headers = sticky_group_headers,
+        .leaf_group_header_bottom_margin = 5,
+        .stuck_leaf_group_header_bottom_margin = 1,
+        .root_group_indentation_amount = 4,
+        .indentation_step = 10,
+        .total_indentation = 24,
+        .columns_display_width = 800};
+}
+
+ListViewModel& get_library(size_t item_count)
+{
+    static std::unordered_map<size_t, ListViewModel> libraries;
+
+    auto [iterator, inserted] = libraries.try_emplace(item_count);
+
+    if (inserted)
+        iterator->second = generate_library(item_count, item_height);
+
+    return iterator->second;
+}
+
+std::vector<int> generate_scroll_positions(int max_position)
+{
+    std::mt19937 engine(1);
+    std::uniform_int_distribution<int> distribution(0, std::max(0, max_position));
+    std::vector<int> positions(4'096);
+    std::ranges::generate(positions, [&] { return distribution(engine); });
+    return positions;
+}
+
+/**
+ * Build the display list for a viewport at random scroll positions in a
+ * library of the passed number of items.
+ */
+void build_display_list(benchmark::State& state)
+{
+    auto& model = get_library(static_cast<size_t>(state.range(0)));
+    const auto layout = make_layout(model, make_metrics(state.range(1) != 0));
+    const auto total_height = layout.get_item_group_bottom(model.heights.size() - 1) + 1;
+    const auto scroll_positions = generate_scroll_positions(total_height - viewport_height);
+    const RECT items_rect{0, 0, 1'000, viewport_height};
+
+    size_t position_index{};
+    size_t entry_count{};
+
+    for (auto _ : state) {
+        const auto display_list
+            = layout.build_display_list(items_rect, items_rect, scroll_positions[position_index]);
+        entry_count += display_list.entries.size();
+        benchmark::DoNotOptimize(display_list.entries.data());
+        position_index = (position_index + 1) % scroll_positions.size();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["entries"] = static_cast<double>(entry_count) / static_cast<double>(state.iterations());
+}
+
+/** Scroll through a library one frame at a time, as during a smooth scroll */
+void scroll(benchmark::State& state)
+{
+    auto& model = get_library(static_cast<size_t>(state.range(0)));
+    const auto layout = make_layout(model, make_metrics(true));
+    const auto max_position = layout.get_item_group_bottom(model.heights.size() - 1) + 1 - viewport_height;
+    const RECT items_rect{0, 0, 1'000, viewport_height};
+
+    int scroll_position{};
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(layout.build_display_list(items_rect, items_rect, scroll_position));
+        scroll_position = scroll_position + 37 > max_position ? 0 : scroll_position + 37;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+void vertical_hit_test(benchmark::State& state)
+{
+    auto& model = get_library(static_cast<size_t>(state.range(0)));
+    const auto layout = make_layout(model, make_metrics(true));
+    const auto y_positions = generate_scroll_positions(layout.get_item_group_bottom(model.heights.size() - 1));
+
+    size_t position_index{};
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(layout.vertical_hit_test(y_positions[position_index]));
+        position_index = (position_index + 1) % y_positions.size();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** Calculate the positions of all items, as when items are added or the font changes */
+void calculate_item_positions(benchmark::State& state)
+{
+    auto& model = get_library(static_cast<size_t>(state.range(0)));
+    const auto layout = make_layout(model, make_metrics(true));
+
+    for (auto _ : state) {
+        layout.calculate_item_positions(
+            0, [&model](size_t index, int position) { model.positions[index] = position; });
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(build_display_list)->ArgsProduct({{10'000, 1'000'000, 5'000'000}, {0, 1}});
+BENCHMARK(scroll)->Arg(1'000'000);
+BENCHMARK(vertical_hit_test)->Arg(10'000)->Arg(1'000'000)->Arg(5'000'000);
+BENCHMARK(calculate_item_positions)->Arg(1'000'000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,97 @@
+#pragma once
+
+/*
+ * List view items for lv::ItemsLayout, without a list view.
+ */
+
+#include "list_view/list_view_layout.h"
+
+namespace uih::benchmarks {
+
+struct ListViewModel {
+    size_t group_count{};
+    std::vector<int> heights;
+    std::vector<int> positions;
+    /** The group IDs of each item, one for each level */
+    std::vector<uint32_t> groups;
+    /** Whether each group ID is a hidden group */
+    std::vector<bool> hidden_groups;
+
+    /** Add a group, returning its ID */
+    uint32_t add_group(bool is_hidden = false)
+    {
+        hidden_groups.emplace_back(is_hidden);
+        return static_cast<uint32_t>(hidden_groups.size() - 1);
+    }
+
+    void add_item(std::initializer_list<uint32_t> item_groups, int height)
+    {
+        assert(item_groups.size() == group_count);
+        groups.insert(groups.end(), item_groups);
+        heights.emplace_back(height);
+        positions.emplace_back(0);
+    }
+};
+
+class ListViewModelItems {
+public:
+    explicit ListViewModelItems(const ListViewModel& model) : m_model(&model) {}
+
+    size_t size() const { return m_model->heights.size(); }
+    size_t group_count() const { return m_model->group_count; }
+    int get_position(size_t index) const { return m_model->positions[index]; }
+    int get_height(size_t index) const { return m_model->heights[index]; }
+
+    uint32_t get_group(size_t index, size_t level) const
+    {
+        return m_model->groups[index * m_model->group_count + level];
+    }
+
+    bool is_group_hidden(size_t index, size_t level) const { return m_model->hidden_groups[get_group(index, level)]; }
+
+private:
+    const ListViewModel* m_model;
+};
+
+using ListViewModelLayout = lv::ItemsLayout<ListViewModelItems>;
+
+/** Create a layout for a model, calculating the positions of its items */
+inline ListViewModelLayout make_layout(ListViewModel& model, const lv::LayoutMetrics& metrics)
+{
+    ListViewModelLayout layout(ListViewModelItems(model), metrics);
+    layout.calculate_item_positions(0, [&model](size_t index, int position) { model.positions[index] = position; });
+    return layout;
+}
+
+/**
+ * Generate items grouped by artist and then album, as in a large music
+ * library.
+ */
+inline ListViewModel generate_library(size_t item_count, int item_height, uint32_t seed = 1)
+{
+    std::mt19937 engine(seed);
+    std::uniform_int_distribution<size_t> album_size_distribution(1, 20);
+    std::uniform_int_distribution<size_t> artist_size_distribution(1, 5);
+
+    ListViewModel model{.group_count = 2};
+    model.heights.reserve(item_count);
+    model.positions.reserve(item_count);
+    model.groups.reserve(item_count * 2);
+
+    while (model.heights.size() < item_count) {
+        const auto artist = model.add_group();
+        const auto album_count = artist_size_distribution(engine);
+
+        for (size_t album_index{}; album_index < album_count && model.heights.size() < item_count; ++album_index) {
+            const auto album = model.add_group();
+            const auto track_count = album_size_distribution(engine);
+
+            for (size_t track{}; track < track_count && model.heights.size() < item_count; ++track)
+                model.add_item({artist, album}, item_height);
+        }
+    }
+
+    return model;
+}
+
+} // namespace uih::benchmarks
@@ -0,0 +1,121 @@
+#include <benchmark/benchmark.h>
+
+#include "scroll_simulation.h"
+
+using namespace uih;
+using namespace uih::benchmarks;
+
+namespace {
+
+using Duration = ScrollAnimation::Duration;
+
+/**
+ * Generate a mouse wheel trace of bursts of notches (as when a wheel is spun a
+ * few times and then stopped), in alternating directions.
+ */
+std::vector<ScrollEvent> generate_wheel_trace(size_t burst_count)
+{
+    std::mt19937 engine(1);
+    std::uniform_int_distribution<size_t> notch_count_distribution(1, 12);
+    std::uniform_real_distribution<double> notch_interval_distribution(20., 80.);
+    std::uniform_real_distribution<double> pause_distribution(200., 1'000.);
+
+    std::vector<ScrollEvent> events;
+    Duration time{};
+
+    for (size_t burst{}; burst < burst_count; ++burst) {
+        const auto delta = burst % 2 == 0 ? 120 : -120;
+        const auto notch_count = notch_count_distribution(engine);
+
+        for (size_t notch{}; notch < notch_count; ++notch) {
+            events.emplace_back(time, delta);
+            time += Duration(notch_interval_distribution(engine));
+        }
+
+        time += Duration(pause_distribution(engine));
+    }
+
+    return events;
+}
+
+/** Replay a wheel trace frame by frame at 60 Hz */
+void replay_wheel_trace(benchmark::State& state)
+{
+    const auto trace = generate_wheel_trace(static_cast<size_t>(state.range(0)));
+    size_t frame_count{};
+
+    for (auto _ : state) {
+        ScrollSimulation simulation(1'000'000);
+        const auto positions = simulation.replay_smooth_scrolls(trace);
+        frame_count += positions.size();
+        benchmark::DoNotOptimize(positions.data());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(frame_count));
+    state.counters["events"] = static_cast<double>(trace.size());
+}
+
+/** Replay touchpad flicks of varying speeds, each followed by a kinetic scroll */
+void replay_flicks(benchmark::State& state)
+{
+    std::vector<std::vector<ScrollEvent>> flicks;
+
+    for (auto delta = 5; delta <= 60; delta += 5) {
+        std::vector<ScrollEvent> flick;
+
+        for (auto index = 0; index < 8; ++index)
+            flick.emplace_back(Duration(8. * index), delta);
+
+        flicks.emplace_back(std::move(flick));
+    }
+
+    size_t frame_count{};
+
+    for (auto _ : state) {
+        for (auto&& flick : flicks) {
+            ScrollSimulation simulation(1'000'000);
+            const auto positions = simulation.replay_flick(flick);
+            frame_count += positions.size();
+            benchmark::DoNotOptimize(positions.data());
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(frame_count));
+}
+
+void get_frame(benchmark::State& state)
+{
+    ScrollAnimation animation;
+    const ScrollAnimation::TimePoint start{};
+    animation.start(0, 10'000, Duration(250.), start);
+
+    auto time = start;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(animation.get_frame(time));
+        time = time >= start + std::chrono::milliseconds(250) ? start : time + std::chrono::microseconds(100);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+void track_velocity(benchmark::State& state)
+{
+    ScrollVelocityTracker tracker;
+    ScrollAnimation::TimePoint time{};
+
+    for (auto _ : state) {
+        time += std::chrono::milliseconds(8);
+        tracker.add_delta(20, time);
+        benchmark::DoNotOptimize(tracker.get_velocity(time));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(replay_wheel_trace)->Arg(10)->Arg(1'000);
+BENCHMARK(replay_flicks);
+BENCHMARK(get_frame);
+BENCHMARK(track_velocity);
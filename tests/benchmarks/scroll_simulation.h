@@ -0,0 +1,110 @@
+#pragma once
+
+/*
+ * Replays scroll input against ScrollAnimation using a simulated clock, using
+ * the same ScrollAnimation functions that SmoothScrollHelper uses to apply it to
+ * a window.
+ */
+
+#include "scroll_animation.h"
+
+namespace uih::benchmarks {
+
+struct ScrollEvent {
+    /** The time of the event, relative to the start of the trace */
+    ScrollAnimation::Duration time{};
+    int delta{};
+};
+
+class ScrollSimulation {
+public:
+    using Duration = ScrollAnimation::Duration;
+    using TimePoint = ScrollAnimation::TimePoint;
+
+    /** 60 Hz */
+    static constexpr auto default_frame_interval = Duration(1000. / 60.);
+
+    explicit ScrollSimulation(int max_position, Duration frame_interval = default_frame_interval)
+        : m_max_position(max_position)
+        , m_frame_interval(frame_interval)
+    {
+    }
+
+    int position() const { return m_position; }
+
+    /**
+     * Replay smooth scrolls (for example, from mouse wheel notches).
+     *
+     * \return  The scroll position at each frame, until the animation ends
+     */
+    std::vector<int> replay_smooth_scrolls(std::span<const ScrollEvent> events, Duration duration = Duration(250.))
+    {
+        std::vector<int> positions;
+        auto event_iter = events.begin();
+
+        for (auto frame_time = Duration{}; event_iter != events.end() || m_animation.is_active();
+             frame_time += m_frame_interval) {
+            for (; event_iter != events.end() && event_iter->time <= frame_time; ++event_iter)
+                smooth_scroll(event_iter->delta, duration, to_time_point(event_iter->time));
+
+            if (m_animation.is_active())
+                positions.emplace_back(render_frame(to_time_point(frame_time)));
+        }
+
+        return positions;
+    }
+
+    /**
+     * Replay direct scrolls (for example, from a touchpad), followed by a
+     * kinetic scroll starting at the time of the last one.
+     *
+     * \return  The scroll position at each frame of the kinetic scroll, until it ends
+     */
+    std::vector<int> replay_flick(std::span<const ScrollEvent> events)
+    {
+        for (auto&& event : events) {
+            m_position = clamp_position(m_position + event.delta);
+            m_velocity_tracker.add_delta(event.delta, to_time_point(event.time));
+        }
+
+        const auto start_time = events.empty() ? Duration{} : events.back().time;
+
+        if (!start_kinetic_scroll(m_animation, m_velocity_tracker, m_position, to_time_point(start_time),
+                [this](int position) { return clamp_position(position); }))
+            return {};
+
+        std::vector<int> positions;
+
+        for (auto frame_time = start_time + m_frame_interval; m_animation.is_active(); frame_time += m_frame_interval)
+            positions.emplace_back(render_frame(to_time_point(frame_time)));
+
+        return positions;
+    }
+
+private:
+    static TimePoint to_time_point(Duration time)
+    {
+        return TimePoint{} + std::chrono::duration_cast<TimePoint::duration>(time);
+    }
+
+    int clamp_position(int position) const { return std::clamp(position, 0, m_max_position); }
+
+    void smooth_scroll(int delta, Duration duration, TimePoint now)
+    {
+        m_animation.scroll_by(
+            m_position, delta, true, duration, now, [this](int position) { return clamp_position(position); });
+    }
+
+    int render_frame(TimePoint now)
+    {
+        return m_animation.advance(now, [this](int position) { return m_position = clamp_position(position); });
+    }
+
+    int m_max_position{};
+    Duration m_frame_interval{};
+    int m_position{};
+    ScrollAnimation m_animation;
+    ScrollVelocityTracker m_velocity_tracker;
+};
+
+} // namespace uih::benchmarks
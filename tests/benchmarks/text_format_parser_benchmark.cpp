@@ -0,0 +1,50 @@
+#include <benchmark/benchmark.h>
+
+#include "text_format_parser.h"
+
+using namespace uih::text_style;
+
+namespace {
+
+constexpr std::array inputs{
+    L"font-weight: bold",
+    L"font-family: Segoe UI; font-size: 10.5",
+    L"font-family: Segoe UI Variable Text; font-size: 9; font-weight: 600; font-stretch: 87.5%; "
+    L"font-style: italic; text-decoration: underline",
+};
+
+void parse_uncached(benchmark::State& state)
+{
+    const std::wstring_view input = inputs[state.range(0)];
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(parse_format_properties_uncached(input));
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+void parse_cached(benchmark::State& state)
+{
+    const std::wstring_view input = inputs[state.range(0)];
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(parse_format_properties(input));
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+void intern(benchmark::State& state)
+{
+    const auto properties = parse_format_properties(inputs[state.range(0)]).value();
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(FormatPropertiesHandle(properties));
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(parse_uncached)->DenseRange(0, inputs.size() - 1);
+BENCHMARK(parse_cached)->DenseRange(0, inputs.size() - 1);
+BENCHMARK(intern)->DenseRange(0, inputs.size() - 1);
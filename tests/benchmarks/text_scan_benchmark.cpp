@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+
+#include "corpus.h"
+#include "text_scan.h"
+
+using namespace uih;
+
+namespace {
+
+const std::vector<std::wstring>& get_titles()
+{
+    static const auto titles = benchmarks::generate_titles();
+    return titles;
+}
+
+const std::vector<std::string>& get_utf8_titles()
+{
+    static const auto titles = benchmarks::to_utf8(get_titles());
+    return titles;
+}
+
+/** Finds all colour and font codes in each title, as when removing or processing them */
+template <class Char, class FindFirstOf>
+void scan_titles(benchmark::State& state, const std::vector<std::basic_string<Char>>& titles, FindFirstOf find_first_of)
+{
+    size_t character_count{};
+
+    for (auto&& title : titles)
+        character_count += title.size();
+
+    for (auto _ : state) {
+        size_t code_count{};
+
+        for (auto&& title : titles) {
+            const std::basic_string_view<Char> view(title);
+
+            for (auto index = find_first_of(view, 0); index != view.npos; index = find_first_of(view, index + 1))
+                ++code_count;
+        }
+
+        benchmark::DoNotOptimize(code_count);
+    }
+
+    state.SetItemsProcessed(state.iterations() * titles.size());
+    state.SetBytesProcessed(state.iterations() * character_count * sizeof(Char));
+}
+
+void find_codes_utf16_std(benchmark::State& state)
+{
+    scan_titles(state, get_titles(),
+        [](std::wstring_view text, size_t offset) { return text.find_first_of(L"\3\7", offset); });
+}
+
+void find_codes_utf16_text_scan(benchmark::State& state)
+{
+    scan_titles(state, get_titles(),
+        [](std::wstring_view text, size_t offset) { return text_scan::find_first_of(text, offset, L'\3', L'\7'); });
+}
+
+void find_codes_utf8_std(benchmark::State& state)
+{
+    scan_titles(state, get_utf8_titles(),
+        [](std::string_view text, size_t offset) { return text.find_first_of("\3\7", offset); });
+}
+
+void find_codes_utf8_text_scan(benchmark::State& state)
+{
+    scan_titles(state, get_utf8_titles(),
+        [](std::string_view text, size_t offset) { return text_scan::find_first_of(text, offset, '\3', '\7'); });
+}
+
+void find_line_breaks_utf16_std(benchmark::State& state)
+{
+    scan_titles(state, get_titles(),
+        [](std::wstring_view text, size_t offset) { return text.find_first_of(L"\r\n", offset); });
+}
+
+void find_line_breaks_utf16_text_scan(benchmark::State& state)
+{
+    scan_titles(state, get_titles(),
+        [](std::wstring_view text, size_t offset) { return text_scan::find_first_of(text, offset, L'\r', L'\n'); });
+}
+
+} // namespace
+
+BENCHMARK(find_codes_utf16_std);
+BENCHMARK(find_codes_utf16_text_scan);
+BENCHMARK(find_codes_utf8_std);
+BENCHMARK(find_codes_utf8_text_scan);
+BENCHMARK(find_line_breaks_utf16_std);
+BENCHMARK(find_line_breaks_utf16_text_scan);
@@ -0,0 +1,31 @@
+# Checks that tools/generate_emoji_table.py reproduces emoji_table.h from data
+# files written from the reference emoji properties.
+#
+# Expects WRITE_EMOJI_DATA, PYTHON, UIH_ROOT and WORK_DIR to be defined.
+
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+execute_process(
+    COMMAND ${WRITE_EMOJI_DATA} ${WORK_DIR}/emoji-data.txt ${WORK_DIR}/emoji-variation-sequences.txt
+    RESULT_VARIABLE result)
+
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "write_emoji_data failed: ${result}")
+endif()
+
+execute_process(
+    COMMAND ${PYTHON} ${UIH_ROOT}/tools/generate_emoji_table.py ${WORK_DIR}/emoji-data.txt
+        ${WORK_DIR}/emoji-variation-sequences.txt ${WORK_DIR}/emoji_table.h
+    RESULT_VARIABLE result)
+
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "generate_emoji_table.py failed: ${result}")
+endif()
+
+execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK_DIR}/emoji_table.h ${UIH_ROOT}/emoji_table.h
+    RESULT_VARIABLE result)
+
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "The generated emoji table differs from emoji_table.h")
+endif()
@@ -0,0 +1,237 @@
+#include <catch2/catch.hpp>
+
+#include "direct_write_cache.h"
+
+using namespace uih::direct_write;
+
+namespace {
+
+using Cache = TextLayoutCache<std::shared_ptr<int>>;
+
+Cache::CacheKeyView make_key(std::wstring_view text, float width = 100.f, uint32_t format_properties_id = 0)
+{
+    return {text, width, 20.f, true, DWRITE_TEXT_ALIGNMENT_LEADING, format_properties_id};
+}
+
+} // namespace
+
+TEST_CASE("TextLayoutCache returns cached values", "[TextLayoutCache]")
+{
+    Cache cache(4);
+
+    CHECK(!cache.get(make_key(L"a")));
+
+    cache.put_new(make_key(L"a"), std::make_shared<int>(1));
+    cache.put_new(make_key(L"b"), std::make_shared<int>(2));
+
+    REQUIRE(cache.get(make_key(L"a")));
+    CHECK(*cache.get(make_key(L"a")) == 1);
+    CHECK(*cache.get(make_key(L"b")) == 2);
+    CHECK(!cache.get(make_key(L"a", 50.f)));
+    CHECK(!cache.get(make_key(L"a", 100.f, 1)));
+
+    auto key = make_key(L"a");
+    key.alignment = DWRITE_TEXT_ALIGNMENT_CENTER;
+    CHECK(!cache.get(key));
+
+    key = make_key(L"a");
+    key.enable_ellipses = false;
+    CHECK(!cache.get(key));
+
+    key = make_key(L"a");
+    key.layout_variant = 1;
+    CHECK(!cache.get(key));
+}
+
+TEST_CASE("TextLayoutCache evicts the least recently used entry", "[TextLayoutCache]")
+{
+    Cache cache(3);
+
+    cache.put_new(make_key(L"a"), std::make_shared<int>(1));
+    cache.put_new(make_key(L"b"), std::make_shared<int>(2));
+    cache.put_new(make_key(L"c"), std::make_shared<int>(3));
+
+    CHECK(cache.get(make_key(L"a")));
+
+    cache.put_new(make_key(L"d"), std::make_shared<int>(4));
+
+    CHECK(cache.size() == 3);
+    CHECK(cache.contains(make_key(L"a")));
+    CHECK(!cache.contains(make_key(L"b")));
+    CHECK(cache.contains(make_key(L"c")));
+    CHECK(cache.contains(make_key(L"d")));
+    CHECK(cache.stats().evictions == 1);
+}
+
+TEST_CASE("TextLayoutCache with a size of zero is disabled", "[TextLayoutCache]")
+{
+    Cache cache(0);
+
+    cache.put(make_key(L"a"), std::make_shared<int>(1));
+
+    CHECK(!cache.get(make_key(L"a")));
+    CHECK(cache.size() == 0);
+}
+
+TEST_CASE("TextLayoutCache reuses entries with a different width", "[TextLayoutCache]")
+{
+    Cache cache(4);
+
+    cache.start_new_frame();
+    cache.put_new(make_key(L"a", 100.f), std::make_shared<int>(1));
+
+    // Entries used in the current frame are not taken over
+    CHECK(!cache.get_with_different_width(make_key(L"a", 120.f)));
+
+    cache.start_new_frame();
+
+    const auto value = cache.get_with_different_width(make_key(L"a", 120.f));
+
+    REQUIRE(value);
+    CHECK(*value == 1);
+    CHECK(cache.contains(make_key(L"a", 120.f)));
+    CHECK(!cache.contains(make_key(L"a", 100.f)));
+    CHECK(!cache.get_with_different_width(make_key(L"b", 120.f)));
+    CHECK(cache.stats().width_reuses == 1);
+}
+
+TEST_CASE("TextLayoutCache keeps the existing width if updating an entry fails", "[TextLayoutCache]")
+{
+    Cache cache(4);
+
+    cache.start_new_frame();
+    cache.put_new(make_key(L"a", 100.f), std::make_shared<int>(1));
+    cache.start_new_frame();
+
+    CHECK_THROWS_AS(cache.get_with_different_width(
+                        make_key(L"a", 120.f), [](const auto&) { throw std::runtime_error("Update failed"); }),
+        std::runtime_error);
+
+    CHECK(cache.contains(make_key(L"a", 100.f)));
+    CHECK(!cache.contains(make_key(L"a", 120.f)));
+    CHECK(cache.stats().width_reuses == 0);
+
+    const auto value = cache.get_with_different_width(
+        make_key(L"a", 120.f), [](const std::shared_ptr<int>& value) { *value = 2; });
+
+    REQUIRE(value);
+    CHECK(*value == 2);
+    CHECK(cache.contains(make_key(L"a", 120.f)));
+}
+
+TEST_CASE("TextLayoutCache doesn't evict entries used in the current frame for prefetched entries", "[TextLayoutCache]")
+{
+    Cache cache(3);
+
+    cache.start_new_frame();
+    cache.put_new(make_key(L"a"), std::make_shared<int>(1));
+    cache.put_new(make_key(L"b"), std::make_shared<int>(2));
+    cache.start_new_frame();
+
+    CHECK(cache.get(make_key(L"a")));
+    cache.put_new(make_key(L"c"), std::make_shared<int>(3));
+
+    // b wasn't used in the current frame, so can be evicted
+    CHECK(cache.put_without_evicting_current_frame(make_key(L"d"), std::make_shared<int>(4)));
+    CHECK(!cache.contains(make_key(L"b")));
+
+    CHECK(!cache.put_without_evicting_current_frame(make_key(L"e"), std::make_shared<int>(5)));
+    CHECK(!cache.put_without_evicting_current_frame(make_key(L"d"), std::make_shared<int>(4)));
+    CHECK(!cache.contains(make_key(L"e")));
+    CHECK(cache.contains(make_key(L"a")));
+    CHECK(cache.contains(make_key(L"c")));
+
+    cache.start_new_frame();
+
+    CHECK(cache.put_without_evicting_current_frame(make_key(L"e"), std::make_shared<int>(5)));
+    CHECK(cache.size() == 3);
+}
+
+TEST_CASE("TextLayoutCache grows when evicted keys are needed again", "[TextLayoutCache]")
+{
+    Cache cache(8);
+
+    // Cycle through a working set larger than the cache
+    for (auto pass = 0; pass < 8; ++pass) {
+        for (auto index = 0; index < 24; ++index) {
+            const auto text = std::to_wstring(index);
+
+            if (!cache.get(make_key(text)))
+                cache.put_new(make_key(text), std::make_shared<int>(index));
+        }
+    }
+
+    CHECK(cache.max_size() >= 24);
+    CHECK(cache.max_size() <= Cache::max_adaptive_size);
+    CHECK(cache.min_size() == 8);
+}
+
+TEST_CASE("TextLayoutCache capacity is at least the minimum size", "[TextLayoutCache]")
+{
+    Cache cache(4);
+
+    cache.set_min_size(16);
+    CHECK(cache.max_size() == 16);
+
+    cache.set_min_size(2);
+    CHECK(cache.min_size() == 4);
+}
+
+TEST_CASE("TextLayoutCache minimum size is the total needed by its users", "[TextLayoutCache]")
+{
+    Cache cache(4);
+    const int first_user{};
+    const int second_user{};
+
+    cache.set_min_size_for_user(&first_user, 16);
+    cache.set_min_size_for_user(&second_user, 8);
+    CHECK(cache.min_size() == 24);
+    CHECK(cache.max_size() == 24);
+
+    // Setting the size again replaces the user's previous size
+    cache.set_min_size_for_user(&first_user, 10);
+    CHECK(cache.min_size() == 18);
+
+    cache.set_min_size_for_user(&first_user, 0);
+    cache.set_min_size_for_user(&second_user, 0);
+    CHECK(cache.min_size() == 4);
+}
+
+TEST_CASE("TextLayoutCacheBudget evicts across caches", "[TextLayoutCache]")
+{
+    const auto budget = std::make_shared<TextLayoutCacheBudget>(std::numeric_limits<size_t>::max());
+    Cache first(16, budget);
+    Cache second(16, budget);
+
+    first.put_new(make_key(L"a"), std::make_shared<int>(1));
+    second.put_new(make_key(L"b"), std::make_shared<int>(2));
+    first.put_new(make_key(L"c"), std::make_shared<int>(3));
+
+    // Only leave room for two entries
+    budget->set_max_bytes(budget->used_bytes() * 2 / 3);
+
+    CHECK(!first.contains(make_key(L"a")));
+    CHECK(second.contains(make_key(L"b")));
+    CHECK(first.contains(make_key(L"c")));
+}
+
+TEST_CASE("GenerationalTextCache keeps recently used entries", "[GenerationalTextCache]")
+{
+    GenerationalTextCache<float> cache(4);
+
+    cache.put(L"a", 0, 1.f);
+    cache.put(L"b", 0, 2.f);
+
+    CHECK(cache.get(L"a", 0) == 1.f);
+    CHECK(!cache.get(L"a", 1));
+
+    // Fills the current generation, so that a and b move to the previous generation
+    cache.put(L"c", 0, 3.f);
+    cache.put(L"d", 0, 4.f);
+
+    // Moves a back to the current generation, so that c and d move to the previous generation and b is discarded
+    CHECK(cache.get(L"a", 0) == 1.f);
+    CHECK(!cache.get(L"b", 0));
+    CHECK(cache.get(L"c", 0) == 3.f);
+    CHECK(cache.size() == 3);
+}
@@ -1,8 +1,11 @@
-#include "stdafx.h"
+#include "emoji_reference.h"
 
-#include "emoji.h"
+/*
+ * The emoji properties used before emoji_table.h was generated from the
+ * Unicode data files, kept as a reference for the generated table.
+ */
 
-namespace uih::emoji {
+namespace uih::emoji::reference {
 
 const std::unordered_map<char32_t, EmojiProperties> emojis = {
     {U'\U00000023' /* # */, EmojiProperties{.has_variation = true, .component = true}},
@@ -1544,4 +1547,4 @@ const std::unordered_map<char32_t, EmojiProperties> emojis = {
     {U'\U000E007F' /* 󠁿 */, EmojiProperties{.emoji = false, .component = true}},
 };
 
-}
+} // namespace uih::emoji::reference
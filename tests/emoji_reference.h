@@ -0,0 +1,10 @@
+#pragma once
+
+#include "emoji.h"
+
+namespace uih::emoji::reference {
+
+/** Emoji properties of each code point that has any, as a map */
+extern const std::unordered_map<char32_t, EmojiProperties> emojis;
+
+} // namespace uih::emoji::reference
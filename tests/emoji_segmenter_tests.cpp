@@ -0,0 +1,122 @@
+#include <catch2/catch.hpp>
+
+#include "emoji_segmenter.h"
+
+using namespace uih::emoji;
+
+namespace {
+
+/** The type and length of a segment */
+struct SegmentSummary {
+    SegmentType type{};
+    size_t length{};
+};
+
+using Segments = std::vector<SegmentSummary>;
+
+Segments get_segments(std::u16string_view text)
+{
+    Segments segments;
+
+    for (size_t position{}; position < text.size();) {
+        const auto segment = get_next_segment(text, position);
+        segments.emplace_back(segment.type, segment.length);
+        position += segment.length;
+    }
+
+    return segments;
+}
+
+bool operator==(const SegmentSummary& left, const SegmentSummary& right)
+{
+    return left.type == right.type && left.length == right.length;
+}
+
+std::ostream& operator<<(std::ostream& stream, const SegmentSummary& segment)
+{
+    return stream << "{" << static_cast<int>(segment.type) << ", " << segment.length << "}";
+}
+
+constexpr size_t count_segments(std::u16string_view text)
+{
+    size_t count{};
+
+    for (size_t position{}; position < text.size(); ++count)
+        position += get_next_segment(text, position).length;
+
+    return count;
+}
+
+} // namespace
+
+TEST_CASE("get_next_segment returns text without emoji as one segment", "[emoji_segmenter]")
+{
+    CHECK(get_segments(u"Hello world 123") == Segments{{SegmentType::Text, 15}});
+    CHECK(get_segments(u"Café — 日本") == Segments{{SegmentType::Text, 9}});
+    STATIC_REQUIRE(count_segments(u"hello") == 1);
+}
+
+TEST_CASE("get_next_segment matches ZWJ sequences", "[emoji_segmenter]")
+{
+    // Family: man, woman, girl
+    CHECK(get_segments(u"\U0001F468‍\U0001F469‍\U0001F467") == Segments{{SegmentType::EmojiSequence, 8}});
+    CHECK(get_segments(u"a\U0001F468‍\U0001F469‍\U0001F467b")
+        == Segments{{SegmentType::Text, 1}, {SegmentType::EmojiSequence, 8}, {SegmentType::Text, 1}});
+
+    // Couple with heart, with modifiers and VS16
+    CHECK(get_segments(u"\U0001F9D1\U0001F3FB‍❤️‍\U0001F9D1\U0001F3FC")
+        == Segments{{SegmentType::EmojiSequence, 12}});
+
+    // A ZWJ that isn't followed by an emoji isn't part of a sequence
+    CHECK(get_segments(u"\U0001F469‍z") == Segments{{SegmentType::EmojiCharacter, 2}, {SegmentType::Text, 2}});
+}
+
+TEST_CASE("get_next_segment pairs regional indicators", "[emoji_segmenter]")
+{
+    // GB, US and an unpaired G
+    CHECK(get_segments(u"\U0001F1EC\U0001F1E7\U0001F1FA\U0001F1F8\U0001F1EC")
+        == Segments{
+            {SegmentType::EmojiSequence, 4}, {SegmentType::EmojiSequence, 4}, {SegmentType::EmojiCharacter, 2}});
+    CHECK(get_segments(u"\U0001F1EC\U0001F1E7\U0001F1EC")
+        == Segments{{SegmentType::EmojiSequence, 4}, {SegmentType::EmojiCharacter, 2}});
+}
+
+TEST_CASE("get_next_segment matches variation sequences", "[emoji_segmenter]")
+{
+    CHECK(get_segments(u"❤︎") == Segments{{SegmentType::TextPresentationSequence, 2}});
+    CHECK(get_segments(u"❤️") == Segments{{SegmentType::EmojiSequence, 2}});
+    CHECK(get_segments(u"❤") == Segments{{SegmentType::EmojiCharacter, 1}});
+    CHECK(get_segments(u"© ") == Segments{{SegmentType::EmojiCharacter, 1}, {SegmentType::Text, 1}});
+
+    // VS15 has no effect on an emoji without variations, but stays in its segment
+    CHECK(get_segments(u"\U0001F600︎\U0001F600")
+        == Segments{{SegmentType::EmojiCharacter, 3}, {SegmentType::EmojiCharacter, 2}});
+}
+
+TEST_CASE("get_next_segment matches keycap sequences", "[emoji_segmenter]")
+{
+    CHECK(get_segments(u"1️⃣") == Segments{{SegmentType::EmojiSequence, 3}});
+    CHECK(get_segments(u"#⃣") == Segments{{SegmentType::EmojiSequence, 2}});
+    CHECK(get_segments(u"1️⃣ #⃣")
+        == Segments{{SegmentType::EmojiSequence, 3}, {SegmentType::Text, 1}, {SegmentType::EmojiSequence, 2}});
+
+    // Keycap bases on their own are text
+    CHECK(get_segments(u"#1*") == Segments{{SegmentType::Text, 3}});
+}
+
+TEST_CASE("get_next_segment matches modifier and tag sequences", "[emoji_segmenter]")
+{
+    // Thumbs up with a medium skin tone
+    CHECK(get_segments(u"\U0001F44D\U0001F3FD ok")
+        == Segments{{SegmentType::EmojiSequence, 4}, {SegmentType::Text, 3}});
+
+    // Flag of England
+    CHECK(get_segments(u"\U0001F3F4\U000E0067\U000E0062\U000E0065\U000E006E\U000E0067\U000E007Fx")
+        == Segments{{SegmentType::EmojiSequence, 14}, {SegmentType::Text, 1}});
+}
+
+TEST_CASE("get_next_segment returns unpaired surrogates as text", "[emoji_segmenter]")
+{
+    const std::u16string text{char16_t{0xD83D}};
+    CHECK(get_segments(text) == Segments{{SegmentType::Text, 1}});
+}
@@ -0,0 +1,42 @@
+#include <catch2/catch.hpp>
+
+#include "emoji_reference.h"
+
+using namespace uih::emoji;
+
+namespace {
+
+bool operator==(const EmojiProperties& left, const EmojiProperties& right)
+{
+    return left.emoji == right.emoji && left.emoji_presentation == right.emoji_presentation
+        && left.has_variation == right.has_variation && left.component == right.component;
+}
+
+} // namespace
+
+TEST_CASE("get_emoji_properties agrees with the reference map for all code points", "[emoji]")
+{
+    size_t mismatch_count{};
+
+    for (char32_t code_point{}; code_point <= U'\U0010FFFF'; ++code_point) {
+        const auto properties = get_emoji_properties(code_point);
+        const auto iter = reference::emojis.find(code_point);
+        const auto expected
+            = iter != reference::emojis.end() ? std::make_optional(iter->second) : std::optional<EmojiProperties>();
+
+        if (properties.has_value() != expected.has_value() || (properties && !(*properties == *expected))) {
+            ++mismatch_count;
+            UNSCOPED_INFO("U+" << std::hex << std::uppercase << static_cast<uint32_t>(code_point));
+        }
+    }
+
+    CHECK(mismatch_count == 0);
+}
+
+TEST_CASE("get_emoji_properties can be evaluated at compile time", "[emoji]")
+{
+    STATIC_REQUIRE(get_emoji_properties(U'\U0001F600')->emoji_presentation);
+    STATIC_REQUIRE(get_emoji_properties(U'#')->component);
+    STATIC_REQUIRE(!get_emoji_properties(U'a'));
+    STATIC_REQUIRE(!get_emoji_properties(U'\U0010FFFF'));
+}
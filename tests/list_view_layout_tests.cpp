@@ -0,0 +1,342 @@
+#include <catch2/catch.hpp>
+
+#include "list_view/list_view_layout.h"
+
+#include "benchmarks/list_view_model.h"
+
+using namespace uih;
+using namespace uih::benchmarks;
+
+namespace {
+
+constexpr int item_height = 20;
+constexpr int group_height = 25;
+constexpr int columns_width = 300;
+
+lv::LayoutMetrics make_metrics(size_t visible_group_count = 0)
+{
+    return {.item_height = item_height,
+        .group_height = group_height,
+        .visible_group_count = visible_group_count,
+        .root_group_indentation_amount = 4,
+        .indentation_step = 10,
+        .total_indentation = visible_group_count > 0 ? 4 + 10 * static_cast<int>(visible_group_count) : 0,
+        .columns_display_width = columns_width};
+}
+
+ListViewModel make_ungrouped_items(size_t count)
+{
+    ListViewModel model;
+
+    for (size_t index{}; index < count; ++index)
+        model.add_item({}, item_height);
+
+    return model;
+}
+
+/** Two groups of ten items each, in a single level */
+ListViewModel make_two_groups()
+{
+    ListViewModel model{.group_count = 1};
+
+    for (const auto group : {model.add_group(), model.add_group()})
+        for (auto index = 0; index < 10; ++index)
+            model.add_item({group}, item_height);
+
+    return model;
+}
+
+std::vector<lv::DisplayListEntryType> get_entry_types(const lv::DisplayList& display_list)
+{
+    std::vector<lv::DisplayListEntryType> types;
+
+    for (auto&& entry : display_list.entries)
+        types.emplace_back(entry.type);
+
+    return types;
+}
+
+bool rects_equal(const RECT& left, const RECT& right)
+{
+    return left.left == right.left && left.top == right.top && left.right == right.right
+        && left.bottom == right.bottom;
+}
+
+} // namespace
+
+TEST_CASE("ItemsLayout positions ungrouped items one after another", "[ItemsLayout]")
+{
+    auto model = make_ungrouped_items(10);
+    const auto layout = make_layout(model, make_metrics());
+
+    CHECK(model.positions == std::vector{0, 20, 40, 60, 80, 100, 120, 140, 160, 180});
+
+    const auto on_item = layout.vertical_hit_test(45);
+    CHECK(on_item.position_category == lv::VerticalPositionCategory::OnItem);
+    CHECK(on_item.item_leftmost == 2);
+
+    const auto after_items = layout.vertical_hit_test(500);
+    CHECK(after_items.position_category == lv::VerticalPositionCategory::BetweenItems);
+    CHECK(after_items.item_leftmost == 9);
+    CHECK(after_items.item_rightmost == 10);
+
+    ListViewModel empty_model;
+    CHECK(make_layout(empty_model, make_metrics()).vertical_hit_test(0).position_category
+        == lv::VerticalPositionCategory::NoItems);
+}
+
+TEST_CASE("ItemsLayout positions group headers above the first item of each group", "[ItemsLayout]")
+{
+    ListViewModel model{.group_count = 2};
+    const auto artist_a = model.add_group();
+    const auto album_a = model.add_group();
+    const auto album_b = model.add_group();
+    const auto artist_b = model.add_group();
+    const auto album_c = model.add_group();
+
+    model.add_item({artist_a, album_a}, item_height);
+    model.add_item({artist_a, album_a}, item_height);
+    model.add_item({artist_a, album_b}, item_height);
+    model.add_item({artist_b, album_c}, item_height);
+
+    const auto layout = make_layout(model, make_metrics(2));
+
+    CHECK(model.positions == std::vector{50, 70, 115, 185});
+    CHECK(layout.get_item_position(2, true) == 90);
+    CHECK(std::get<0>(lv::get_group_range(ListViewModelItems(model), 1, 0)) == 0);
+    CHECK(std::get<1>(lv::get_group_range(ListViewModelItems(model), 1, 0)) == 3);
+
+    const auto on_artist_header = layout.vertical_hit_test(10);
+    CHECK(on_artist_header.position_category == lv::VerticalPositionCategory::OnGroupHeader);
+    CHECK(on_artist_header.item_leftmost == 0);
+    CHECK(on_artist_header.group_index == 0);
+
+    const auto on_album_header = layout.vertical_hit_test(100);
+    CHECK(on_album_header.position_category == lv::VerticalPositionCategory::OnGroupHeader);
+    CHECK(on_album_header.item_leftmost == 2);
+    CHECK(on_album_header.group_index == 1);
+
+    const auto display_list = layout.build_display_list({0, 0, 400, 300}, {0, 0, 400, 300}, 0);
+
+    using enum lv::DisplayListEntryType;
+    CHECK(get_entry_types(display_list)
+        == std::vector{GroupHeader, GroupHeader, Item, Item, GroupHeader, Item, GroupHeader, GroupHeader, Item});
+
+    const auto& album_b_header = display_list.entries[4];
+    CHECK(album_b_header.item_index == 2);
+    CHECK(album_b_header.group_index == 1);
+    CHECK(album_b_header.indentation == 14);
+    CHECK(rects_equal(album_b_header.rect, {0, 90, 24 + columns_width, 115}));
+
+    const auto& last_item = display_list.entries.back();
+    CHECK(last_item.item_index == 3);
+    CHECK(rects_equal(last_item.rect, {24, 185, 24 + columns_width, 205}));
+}
+
+TEST_CASE("ItemsLayout skips hidden group headers", "[ItemsLayout]")
+{
+    ListViewModel model{.group_count = 2};
+    const auto hidden_group = model.add_group(true);
+    const auto album_a = model.add_group();
+    const auto album_b = model.add_group();
+
+    model.add_item({hidden_group, album_a}, item_height);
+    model.add_item({hidden_group, album_b}, item_height);
+
+    const auto layout = make_layout(model, make_metrics(1));
+
+    CHECK(model.positions == std::vector{25, 70});
+
+    const auto hit_test_result = layout.vertical_hit_test(50);
+    CHECK(hit_test_result.position_category == lv::VerticalPositionCategory::OnGroupHeader);
+    CHECK(hit_test_result.item_leftmost == 1);
+    CHECK(hit_test_result.group_index == 1);
+
+    const auto display_list = layout.build_display_list({0, 0, 400, 300}, {0, 0, 400, 300}, 0);
+
+    using enum lv::DisplayListEntryType;
+    CHECK(get_entry_types(display_list) == std::vector{GroupHeader, Item, GroupHeader, Item});
+    CHECK(display_list.entries[0].group_index == 1);
+    CHECK(display_list.entries[0].indentation == 4);
+}
+
+TEST_CASE("ItemsLayout only includes entries in the painted area", "[ItemsLayout]")
+{
+    auto model = make_ungrouped_items(100);
+    const auto layout = make_layout(model, make_metrics());
+    const RECT items_rect{0, 30, 400, 130};
+
+    const auto display_list = layout.build_display_list(items_rect, items_rect, 50);
+
+    REQUIRE(display_list.entries.size() == 6);
+    CHECK(display_list.entries.front().item_index == 2);
+    CHECK(rects_equal(display_list.entries.front().rect, {0, 20, columns_width, 40}));
+    CHECK(display_list.entries.back().item_index == 7);
+
+    const auto partial_display_list = layout.build_display_list(items_rect, {0, 85, 400, 95}, 50);
+
+    REQUIRE(partial_display_list.entries.size() == 1);
+    CHECK(partial_display_list.entries[0].item_index == 5);
+
+    CHECK(layout.build_display_list(items_rect, {0, 30, 400, 30}, 50).entries.empty());
+}
+
+TEST_CASE("ItemsLayout sticks group headers to the top of the viewport", "[ItemsLayout]")
+{
+    auto model = make_two_groups();
+    auto metrics = make_metrics(1);
+    metrics.sticky_group_headers = true;
+    const auto layout = make_layout(model, metrics);
+
+    CHECK(model.positions[10] == 250);
+
+    const auto stuck_header = layout.get_group_header_render_info(5, 0, 100);
+    CHECK(stuck_header.is_stuck);
+    CHECK(stuck_header.items_viewport_y == 0);
+    CHECK(layout.get_stuck_group_headers_height(100) == group_height);
+
+    // The next group's header pushes the stuck header up
+    const auto pushed_header = layout.get_group_header_render_info(9, 0, 210);
+    CHECK(pushed_header.is_stuck);
+    CHECK(pushed_header.items_viewport_y == -10);
+
+    CHECK(!layout.get_group_header_render_info(0, 0, 0).is_stuck);
+    CHECK(layout.get_stuck_group_headers_height(0) == 0);
+
+    const RECT items_rect{0, 0, 400, 100};
+    const auto display_list = layout.build_display_list(items_rect, {0, 1, 400, 100}, 100);
+
+    REQUIRE(!display_list.entries.empty());
+    const auto& header = display_list.entries.front();
+    CHECK(header.type == lv::DisplayListEntryType::GroupHeader);
+    CHECK(header.rect.top == 0);
+    REQUIRE(header.exclude_rect_after);
+    CHECK(rects_equal(*header.exclude_rect_after, header.rect));
+
+    CHECK(display_list.stuck_headers_height == group_height);
+    CHECK(std::ranges::count_if(display_list.entries, [](auto&& entry) { return entry.exclude_stuck_headers; }) == 1);
+
+    const auto first_unobscured_entry = std::ranges::find_if(
+        display_list.entries, [](auto&& entry) { return entry.exclude_stuck_headers; });
+    CHECK(first_unobscured_entry->item_index == 5);
+}
+
+TEST_CASE("ItemsLayout leaves room for group info areas", "[ItemsLayout]")
+{
+    ListViewModel model{.group_count = 1};
+
+    for (const auto group : {model.add_group(), model.add_group()})
+        for (auto index = 0; index < 2; ++index)
+            model.add_item({group}, item_height);
+
+    auto metrics = make_metrics(1);
+    metrics.show_group_info_area = true;
+    metrics.group_info_area_width = 50;
+    metrics.group_info_area_height = 60;
+    metrics.group_info_area_padding = {5, 0, 5, 10};
+    metrics.group_minimum_inner_height = 70;
+
+    const auto layout = make_layout(model, metrics);
+
+    CHECK(model.positions == std::vector{25, 45, 120, 140});
+    CHECK(layout.get_item_group_bottom(0) == 94);
+
+    const auto rect = layout.get_item_group_info_area_render_rect(0, {0, 0, 400, 300}, 0);
+    // Indented by the root indentation and the left padding
+    CHECK(rects_equal(rect, {9, 25, 59, 85}));
+
+    const auto display_list = layout.build_display_list({0, 0, 400, 300}, {0, 0, 400, 300}, 0);
+
+    using enum lv::DisplayListEntryType;
+    CHECK(get_entry_types(display_list)
+        == std::vector{GroupHeader, GroupInfo, Item, Item, GroupHeader, GroupInfo, Item, Item});
+}
+
+TEST_CASE("ItemsLayout recalculates positions from a group boundary", "[ItemsLayout]")
+{
+    auto model = make_two_groups();
+    auto layout = make_layout(model, make_metrics(1));
+    const auto positions = model.positions;
+
+    std::ranges::fill(model.positions, 0);
+    layout.calculate_item_positions(0, [&model](size_t index, int position) { model.positions[index] = position; });
+    CHECK(model.positions == positions);
+
+    // Starting part-way through a group starts from the start of that group
+    std::vector<size_t> updated_indices;
+    layout.calculate_item_positions(15, [&](size_t index, int position) {
+        updated_indices.emplace_back(index);
+        CHECK(position == positions[index]);
+    });
+
+    CHECK(updated_indices.front() == 10);
+    CHECK(updated_indices.size() == 10);
+}
+
+TEST_CASE("ItemsLayout includes the insert mark", "[ItemsLayout]")
+{
+    auto model = make_ungrouped_items(3);
+    auto metrics = make_metrics();
+    metrics.insert_mark_height = 2;
+
+    SECTION("before an item")
+    {
+        metrics.insert_mark_index = 1;
+        const auto display_list
+            = make_layout(model, metrics).build_display_list({0, 10, 400, 110}, {0, 10, 400, 110}, 0);
+
+        REQUIRE(display_list.entries.back().type == lv::DisplayListEntryType::InsertMark);
+        CHECK(rects_equal(display_list.entries.back().rect, {0, 29, columns_width, 31}));
+    }
+
+    SECTION("after the last item")
+    {
+        metrics.insert_mark_index = 3;
+        const auto display_list
+            = make_layout(model, metrics).build_display_list({0, 10, 400, 110}, {0, 10, 400, 110}, 0);
+
+        REQUIRE(display_list.entries.back().type == lv::DisplayListEntryType::InsertMark);
+        CHECK(rects_equal(display_list.entries.back().rect, {0, 69, columns_width, 71}));
+    }
+
+    SECTION("past the end")
+    {
+        metrics.insert_mark_index = 4;
+        const auto display_list
+            = make_layout(model, metrics).build_display_list({0, 10, 400, 110}, {0, 10, 400, 110}, 0);
+
+        CHECK(display_list.entries.back().type == lv::DisplayListEntryType::Item);
+    }
+}
+
+TEST_CASE("ItemsLayout display lists of a large library cover the viewport", "[ItemsLayout]")
+{
+    auto model = generate_library(100'000, item_height);
+    auto metrics = make_metrics(2);
+    metrics.sticky_group_headers = true;
+    const auto layout = make_layout(model, metrics);
+
+    const auto total_height = layout.get_item_group_bottom(model.heights.size() - 1) + 1;
+    const RECT items_rect{0, 0, 400, 600};
+
+    for (const auto scroll_position : {0, 12'345, total_height / 2, total_height - 600}) {
+        const auto display_list = layout.build_display_list(items_rect, {0, 1, 400, 600}, scroll_position);
+
+        std::optional<size_t> previous_item_index;
+        int covered_bottom{};
+
+        for (auto&& entry : display_list.entries) {
+            covered_bottom = std::max(covered_bottom, static_cast<int>(entry.rect.bottom));
+
+            if (entry.type != lv::DisplayListEntryType::Item)
+                continue;
+
+            if (previous_item_index)
+                CHECK(entry.item_index == *previous_item_index + 1);
+
+            previous_item_index = entry.item_index;
+        }
+
+        CHECK(covered_bottom >= 600);
+    }
+}
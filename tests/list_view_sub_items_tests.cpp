@@ -0,0 +1,100 @@
+#include <catch2/catch.hpp>
+
+#include "list_view/list_view_sub_items.h"
+
+using namespace uih;
+
+namespace {
+
+using SubItems = lv::SubItems<std::string>;
+
+/** Converts ASCII text, counting the number of conversions */
+class CountingConverter {
+public:
+    std::wstring operator()(const std::string& text)
+    {
+        ++m_count;
+        return {text.begin(), text.end()};
+    }
+
+    size_t count() const { return m_count; }
+
+private:
+    size_t m_count{};
+};
+
+} // namespace
+
+TEST_CASE("SubItems creates UTF-16 copies once", "[SubItems]")
+{
+    SubItems sub_items;
+    sub_items.set({"Artist", "Title"});
+
+    CountingConverter converter;
+
+    CHECK(sub_items.get_utf16(1, std::ref(converter)) == L"Title");
+    CHECK(sub_items.get_utf16(1, std::ref(converter)) == L"Title");
+    CHECK(converter.count() == 1);
+
+    CHECK(sub_items.get_utf16(0, std::ref(converter)) == L"Artist");
+    CHECK(converter.count() == 2);
+}
+
+TEST_CASE("SubItems discards UTF-16 copies when the text is set", "[SubItems]")
+{
+    SubItems sub_items;
+    sub_items.set({"Artist", "Title"});
+
+    CountingConverter converter;
+    CHECK(sub_items.get_utf16(0, std::ref(converter)) == L"Artist");
+
+    sub_items.set({"Other artist", "Other title"});
+
+    CHECK(sub_items.get_utf16(0, std::ref(converter)) == L"Other artist");
+    CHECK(converter.count() == 2);
+}
+
+TEST_CASE("SubItems discards UTF-16 copies when the text is retrieved for updating", "[SubItems]")
+{
+    SubItems sub_items;
+    sub_items.set({"Artist", "Title"});
+
+    CountingConverter converter;
+    CHECK(sub_items.get_utf16(1, std::ref(converter)) == L"Title");
+
+    sub_items.get_for_update()[1] = "New title";
+
+    CHECK(sub_items.get_utf16(1, std::ref(converter)) == L"New title");
+    CHECK(converter.count() == 2);
+}
+
+TEST_CASE("SubItems handles a change in the number of sub-items", "[SubItems]")
+{
+    SubItems sub_items;
+    sub_items.set({"Artist"});
+
+    CountingConverter converter;
+    CHECK(sub_items.get_utf16(0, std::ref(converter)) == L"Artist");
+
+    // For example, when a column is added
+    sub_items.get_for_update().emplace_back("Title");
+
+    CHECK(sub_items.get_utf16(1, std::ref(converter)) == L"Title");
+    CHECK(sub_items.get_utf16(0, std::ref(converter)) == L"Artist");
+    CHECK(converter.count() == 3);
+}
+
+TEST_CASE("SubItems recreates UTF-16 copies after they're cleared", "[SubItems]")
+{
+    SubItems sub_items;
+    sub_items.set({"Artist", "Title"});
+
+    CountingConverter converter;
+    CHECK(sub_items.get_utf16(0, std::ref(converter)) == L"Artist");
+
+    sub_items.clear_utf16();
+
+    CHECK(sub_items.get().size() == 2);
+    CHECK(sub_items.get_utf16(0, std::ref(converter)) == L"Artist");
+    CHECK(converter.count() == 2);
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+/*
+ * Stands in for stdafx.h when building the platform-independent parts of the
+ * library for tests and benchmarks.
+ *
+ * stdafx.h's include guard is defined here, so that library source files that
+ * include stdafx.h get this instead.
+ */
+
+#define _UI_HELPERS_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <bitset>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <set>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#ifdef _WIN32
+
+#include <format>
+
+#include <windows.h>
+#include <dwrite_3.h>
+
+#else
+
+enum DWRITE_TEXT_ALIGNMENT {
+    DWRITE_TEXT_ALIGNMENT_LEADING,
+    DWRITE_TEXT_ALIGNMENT_TRAILING,
+    DWRITE_TEXT_ALIGNMENT_CENTER,
+    DWRITE_TEXT_ALIGNMENT_JUSTIFIED,
+};
+
+enum DWRITE_FONT_WEIGHT {
+    DWRITE_FONT_WEIGHT_THIN = 100,
+    DWRITE_FONT_WEIGHT_NORMAL = 400,
+    DWRITE_FONT_WEIGHT_BOLD = 700,
+    DWRITE_FONT_WEIGHT_ULTRA_BLACK = 950,
+};
+
+enum DWRITE_FONT_STRETCH {
+    DWRITE_FONT_STRETCH_UNDEFINED,
+    DWRITE_FONT_STRETCH_ULTRA_CONDENSED,
+    DWRITE_FONT_STRETCH_EXTRA_CONDENSED,
+    DWRITE_FONT_STRETCH_CONDENSED,
+    DWRITE_FONT_STRETCH_SEMI_CONDENSED,
+    DWRITE_FONT_STRETCH_NORMAL,
+    DWRITE_FONT_STRETCH_SEMI_EXPANDED,
+    DWRITE_FONT_STRETCH_EXPANDED,
+    DWRITE_FONT_STRETCH_EXTRA_EXPANDED,
+    DWRITE_FONT_STRETCH_ULTRA_EXPANDED,
+};
+
+enum DWRITE_FONT_STYLE {
+    DWRITE_FONT_STYLE_NORMAL,
+    DWRITE_FONT_STYLE_OBLIQUE,
+    DWRITE_FONT_STYLE_ITALIC,
+};
+
+struct RECT {
+    long left;
+    long top;
+    long right;
+    long bottom;
+};
+
+#endif
+
+#if __has_include(<gsl/gsl>)
+#include <gsl/gsl>
+#else
+namespace gsl {
+
+template <class T, class U>
+constexpr T narrow(U value)
+{
+    const auto narrowed = static_cast<T>(value);
+
+    if (static_cast<U>(narrowed) != value)
+        throw std::runtime_error("gsl::narrow");
+
+    return narrowed;
+}
+
+} // namespace gsl
+#endif
@@ -0,0 +1,314 @@
+#include <catch2/catch.hpp>
+
+#include "scroll_animation.h"
+
+#include "benchmarks/scroll_simulation.h"
+
+using namespace uih;
+using namespace std::chrono_literals;
+
+using benchmarks::ScrollEvent;
+using benchmarks::ScrollSimulation;
+using Duration = ScrollAnimation::Duration;
+using TimePoint = ScrollAnimation::TimePoint;
+
+namespace {
+
+constexpr auto clamp_to_large_range = [](int position) { return std::clamp(position, -100'000, 100'000); };
+
+/** Mouse wheel notches of 120 pixels at a fixed interval */
+std::vector<ScrollEvent> make_wheel_trace(size_t count, Duration interval, int delta = 120)
+{
+    std::vector<ScrollEvent> events;
+
+    for (size_t index{}; index < count; ++index)
+        events.emplace_back(interval * static_cast<double>(index), delta);
+
+    return events;
+}
+
+bool is_monotonic(const std::vector<int>& positions)
+{
+    return std::ranges::is_sorted(positions) || std::ranges::is_sorted(positions, std::ranges::greater{});
+}
+
+} // namespace
+
+TEST_CASE("ScrollAnimation eases out to the target", "[ScrollAnimation]")
+{
+    ScrollAnimation animation;
+    const TimePoint start{};
+
+    CHECK(!animation.is_active());
+
+    animation.start(0, 100, Duration(250.), start);
+
+    REQUIRE(animation.is_active());
+    CHECK(animation.target_position() == 100);
+
+    std::vector<int> positions;
+
+    for (auto time = start + 16ms;; time += 16ms) {
+        const auto frame = animation.get_frame(time);
+        positions.emplace_back(frame.position);
+
+        if (frame.is_final)
+            break;
+    }
+
+    CHECK(positions == std::vector{26, 41, 53, 64, 73, 80, 86, 91, 94, 96, 98, 99, 100});
+}
+
+TEST_CASE("ScrollAnimation moves on the first frame", "[ScrollAnimation]")
+{
+    ScrollAnimation animation;
+    const TimePoint start{};
+
+    animation.start(0, 100, Duration(250.), start);
+
+    CHECK(animation.get_frame(start).position > 0);
+    CHECK(!animation.get_frame(start).is_final);
+    CHECK(animation.get_frame(start + 1s).position == 100);
+    CHECK(animation.get_frame(start + 1s).is_final);
+}
+
+TEST_CASE("ScrollAnimation replays a single wheel notch", "[ScrollAnimation]")
+{
+    ScrollSimulation simulation(10'000);
+    const auto positions = simulation.replay_smooth_scrolls(make_wheel_trace(1, {}));
+
+    CHECK(positions == std::vector{11, 32, 50, 66, 79, 89, 98, 105, 110, 114, 117, 118, 119, 120});
+}
+
+TEST_CASE("ScrollAnimation accumulates a spinning wheel at a steady speed", "[ScrollAnimation]")
+{
+    ScrollSimulation simulation(10'000);
+    const auto trace = make_wheel_trace(8, Duration(40.));
+    const auto positions = simulation.replay_smooth_scrolls(trace);
+
+    CHECK(positions
+        == std::vector{11, 32, 50, 65, 91, 131, 163, 194, 246, 281, 334, 372, 409, 465, 505, 560, 601, 657, 698, 740,
+            781, 823, 864, 906, 948, 960});
+    CHECK(simulation.position() == 960);
+
+    // The animation finishes half of the duration after the last notch
+    const auto finish_time = ScrollSimulation::default_frame_interval * static_cast<double>(positions.size() - 1);
+    CHECK(finish_time >= trace.back().time + Duration(125.));
+    CHECK(finish_time < trace.back().time + Duration(125.) + ScrollSimulation::default_frame_interval);
+}
+
+TEST_CASE("ScrollAnimation starts a new animation for separate wheel notches", "[ScrollAnimation]")
+{
+    ScrollSimulation simulation(10'000);
+    const auto positions = simulation.replay_smooth_scrolls(make_wheel_trace(3, Duration(300.)));
+
+    CHECK(positions
+        == std::vector{11, 32, 50, 66, 79, 89, 98, 105, 110, 114, 117, 118, 119, 120, 131, 152, 170, 186, 199, 209, 218,
+            225, 230, 234, 237, 238, 239, 240, 251, 272, 290, 306, 319, 329, 338, 345, 350, 354, 357, 358, 359, 360});
+    CHECK(is_monotonic(positions));
+}
+
+TEST_CASE("ScrollAnimation changes direction when the wheel is reversed", "[ScrollAnimation]")
+{
+    ScrollSimulation simulation(10'000);
+    const std::vector<ScrollEvent> trace{{Duration(0.), 120}, {Duration(40.), 120}, {Duration(80.), -120}};
+    const auto positions = simulation.replay_smooth_scrolls(trace);
+
+    CHECK(positions == std::vector{11, 32, 50, 65, 91, 92, 96, 100, 103, 107, 111, 115, 119, 120});
+    CHECK(simulation.position() == 120);
+}
+
+TEST_CASE("ScrollAnimation stops at the end of the scrollable range", "[ScrollAnimation]")
+{
+    ScrollSimulation simulation(300);
+    const auto positions = simulation.replay_smooth_scrolls(make_wheel_trace(8, Duration(40.)));
+
+    CHECK(positions == std::vector{11, 32, 50, 65, 91, 131, 163, 194, 246, 281, 300, 300, 300, 300});
+    CHECK(std::ranges::max(positions) == 300);
+}
+
+TEST_CASE("ScrollAnimation::scroll_by clamps new animations and accumulates into active ones", "[ScrollAnimation]")
+{
+    ScrollAnimation animation;
+    const TimePoint start{};
+    const auto clamp_position = [](int position) { return std::clamp(position, 0, 1'000); };
+
+    animation.scroll_by(900, 500, true, 250ms, start, clamp_position);
+    CHECK(animation.target_position() == 1'000);
+
+    animation.scroll_by(900, -120, true, 250ms, start + 10ms, clamp_position);
+    CHECK(animation.target_position() == 880);
+
+    // Without accumulating, the animation is replaced
+    animation.scroll_by(500, 120, false, 250ms, start + 20ms, clamp_position);
+    CHECK(animation.target_position() == 620);
+}
+
+TEST_CASE("ScrollAnimation::advance ends the animation after the final frame", "[ScrollAnimation]")
+{
+    ScrollAnimation animation;
+    const TimePoint start{};
+    int position{};
+    const auto apply_position = [&position](int new_position) { return position = new_position; };
+
+    animation.start(0, 120, 250ms, start);
+
+    CHECK(animation.advance(start + 100ms, apply_position) == position);
+    CHECK(animation.is_active());
+
+    CHECK(animation.advance(start + 300ms, apply_position) == 120);
+    CHECK(!animation.is_active());
+}
+
+TEST_CASE("ScrollAnimation::advance ends the animation if the position isn't applied", "[ScrollAnimation]")
+{
+    ScrollAnimation animation;
+    const TimePoint start{};
+
+    animation.start(0, 1'000, 250ms, start);
+
+    // For example, if items were removed during the animation
+    CHECK(animation.advance(start + 100ms, [](int position) { return std::min(position, 10); }) == 10);
+    CHECK(!animation.is_active());
+}
+
+TEST_CASE("ScrollAnimation kinetic scrolling decelerates to a stop", "[ScrollAnimation]")
+{
+    ScrollAnimation animation;
+    const TimePoint start{};
+
+    REQUIRE(animation.start_kinetic(0, 2., start, clamp_to_large_range));
+
+    // The distance is the integral of the velocity until it drops below the minimum
+    const auto expected_distance = 2. * ScrollAnimation::kinetic_time_constant.count()
+        * (1. - ScrollAnimation::kinetic_min_velocity / 2.);
+    CHECK(animation.target_position() == static_cast<int>(std::round(expected_distance)));
+
+    std::vector<int> steps;
+    auto previous_position = 0;
+
+    for (auto time = start + 16ms;; time += 16ms) {
+        const auto frame = animation.get_frame(time);
+        steps.emplace_back(frame.position - previous_position);
+        previous_position = frame.position;
+
+        if (frame.is_final)
+            break;
+    }
+
+    CHECK(previous_position == animation.target_position());
+    CHECK(std::ranges::all_of(steps, [](int step) { return step >= 0; }));
+
+    // The second frame (from 24 to 40 ms into the animation, as the first
+    // frame is 8 ms ahead) moves at the velocity halfway through it
+    const auto velocity = 2. * std::exp(-32. / ScrollAnimation::kinetic_time_constant.count());
+    CHECK(steps[1] == Approx(velocity * 16.).margin(1.));
+    CHECK(steps[1] > steps[steps.size() / 2]);
+    CHECK(steps[steps.size() / 2] >= steps.back());
+}
+
+TEST_CASE("ScrollAnimation kinetic scrolling works in both directions", "[ScrollAnimation]")
+{
+    ScrollAnimation forwards;
+    ScrollAnimation backwards;
+
+    REQUIRE(forwards.start_kinetic(1'000, 1.5, {}, clamp_to_large_range));
+    REQUIRE(backwards.start_kinetic(1'000, -1.5, {}, clamp_to_large_range));
+
+    CHECK(forwards.target_position() - 1'000 == 1'000 - backwards.target_position());
+    CHECK(backwards.get_frame(TimePoint{} + 100ms).position < 1'000);
+}
+
+TEST_CASE("ScrollAnimation kinetic scrolling needs a minimum velocity", "[ScrollAnimation]")
+{
+    ScrollAnimation animation;
+
+    CHECK(!animation.start_kinetic(0, 0., {}, clamp_to_large_range));
+    CHECK(!animation.start_kinetic(0, ScrollAnimation::kinetic_min_velocity, {}, clamp_to_large_range));
+    CHECK(!animation.is_active());
+
+    // Nothing to do at the end of the range
+    CHECK(!animation.start_kinetic(0, -2., {}, [](int position) { return std::max(position, 0); }));
+}
+
+TEST_CASE("ScrollVelocityTracker estimates the velocity of recent deltas", "[ScrollVelocityTracker]")
+{
+    ScrollVelocityTracker tracker;
+    TimePoint time{};
+
+    CHECK(tracker.get_velocity(time) == 0.);
+
+    tracker.add_delta(20, time);
+    CHECK(tracker.get_velocity(time) == 0.);
+
+    for (auto index = 0; index < 5; ++index) {
+        time += 10ms;
+        tracker.add_delta(20, time);
+    }
+
+    CHECK(tracker.get_velocity(time) == Approx(2.));
+
+    // Only the most recent samples are used
+    for (auto index = 0; index < 10; ++index) {
+        time += 10ms;
+        tracker.add_delta(40, time);
+    }
+
+    CHECK(tracker.get_velocity(time) == Approx(4.));
+
+    // The velocity is zero if there haven't been any recent deltas
+    CHECK(tracker.get_velocity(time + 150ms) == 0.);
+}
+
+TEST_CASE("ScrollVelocityTracker starts again after a pause or a change of direction", "[ScrollVelocityTracker]")
+{
+    ScrollVelocityTracker tracker;
+    TimePoint time{};
+
+    tracker.add_delta(20, time);
+    tracker.add_delta(20, time += 10ms);
+    tracker.add_delta(-10, time += 10ms);
+    tracker.add_delta(-10, time += 10ms);
+
+    CHECK(tracker.get_velocity(time) == Approx(-1.));
+
+    tracker.add_delta(-50, time += 200ms);
+    tracker.add_delta(-30, time += 10ms);
+
+    CHECK(tracker.get_velocity(time) == Approx(-3.));
+}
+
+TEST_CASE("start_kinetic_scroll continues a flick", "[ScrollAnimation]")
+{
+    ScrollSimulation simulation(100'000);
+    const auto positions = simulation.replay_flick(make_wheel_trace(6, Duration(10.), 20));
+
+    REQUIRE(!positions.empty());
+    CHECK(positions.front() > 120);
+    CHECK(simulation.position() == 764);
+    CHECK(std::ranges::is_sorted(positions));
+}
+
+TEST_CASE("start_kinetic_scroll stops at the end of the scrollable range", "[ScrollAnimation]")
+{
+    ScrollSimulation simulation(300);
+    const auto positions = simulation.replay_flick(make_wheel_trace(6, Duration(10.), 20));
+
+    REQUIRE(!positions.empty());
+    CHECK(positions.back() == 300);
+    CHECK(std::ranges::is_sorted(positions));
+}
+
+TEST_CASE("start_kinetic_scroll resets the velocity tracker", "[ScrollAnimation]")
+{
+    ScrollAnimation animation;
+    ScrollVelocityTracker tracker;
+    TimePoint time{};
+
+    tracker.add_delta(20, time);
+    tracker.add_delta(20, time += 10ms);
+
+    CHECK(start_kinetic_scroll(animation, tracker, 0, time, clamp_to_large_range));
+    CHECK(tracker.get_velocity(time) == 0.);
+    CHECK(!start_kinetic_scroll(animation, tracker, 0, time, clamp_to_large_range));
+}
@@ -0,0 +1,88 @@
+#include <catch2/catch.hpp>
+
+#include "text_format_parser.h"
+
+using namespace uih::text_style;
+
+TEST_CASE("parse_format_properties parses all properties", "[text_format_parser]")
+{
+    const auto properties = parse_format_properties(
+        L"font-family: Segoe UI; font-size: 10.5; font-weight: bold; font-stretch: 3; font-style: italic; "
+        L"text-decoration: underline");
+
+    REQUIRE(properties);
+    CHECK(properties->font_family == decltype(properties->font_family)(L"Segoe UI"));
+    CHECK(properties->font_size == decltype(properties->font_size)(10.5f));
+    CHECK(properties->font_weight == decltype(properties->font_weight)(font_weight_bold));
+    CHECK(properties->font_stretch == decltype(properties->font_stretch)(static_cast<FontStretch>(3)));
+    CHECK(properties->font_style == decltype(properties->font_style)(font_style_italic));
+    CHECK(properties->text_decoration == decltype(properties->text_decoration)(TextDecorationType::Underline));
+}
+
+TEST_CASE("parse_format_properties parses numeric and initial values", "[text_format_parser]")
+{
+    const auto properties = parse_format_properties(L"font-weight: 1200; font-stretch: 87.5%; font-style: initial");
+
+    REQUIRE(properties);
+    CHECK(properties->font_weight == decltype(properties->font_weight)(static_cast<FontWeight>(999)));
+    CHECK(properties->font_stretch == decltype(properties->font_stretch)(87.5f));
+    CHECK(properties->font_style == decltype(properties->font_style)(InitialPropertyValue{}));
+    CHECK(!properties->font_family);
+}
+
+TEST_CASE("parse_format_properties skips invalid and unknown properties", "[text_format_parser]")
+{
+    std::vector<std::string> errors;
+    set_format_properties_error_handler([&errors](std::string_view error) { errors.emplace_back(error); });
+
+    const auto properties = parse_format_properties_uncached(L"font-weight: heavy; colour: red; font-style: oblique");
+
+    set_format_properties_error_handler({});
+
+    REQUIRE(properties);
+    CHECK(!properties->font_weight);
+    CHECK(properties->font_style == decltype(properties->font_style)(font_style_oblique));
+    CHECK(!errors.empty());
+}
+
+TEST_CASE("parse_format_properties returns the same result as parse_format_properties_uncached", "[text_format_parser]")
+{
+    const std::wstring_view input = L"font-family: Consolas; font-weight: 600";
+
+    const auto uncached_result = parse_format_properties_uncached(input);
+    CHECK(parse_format_properties(input) == uncached_result);
+    CHECK(parse_format_properties(input) == uncached_result);
+}
+
+TEST_CASE("FormatPropertiesHandle interns equal properties", "[text_format_parser]")
+{
+    const auto properties = parse_format_properties(L"font-family: Segoe UI; font-weight: bold");
+    const auto other_properties = parse_format_properties(L"font-family: Segoe UI; font-weight: normal");
+
+    REQUIRE(properties);
+    REQUIRE(other_properties);
+
+    const FormatPropertiesHandle handle(*properties);
+    const FormatPropertiesHandle other_handle(*other_properties);
+
+    CHECK(handle.id() != 0);
+    CHECK(handle == FormatPropertiesHandle(FormatProperties(*properties)));
+    CHECK(handle != other_handle);
+    CHECK(*handle == *properties);
+    CHECK(FormatPropertiesHandle(FormatProperties{}).id() == 0);
+}
+
+TEST_CASE("FormatPropertiesHandle frees unused interned properties", "[text_format_parser]")
+{
+    const FormatProperties kept_properties{.font_size = 1.0f};
+    const FormatPropertiesHandle kept_handle(kept_properties);
+
+    for (int index{}; index < 5'000; ++index) {
+        const FormatPropertiesHandle handle(FormatProperties{.font_size = 2.0f + static_cast<float>(index)});
+        CHECK(handle.id() != kept_handle.id());
+    }
+
+    CHECK(get_interned_format_properties_count() <= 1'024);
+    CHECK(FormatPropertiesHandle(kept_properties) == kept_handle);
+    CHECK(*kept_handle == kept_properties);
+}
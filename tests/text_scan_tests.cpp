@@ -0,0 +1,137 @@
+#include <catch2/catch.hpp>
+
+#include "text_scan.h"
+
+#include "benchmarks/corpus.h"
+
+using namespace uih;
+
+TEST_CASE("text_scan::find_first_of finds characters in each position", "[text_scan]")
+{
+    // Covers matches in the vectorised blocks and in the remainder
+    for (size_t length{}; length < 40; ++length) {
+        for (size_t match_position{}; match_position <= length; ++match_position) {
+            std::wstring text(length, L'a');
+
+            if (match_position < length)
+                text[match_position] = L'\7';
+
+            const std::wstring_view view(text);
+            const auto expected = view.find_first_of(L"\3\7");
+
+            CHECK(text_scan::find_first_of(view, 0, L'\3', L'\7') == expected);
+
+            std::string narrow_text(text.begin(), text.end());
+            CHECK(text_scan::find_first_of(std::string_view(narrow_text), 0, '\3', '\7') == expected);
+        }
+    }
+}
+
+TEST_CASE("text_scan::find_first_of respects the offset", "[text_scan]")
+{
+    const std::wstring_view text = L"\3ff0000\3Some text with a colour code\3 and more text";
+
+    CHECK(text_scan::find_first_of(text, 0, L'\3') == 0);
+    CHECK(text_scan::find_first_of(text, 1, L'\3') == 7);
+    CHECK(text_scan::find_first_of(text, 8, L'\3') == 36);
+    CHECK(text_scan::find_first_of(text, 37, L'\3') == std::wstring_view::npos);
+    CHECK(text_scan::find_first_of(text, text.size(), L'\3') == std::wstring_view::npos);
+}
+
+TEST_CASE("text_scan::find_first_of doesn't match characters with the same low byte", "[text_scan]")
+{
+    const std::wstring_view text = L"ă܃̇ abcdefghijklmnopć";
+
+    CHECK(text_scan::find_first_of(text, 0, L'\3', L'\7') == std::wstring_view::npos);
+    CHECK(!text_scan::contains_any_of(text, L'\3', L'\7'));
+}
+
+TEST_CASE("text_scan::find_first_of agrees with std::wstring_view::find_first_of", "[text_scan]")
+{
+    const auto titles = benchmarks::generate_titles({.count = 10'000});
+
+    for (auto&& title : titles) {
+        const std::wstring_view view(title);
+
+        for (size_t offset{}; offset <= view.size(); offset += 5) {
+            CHECK(text_scan::find_first_of(view, offset, L'\3', L'\7') == view.find_first_of(L"\3\7", offset));
+            CHECK(text_scan::find_first_of(view, offset, L'\r', L'\n') == view.find_first_of(L"\r\n", offset));
+        }
+    }
+}
+
+namespace {
+
+/** Widen text into a buffer filled with a marker character, returning the count and the buffer */
+template <class Char>
+std::tuple<size_t, std::basic_string<Char>> widen_ascii_prefix(std::string_view text)
+{
+    std::basic_string<Char> output(text.size(), Char{'#'});
+    const auto count = text_scan::widen_ascii_prefix(text, output.data());
+    return {count, output};
+}
+
+template <class Char>
+std::basic_string<Char> widen(std::string_view text)
+{
+    return {text.begin(), text.end()};
+}
+
+} // namespace
+
+TEMPLATE_TEST_CASE("text_scan::widen_ascii_prefix converts exactly one block", "[text_scan]", char16_t, char32_t)
+{
+    const std::string_view text = "0123456789abcdef";
+
+    const auto [count, output] = widen_ascii_prefix<TestType>(text);
+
+    CHECK(count == 16);
+    CHECK(output == widen<TestType>(text));
+}
+
+TEMPLATE_TEST_CASE("text_scan::widen_ascii_prefix stops at the first non-ASCII byte", "[text_scan]", char16_t, char32_t)
+{
+    // Non-ASCII bytes in the first block, in a later block and in the tail after the last full block
+    for (size_t length{1}; length < 40; ++length) {
+        for (size_t non_ascii_position{}; non_ascii_position < length; ++non_ascii_position) {
+            std::string text(length, 'a');
+            text[non_ascii_position] = '\xc3';
+
+            const auto [count, output] = widen_ascii_prefix<TestType>(text);
+
+            CHECK(count == non_ascii_position);
+            CHECK(output.substr(0, count) == widen<TestType>(std::string_view(text).substr(0, count)));
+            // Nothing is written after the ASCII prefix
+            CHECK(output.substr(count) == std::basic_string<TestType>(length - count, TestType{'#'}));
+        }
+    }
+}
+
+TEMPLATE_TEST_CASE("text_scan::widen_ascii_prefix converts tails after the last full block", "[text_scan]",
+    char16_t, char32_t)
+{
+    for (size_t length{}; length < 40; ++length) {
+        std::string text;
+
+        for (size_t index{}; index < length; ++index)
+            text.push_back(static_cast<char>(0x20 + index % 0x5f));
+
+        const auto [count, output] = widen_ascii_prefix<TestType>(text);
+
+        CHECK(count == length);
+        CHECK(output == widen<TestType>(text));
+    }
+}
+
+TEST_CASE("text_scan::widen_ascii_prefix converts the full ASCII range", "[text_scan]")
+{
+    std::string text;
+
+    for (int value{}; value < 0x80; ++value)
+        text.push_back(static_cast<char>(value));
+
+    const auto [count, output] = widen_ascii_prefix<wchar_t>(text);
+
+    CHECK(count == text.size());
+    CHECK(output == widen<wchar_t>(text));
+}
@@ -0,0 +1,64 @@
+/*
+ * Writes emoji-data.txt and emoji-variation-sequences.txt, in the format of the
+ * Unicode data files, from the reference emoji properties.
+ *
+ * Used to check that tools/generate_emoji_table.py reproduces emoji_table.h.
+ *
+ * Usage: write_emoji_data <emoji-data.txt> <emoji-variation-sequences.txt>
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "emoji_reference.h"
+
+using namespace uih::emoji;
+
+namespace {
+
+std::string format_code_point(char32_t code_point)
+{
+    std::array<char, 16> buffer{};
+    std::snprintf(buffer.data(), buffer.size(), "%04X", static_cast<unsigned>(code_point));
+    return buffer.data();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        std::cerr << "Usage: write_emoji_data <emoji-data.txt> <emoji-variation-sequences.txt>\n";
+        return 1;
+    }
+
+    std::vector<std::pair<char32_t, EmojiProperties>> emojis(reference::emojis.begin(), reference::emojis.end());
+    std::ranges::sort(emojis, {}, [](auto&& item) { return item.first; });
+
+    std::ofstream emoji_data(argv[1]);
+    std::ofstream variation_sequences(argv[2]);
+
+    emoji_data << "# Generated from the reference emoji properties\n\n";
+    variation_sequences << "# Generated from the reference emoji properties\n\n";
+
+    for (auto&& [code_point, properties] : emojis) {
+        const auto code_point_text = format_code_point(code_point);
+
+        if (properties.emoji)
+            emoji_data << code_point_text << " ; Emoji\n";
+
+        if (properties.emoji_presentation)
+            emoji_data << code_point_text << " ; Emoji_Presentation\n";
+
+        if (properties.component)
+            emoji_data << code_point_text << " ; Emoji_Component\n";
+
+        if (properties.has_variation) {
+            variation_sequences << code_point_text << " FE0E ; text style;\n";
+            variation_sequences << code_point_text << " FE0F ; emoji style;\n";
+        }
+    }
+
+    return emoji_data && variation_sequences ? 0 : 1;
+}
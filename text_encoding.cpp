@@ -0,0 +1,36 @@
+#include "stdafx.h"
+
+#include "text_encoding.h"
+
+#include "text_scan.h"
+
+namespace uih {
+
+void utf8_to_utf16(std::string_view text, std::wstring& output)
+{
+    // The UTF-16 text never has more code units than the UTF-8 text has bytes
+    output.resize(text.size());
+
+    const auto ascii_count = text_scan::widen_ascii_prefix(text, output.data());
+
+    if (ascii_count == text.size())
+        return;
+
+    // UTF-8 multi-byte sequences never contain ASCII bytes, so it's safe to
+    // convert the rest of the text separately
+    const auto remaining_text = text.substr(ascii_count);
+    const auto remaining_count = MultiByteToWideChar(CP_UTF8, 0, remaining_text.data(),
+        gsl::narrow<int>(remaining_text.size()), output.data() + ascii_count,
+        gsl::narrow<int>(output.size() - ascii_count));
+
+    output.resize(ascii_count + remaining_count);
+}
+
+std::wstring utf8_to_utf16(std::string_view text)
+{
+    std::wstring output;
+    utf8_to_utf16(text, output);
+    return output;
+}
+
+} // namespace uih
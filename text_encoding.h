@@ -0,0 +1,21 @@
+#pragma once
+
+namespace uih {
+
+/**
+ * Convert UTF-8 text to UTF-16, replacing the contents of output.
+ *
+ * Leading ASCII characters (which are all of the characters in most list view
+ * text) are converted 16 at a time using SSE2 where available, and the rest of
+ * the text is converted using MultiByteToWideChar().
+ */
+void utf8_to_utf16(std::string_view text, std::wstring& output);
+
+/**
+ * Convert UTF-8 text to UTF-16.
+ *
+ * \see utf8_to_utf16(std::string_view, std::wstring&)
+ */
+[[nodiscard]] std::wstring utf8_to_utf16(std::string_view text);
+
+} // namespace uih
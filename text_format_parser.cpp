@@ -18,6 +18,9 @@ namespace {
 
 namespace dsl = lexy::dsl;
 
+/** wchar_t strings are UTF-16 on Windows, and UTF-32 on other platforms */
+using WideEncoding = std::conditional_t<sizeof(wchar_t) == 2, lexy::utf16_encoding, lexy::utf32_encoding>;
+
 struct Initial {
     static constexpr auto rule = dsl::lit<"initial">;
     static constexpr auto value = lexy::constant(InitialPropertyValue{});
@@ -31,14 +34,14 @@ struct Float {
         return dsl::capture(decimal);
     }();
 
-    static constexpr auto value = lexy::as_string<std::wstring, lexy::utf16_encoding>
+    static constexpr auto value = lexy::as_string<std::wstring, WideEncoding>
         | lexy::callback<float>([](std::wstring&& str) { return std::stof(str); });
 };
 
 struct FontFamilyValue {
     struct String : lexy::token_production {
         static constexpr auto rule = dsl::list(dsl::capture(dsl::unicode::character - dsl::lit_c<';'>));
-        static constexpr auto value = lexy::as_string<std::wstring, lexy::utf16_encoding>;
+        static constexpr auto value = lexy::as_string<std::wstring, WideEncoding>;
     };
 
     static constexpr auto rule = dsl::p<Initial> | dsl::else_ >> dsl::p<String>;
@@ -53,18 +56,18 @@ struct FontSizeValue {
 struct FontWeightValue {
     struct Normal {
         static constexpr auto rule = dsl::lit<"normal">;
-        static constexpr auto value = lexy::constant(DWRITE_FONT_WEIGHT_NORMAL);
+        static constexpr auto value = lexy::constant(font_weight_normal);
     };
 
     struct Bold {
         static constexpr auto rule = dsl::lit<"bold">;
-        static constexpr auto value = lexy::constant(DWRITE_FONT_WEIGHT_BOLD);
+        static constexpr auto value = lexy::constant(font_weight_bold);
     };
 
     struct Weight {
         static constexpr auto rule = dsl::integer<int>;
-        static constexpr auto value = lexy::callback<DWRITE_FONT_WEIGHT>(
-            [](int value) { return static_cast<DWRITE_FONT_WEIGHT>(std::clamp(value, 1, 999)); });
+        static constexpr auto value = lexy::callback<FontWeight>(
+            [](int value) { return static_cast<FontWeight>(std::clamp(value, 1, 999)); });
     };
 
     static constexpr auto rule = dsl::p<Initial> | dsl::p<Weight> | dsl::p<Normal> | dsl::p<Bold>;
@@ -74,8 +77,8 @@ struct FontWeightValue {
 struct FontStretchValue {
     struct StretchClass {
         static constexpr auto rule = dsl::integer<int>;
-        static constexpr auto value = lexy::callback<DWRITE_FONT_STRETCH>(
-            [](int value) { return static_cast<DWRITE_FONT_STRETCH>(std::clamp(value, 1, 9)); });
+        static constexpr auto value = lexy::callback<FontStretch>(
+            [](int value) { return static_cast<FontStretch>(std::clamp(value, 1, 9)); });
     };
 
     struct Percentage {
@@ -91,17 +94,17 @@ struct FontStretchValue {
 struct FontStyleValue {
     struct Normal {
         static constexpr auto rule = dsl::lit<"normal">;
-        static constexpr auto value = lexy::constant(DWRITE_FONT_STYLE_NORMAL);
+        static constexpr auto value = lexy::constant(font_style_normal);
     };
 
     struct Italic {
         static constexpr auto rule = dsl::lit<"italic">;
-        static constexpr auto value = lexy::constant(DWRITE_FONT_STYLE_ITALIC);
+        static constexpr auto value = lexy::constant(font_style_italic);
     };
 
     struct Oblique {
         static constexpr auto rule = dsl::lit<"oblique">;
-        static constexpr auto value = lexy::constant(DWRITE_FONT_STYLE_OBLIQUE);
+        static constexpr auto value = lexy::constant(font_style_oblique);
     };
 
     static constexpr auto rule = dsl::p<Initial> | dsl::p<Normal> | dsl::p<Italic> | dsl::p<Oblique>;
@@ -150,9 +153,174 @@ struct FormatPropertiesProduction {
     static constexpr auto value = lexy::as_aggregate<FormatProperties>;
 };
 
+template <class Char>
+struct TransparentStringHash {
+    using is_transparent = void;
+
+    size_t operator()(std::basic_string_view<Char> value) const
+    {
+        return std::hash<std::basic_string_view<Char>>{}(value);
+    }
+};
+
+/**
+ * Registry of interned FormatProperties.
+ *
+ * Entries that are no longer referenced by any handle are removed when the
+ * registry becomes full. IDs are never reused, so that stale cache entries
+ * keyed by the ID of a removed entry can't match different properties.
+ */
+class FormatPropertiesRegistry {
+public:
+    static FormatPropertiesRegistry& s_get()
+    {
+        static FormatPropertiesRegistry registry;
+        return registry;
+    }
+
+    std::tuple<uint32_t, std::shared_ptr<const FormatProperties>> intern(const FormatProperties& properties)
+    {
+        thread_local std::vector<uint8_t> serialised_properties;
+        serialised_properties.clear();
+        properties.serialise(serialised_properties);
+
+        const std::string_view key(
+            reinterpret_cast<const char*>(serialised_properties.data()), serialised_properties.size());
+
+        std::scoped_lock lock(m_mutex);
+
+        if (const auto iter = m_entries.find(key); iter != m_entries.end())
+            return {iter->second.id, iter->second.properties};
+
+        if (m_entries.size() >= max_size)
+            remove_unused_entries();
+
+        // IDs start from one, as zero is used for empty properties
+        const auto id = ++m_last_id;
+        auto interned_properties = std::make_shared<const FormatProperties>(properties);
+        m_entries.emplace(key, Entry{id, interned_properties});
+
+        return {id, std::move(interned_properties)};
+    }
+
+    size_t size()
+    {
+        std::scoped_lock lock(m_mutex);
+        return m_entries.size();
+    }
+
+private:
+    struct Entry {
+        uint32_t id{};
+        std::shared_ptr<const FormatProperties> properties;
+    };
+
+    /**
+     * Remove entries that aren't referenced by a handle.
+     *
+     * New references can only be taken from the registry while the mutex is held,
+     * so a use count of one is exact here.
+     */
+    void remove_unused_entries()
+    {
+        std::erase_if(m_entries, [](auto&& item) { return item.second.properties.use_count() == 1; });
+    }
+
+    static constexpr size_t max_size = 1024;
+
+    std::mutex m_mutex;
+    uint32_t m_last_id{};
+    std::unordered_map<std::string, Entry, TransparentStringHash<char>, std::equal_to<>> m_entries;
+};
+
+/**
+ * Cache of the results of parsing format properties, keyed by the input text.
+ *
+ * There are normally only a handful of distinct inputs, so the cache is simply
+ * cleared when it becomes full.
+ */
+class ParsedFormatPropertiesCache {
+public:
+    static ParsedFormatPropertiesCache& s_get()
+    {
+        static ParsedFormatPropertiesCache cache;
+        return cache;
+    }
+
+    std::optional<std::optional<FormatProperties>> get(std::wstring_view input)
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (const auto iter = m_results.find(input); iter != m_results.end())
+            return iter->second;
+
+        return {};
+    }
+
+    void put(std::wstring_view input, const std::optional<FormatProperties>& result)
+    {
+        std::scoped_lock lock(m_mutex);
+
+        if (m_results.size() >= max_size)
+            m_results.clear();
+
+        m_results.emplace(input, result);
+    }
+
+private:
+    static constexpr size_t max_size = 256;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::wstring, std::optional<FormatProperties>, TransparentStringHash<wchar_t>, std::equal_to<>>
+        m_results;
+};
+
+class ErrorHandler {
+public:
+    static ErrorHandler& s_get()
+    {
+        static ErrorHandler error_handler;
+        return error_handler;
+    }
+
+    std::function<void(std::string_view)> get()
+    {
+        std::scoped_lock lock(m_mutex);
+        return m_handler;
+    }
+
+    void set(std::function<void(std::string_view)> handler)
+    {
+        std::scoped_lock lock(m_mutex);
+        m_handler = std::move(handler);
+    }
+
+private:
+    static std::function<void(std::string_view)> s_make_default_handler()
+    {
+#if defined(_WIN32) && defined(_DEBUG)
+        return [](std::string_view errors) {
+            OutputDebugStringA(std::format("UI helpers: text format code error: {}\n", errors).c_str());
+        };
+#else
+        return {};
+#endif
+    }
+
+    std::mutex m_mutex;
+    std::function<void(std::string_view)> m_handler{s_make_default_handler()};
+};
+
 } // namespace
 
 std::vector<uint8_t> FormatProperties::serialise() const
+{
+    std::vector<uint8_t> result;
+    serialise(result);
+    return result;
+}
+
+void FormatProperties::serialise(std::vector<uint8_t>& output) const
 {
     class ValueVisitor {
     public:
@@ -161,32 +329,33 @@ std::vector<uint8_t> FormatProperties::serialise() const
         void operator()(const InitialPropertyValue& value) const {}
         void operator()(const std::wstring& value) const
         {
-            ranges::copy(std::span(reinterpret_cast<const uint8_t*>(value.data()), value.size() * sizeof(wchar_t)),
+            std::ranges::copy(
+                std::span(reinterpret_cast<const uint8_t*>(value.data()), value.size() * sizeof(wchar_t)),
                 std::back_inserter(m_output));
         }
         void operator()(const float& value) const
         {
-            ranges::copy(
+            std::ranges::copy(
                 std::span(reinterpret_cast<const uint8_t*>(&value), sizeof(value)), std::back_inserter(m_output));
         }
-        void operator()(const DWRITE_FONT_WEIGHT& value) const
+        void operator()(const FontWeight& value) const
         {
-            ranges::copy(
+            std::ranges::copy(
                 std::span(reinterpret_cast<const uint8_t*>(&value), sizeof(value)), std::back_inserter(m_output));
         }
-        void operator()(const DWRITE_FONT_STRETCH& value) const
+        void operator()(const FontStretch& value) const
         {
-            ranges::copy(
+            std::ranges::copy(
                 std::span(reinterpret_cast<const uint8_t*>(&value), sizeof(value)), std::back_inserter(m_output));
         }
-        void operator()(const DWRITE_FONT_STYLE& value) const
+        void operator()(const FontStyle& value) const
         {
-            ranges::copy(
+            std::ranges::copy(
                 std::span(reinterpret_cast<const uint8_t*>(&value), sizeof(value)), std::back_inserter(m_output));
         }
         void operator()(const TextDecorationType& value) const
         {
-            ranges::copy(
+            std::ranges::copy(
                 std::span(reinterpret_cast<const uint8_t*>(&value), sizeof(value)), std::back_inserter(m_output));
         }
 
@@ -195,16 +364,15 @@ std::vector<uint8_t> FormatProperties::serialise() const
     };
 
     if (!*this)
-        return {};
+        return;
 
-    std::vector<uint8_t> result;
-    ValueVisitor visitor(result);
+    ValueVisitor visitor(output);
 
-    auto serialise_value = [&result, &visitor](auto&& value) {
+    auto serialise_value = [&output, &visitor](auto&& value) {
         if (value)
             std::visit(visitor, *value);
 
-        result.emplace_back(0);
+        output.emplace_back(0);
     };
 
     serialise_value(font_family);
@@ -213,24 +381,57 @@ std::vector<uint8_t> FormatProperties::serialise() const
     serialise_value(font_stretch);
     serialise_value(font_style);
     serialise_value(text_decoration);
+}
 
-    return result;
+FormatPropertiesHandle::FormatPropertiesHandle(const FormatProperties& properties)
+{
+    if (!properties)
+        return;
+
+    // Consecutive calls are often for the same properties (e.g. for each cell in a column)
+    thread_local FormatPropertiesHandle last_handle;
+
+    if (last_handle.m_properties && *last_handle.m_properties == properties) {
+        *this = last_handle;
+        return;
+    }
+
+    std::tie(m_id, m_properties) = FormatPropertiesRegistry::s_get().intern(properties);
+    last_handle = *this;
 }
 
-std::optional<FormatProperties> parse_format_properties(std::wstring_view input)
+size_t get_interned_format_properties_count()
 {
-    auto input_buffer = lexy::string_input<lexy::utf16_encoding>(input);
+    return FormatPropertiesRegistry::s_get().size();
+}
+
+const FormatProperties& FormatPropertiesHandle::get() const
+{
+    static const FormatProperties empty_properties;
+
+    return m_properties ? *m_properties : empty_properties;
+}
+
+std::optional<FormatProperties> parse_format_properties_uncached(std::wstring_view input)
+{
+    auto input_buffer = lexy::string_input<WideEncoding>(input);
+    const auto error_handler = ErrorHandler::s_get().get();
+
+    if (!error_handler) {
+        auto result = lexy::parse<FormatPropertiesProduction>(input_buffer, lexy::noop);
 
-#ifdef _DEBUG
-    std::ostringstream stream;
+        if (result.has_value())
+            return result.value();
+
+        return {};
+    }
+
+    std::string errors;
     auto result = lexy::parse<FormatPropertiesProduction>(
-        input_buffer, lexy_ext::report_error.to(std::ostream_iterator<const char>(stream)));
+        input_buffer, lexy_ext::report_error.to(std::back_inserter(errors)));
 
-    if (const auto errors = stream.view(); !errors.empty())
-        OutputDebugString(std::format(L"UI helpers: text format code error: {}\n", mmh::to_utf16(errors)).c_str());
-#else
-    auto result = lexy::parse<FormatPropertiesProduction>(input_buffer, lexy::noop);
-#endif
+    if (!errors.empty())
+        error_handler(errors);
 
     if (result.has_value())
         return result.value();
@@ -238,4 +439,21 @@ std::optional<FormatProperties> parse_format_properties(std::wstring_view input)
     return {};
 }
 
+void set_format_properties_error_handler(std::function<void(std::string_view)> handler)
+{
+    ErrorHandler::s_get().set(std::move(handler));
+}
+
+std::optional<FormatProperties> parse_format_properties(std::wstring_view input)
+{
+    auto& cache = ParsedFormatPropertiesCache::s_get();
+
+    if (auto cached_result = cache.get(input))
+        return std::move(*cached_result);
+
+    auto result = parse_format_properties_uncached(input);
+    cache.put(input, result);
+    return result;
+}
+
 } // namespace uih::text_style
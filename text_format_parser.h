@@ -2,6 +2,22 @@
 
 namespace uih::text_style {
 
+/**
+ * DirectWrite types used for font property values.
+ *
+ * The rest of this module only refers to these aliases and constants, so that
+ * it doesn't otherwise depend on DirectWrite.
+ */
+using FontWeight = DWRITE_FONT_WEIGHT;
+using FontStretch = DWRITE_FONT_STRETCH;
+using FontStyle = DWRITE_FONT_STYLE;
+
+inline constexpr FontWeight font_weight_normal = DWRITE_FONT_WEIGHT_NORMAL;
+inline constexpr FontWeight font_weight_bold = DWRITE_FONT_WEIGHT_BOLD;
+inline constexpr FontStyle font_style_normal = DWRITE_FONT_STYLE_NORMAL;
+inline constexpr FontStyle font_style_italic = DWRITE_FONT_STYLE_ITALIC;
+inline constexpr FontStyle font_style_oblique = DWRITE_FONT_STYLE_OBLIQUE;
+
 struct InitialPropertyValue {
     auto operator<=>(const InitialPropertyValue&) const = default;
 };
@@ -14,9 +30,9 @@ enum class TextDecorationType : int8_t {
 struct FormatProperties {
     std::optional<std::variant<std::wstring, InitialPropertyValue>> font_family;
     std::optional<std::variant<float, InitialPropertyValue>> font_size;
-    std::optional<std::variant<DWRITE_FONT_WEIGHT, InitialPropertyValue>> font_weight;
-    std::optional<std::variant<DWRITE_FONT_STRETCH, float, InitialPropertyValue>> font_stretch;
-    std::optional<std::variant<DWRITE_FONT_STYLE, InitialPropertyValue>> font_style;
+    std::optional<std::variant<FontWeight, InitialPropertyValue>> font_weight;
+    std::optional<std::variant<FontStretch, float, InitialPropertyValue>> font_stretch;
+    std::optional<std::variant<FontStyle, InitialPropertyValue>> font_style;
     std::optional<std::variant<TextDecorationType, InitialPropertyValue>> text_decoration;
 
     auto operator<=>(const FormatProperties&) const = default;
@@ -27,8 +43,68 @@ struct FormatProperties {
     }
 
     std::vector<uint8_t> serialise() const;
+
+    /**
+     * Append the serialised properties to output.
+     */
+    void serialise(std::vector<uint8_t>& output) const;
+};
+
+/**
+ * A handle to interned (i.e. immutable and deduplicated) FormatProperties.
+ *
+ * While any handle to some FormatProperties exists, equal FormatProperties
+ * are interned to the same ID, so handles can be compared and hashed using the
+ * ID alone. A default-constructed handle refers to empty FormatProperties and
+ * has an ID of zero.
+ *
+ * Interned FormatProperties that are no longer referenced by any handle are
+ * freed once enough distinct values have been interned. Interning them again
+ * then gives a new ID (IDs are never reused).
+ */
+class FormatPropertiesHandle {
+public:
+    FormatPropertiesHandle() = default;
+    explicit FormatPropertiesHandle(const FormatProperties& properties);
+
+    [[nodiscard]] uint32_t id() const { return m_id; }
+    [[nodiscard]] const FormatProperties& get() const;
+
+    const FormatProperties& operator*() const { return get(); }
+    const FormatProperties* operator->() const { return &get(); }
+
+    bool operator==(const FormatPropertiesHandle& other) const { return m_id == other.m_id; }
+
+private:
+    uint32_t m_id{};
+    std::shared_ptr<const FormatProperties> m_properties;
 };
 
+/**
+ * Get the number of distinct FormatProperties currently interned.
+ */
+size_t get_interned_format_properties_count();
+
+/**
+ * Parse format properties (e.g. "font-family: Segoe UI; font-weight: bold").
+ *
+ * Results for recently parsed input are cached, as the same input is typically
+ * parsed repeatedly.
+ */
 std::optional<FormatProperties> parse_format_properties(std::wstring_view input);
 
+/**
+ * Parse format properties without using or updating the cache.
+ */
+std::optional<FormatProperties> parse_format_properties_uncached(std::wstring_view input);
+
+/**
+ * Set a function that's called with a description of any errors found when
+ * parsing format properties.
+ *
+ * By default, errors are written to the debugger output in debug builds on
+ * Windows, and are otherwise ignored. Pass an empty function to ignore errors.
+ */
+void set_format_properties_error_handler(std::function<void(std::string_view)> handler);
+
 } // namespace uih::text_style
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <bit>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define UIH_TEXT_SCAN_USE_SSE2 1
+#else
+#define UIH_TEXT_SCAN_USE_SSE2 0
+#endif
+
+namespace uih::text_scan {
+
+namespace detail {
+
+#if UIH_TEXT_SCAN_USE_SSE2
+template <class Char>
+__m128i set_all(Char value)
+{
+    if constexpr (sizeof(Char) == 1)
+        return _mm_set1_epi8(static_cast<char>(value));
+    else if constexpr (sizeof(Char) == 2)
+        return _mm_set1_epi16(static_cast<short>(value));
+    else
+        return _mm_set1_epi32(static_cast<int>(value));
+}
+
+template <class Char>
+__m128i compare_equal(__m128i left, __m128i right)
+{
+    if constexpr (sizeof(Char) == 1)
+        return _mm_cmpeq_epi8(left, right);
+    else if constexpr (sizeof(Char) == 2)
+        return _mm_cmpeq_epi16(left, right);
+    else
+        return _mm_cmpeq_epi32(left, right);
+}
+#endif
+
+} // namespace detail
+
+/**
+ * Find the first occurrence of any of the passed characters in text, starting at offset.
+ *
+ * This is equivalent to std::basic_string_view::find_first_of(), but compares
+ * 16 bytes at a time using SSE2 where available. It's intended for finding
+ * control characters (such as style codes or line breaks), which most text
+ * doesn't contain.
+ *
+ * \return  The index of the first occurrence, or std::basic_string_view::npos if there is none
+ */
+template <class Char, std::same_as<Char>... Chars>
+size_t find_first_of(std::basic_string_view<Char> text, size_t offset, Char character, Chars... other_characters)
+{
+    auto is_match = [&](Char value) { return value == character || ((value == other_characters) || ...); };
+
+#if UIH_TEXT_SCAN_USE_SSE2
+    constexpr size_t block_size = sizeof(__m128i) / sizeof(Char);
+
+    for (; offset + block_size <= text.size(); offset += block_size) {
+        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + offset));
+        auto matches = detail::compare_equal<Char>(block, detail::set_all(character));
+        ((matches = _mm_or_si128(matches, detail::compare_equal<Char>(block, detail::set_all(other_characters)))), ...);
+
+        if (const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches)); mask != 0)
+            return offset + std::countr_zero(mask) / sizeof(Char);
+    }
+#endif
+
+    for (; offset < text.size(); ++offset) {
+        if (is_match(text[offset]))
+            return offset;
+    }
+
+    return std::basic_string_view<Char>::npos;
+}
+
+/**
+ * Whether text contains any of the passed characters.
+ */
+template <class Char, std::same_as<Char>... Chars>
+bool contains_any_of(std::basic_string_view<Char> text, Char character, Chars... other_characters)
+{
+    return find_first_of(text, 0, character, other_characters...) != std::basic_string_view<Char>::npos;
+}
+
+/**
+ * Widen the leading ASCII characters of UTF-8 text, stopping at the first
+ * non-ASCII byte.
+ *
+ * 16 characters are converted at a time using SSE2 where available.
+ * output must have room for text.size() characters.
+ *
+ * \return  The number of characters converted
+ */
+template <class Char>
+requires(sizeof(Char) == 2 || sizeof(Char) == 4)
+size_t widen_ascii_prefix(std::string_view text, Char* output)
+{
+    size_t offset{};
+
+#if UIH_TEXT_SCAN_USE_SSE2
+    const auto zero = _mm_setzero_si128();
+
+    for (; offset + sizeof(__m128i) <= text.size(); offset += sizeof(__m128i)) {
+        const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + offset));
+
+        if (_mm_movemask_epi8(block) != 0)
+            break;
+
+        const auto low = _mm_unpacklo_epi8(block, zero);
+        const auto high = _mm_unpackhi_epi8(block, zero);
+
+        if constexpr (sizeof(Char) == 2) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + offset), low);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + offset + 8), high);
+        } else {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + offset), _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + offset + 4), _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + offset + 8), _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + offset + 12), _mm_unpackhi_epi16(high, zero));
+        }
+    }
+#endif
+
+    for (; offset < text.size() && static_cast<uint8_t>(text[offset]) < 0x80; ++offset)
+        output[offset] = static_cast<Char>(text[offset]);
+
+    return offset;
+}
+
+} // namespace uih::text_scan
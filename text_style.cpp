@@ -3,6 +3,7 @@
 #include "text_style.h"
 
 #include "direct_write.h"
+#include "text_scan.h"
 
 using namespace std::string_view_literals;
 
@@ -48,6 +49,67 @@ void merge_properties(FormatProperties& target, FormatProperties& source)
     std::apply([&](auto... members) { (merge_property(target, source, members), ...); }, format_properties_members);
 }
 
+/**
+ * Removes properties set to 'initial', returning an empty std::optional if no properties remain.
+ */
+std::optional<FormatProperties> remove_initial_values(const FormatProperties& properties)
+{
+    if (!properties)
+        return {};
+
+    FormatProperties cleaned_properties{properties};
+
+    for_each_property(cleaned_properties, [](auto&& member) {
+        if (member && std::holds_alternative<InitialPropertyValue>(*member)) {
+            member.reset();
+        }
+    });
+
+    if (!cleaned_properties)
+        return {};
+
+    return cleaned_properties;
+}
+
+/**
+ * Get the result of processing text of the passed length that contains no colour or font codes.
+ *
+ * This only depends on the initial format and the length of the text, so results are shared between all text with
+ * the same length and initial format.
+ */
+std::shared_ptr<const ProcessedColourAndFontCodes> get_processed_text_without_codes(
+    size_t text_length, const FormatPropertiesHandle& initial_format)
+{
+    static const auto empty_result = std::make_shared<const ProcessedColourAndFontCodes>();
+
+    if (text_length == 0 || !*initial_format || text_length > std::numeric_limits<uint32_t>::max())
+        return empty_result;
+
+    constexpr size_t max_results = 4096;
+    static std::mutex mutex;
+    static std::unordered_map<uint64_t, std::shared_ptr<const ProcessedColourAndFontCodes>> results;
+
+    const auto key = (static_cast<uint64_t>(initial_format.id()) << 32) | text_length;
+
+    std::scoped_lock lock(mutex);
+
+    if (const auto iter = results.find(key); iter != results.end())
+        return iter->second;
+
+    if (results.size() >= max_results)
+        results.clear();
+
+    const auto cleaned_font = remove_initial_values(*initial_format);
+
+    if (!cleaned_font)
+        return results.emplace(key, empty_result).first->second;
+
+    auto result = std::make_shared<ProcessedColourAndFontCodes>();
+    result->font_segments.emplace_back(*cleaned_font, 0, text_length);
+
+    return results.emplace(key, std::move(result)).first->second;
+}
+
 std::optional<FormatProperties> parse_legacy_font_code(const std::vector<std::wstring_view>& parts,
     const std::function<void(std::wstring)>& print_legacy_feedback,
     const direct_write::Context::Ptr& direct_write_context)
@@ -167,23 +229,50 @@ std::optional<ColourPair> parse_colour_code(std::wstring_view text)
     return ColourPair{non_selected_colour, selected_colour};
 }
 
+bool has_colour_or_font_codes(std::wstring_view text)
+{
+    return text_scan::contains_any_of(text, L'\3', L'\7');
+}
+
 std::tuple<std::wstring, std::vector<ColourSegment>, std::vector<FontSegment>> process_colour_and_font_codes(
     std::wstring_view text, const FormatProperties& initial_format_properties,
     const std::function<void(std::wstring)>& print_legacy_feedback,
     const direct_write::Context::Ptr& direct_write_context)
 {
-    auto result = std::tuple<std::wstring, std::vector<ColourSegment>, std::vector<FontSegment>>{};
-    auto& [stripped_text, coloured_segments, font_segments] = result;
+    auto [stripped_text, colour_segments, font_segments] = process_colour_and_font_codes_if_present(
+        text, initial_format_properties, print_legacy_feedback, direct_write_context);
+
+    return {stripped_text ? std::move(*stripped_text) : std::wstring(text), std::move(colour_segments),
+        std::move(font_segments)};
+}
+
+ProcessedColourAndFontCodes process_colour_and_font_codes_if_present(std::wstring_view text,
+    const FormatProperties& initial_format_properties, const std::function<void(std::wstring)>& print_legacy_feedback,
+    const direct_write::Context::Ptr& direct_write_context)
+{
+    ProcessedColourAndFontCodes result;
+    const auto first_code_index = text_scan::find_first_of(text, 0, L'\3', L'\7');
+
+    if (first_code_index == std::wstring_view::npos) {
+        if (const auto cleaned_font = remove_initial_values(initial_format_properties); cleaned_font && !text.empty())
+            result.font_segments.emplace_back(*cleaned_font, 0, text.size());
+
+        return result;
+    }
+
+    auto& stripped_text = result.stripped_text.emplace();
+    auto& coloured_segments = result.colour_segments;
+    auto& font_segments = result.font_segments;
+    stripped_text.reserve(text.size());
 
     size_t offset{};
+    size_t index{first_code_index};
     size_t colour_segment_start{};
     size_t font_segment_start{};
     std::optional<ColourPair> cr_current;
     std::optional current_font{initial_format_properties};
 
     while (true) {
-        const size_t index = text.find_first_of(L"\3\7"sv, offset);
-
         const auto fragment_length = index == std::wstring_view::npos ? std::wstring_view::npos : index - offset;
         const auto fragment = text.substr(offset, fragment_length);
         const auto is_eos = index == std::wstring_view::npos;
@@ -198,23 +287,15 @@ std::tuple<std::wstring, std::vector<ColourSegment>, std::vector<FontSegment>> p
                 stripped_text.length() - colour_segment_start);
 
         if (current_font && (is_eos || is_font_code) && stripped_text.length() > font_segment_start) {
-            FormatProperties cleaned_font{*current_font};
-
-            for_each_property(cleaned_font, [](auto&& member) {
-                if (member && std::holds_alternative<InitialPropertyValue>(*member)) {
-                    member.reset();
-                }
-            });
-
-            if (cleaned_font)
+            if (const auto cleaned_font = remove_initial_values(*current_font))
                 font_segments.emplace_back(
-                    cleaned_font, font_segment_start, stripped_text.length() - font_segment_start);
+                    *cleaned_font, font_segment_start, stripped_text.length() - font_segment_start);
         }
 
         if (is_eos)
             break;
 
-        offset = text.find(is_colour_code ? L'\3' : L'\7', index + 1);
+        offset = text_scan::find_first_of(text, index + 1, text[index]);
 
         if (offset == std::wstring_view::npos)
             break;
@@ -246,18 +327,43 @@ std::tuple<std::wstring, std::vector<ColourSegment>, std::vector<FontSegment>> p
         }
 
         ++offset;
+        index = text_scan::find_first_of(text, offset, L'\3', L'\7');
     }
 
     return result;
 }
 
+std::shared_ptr<const ProcessedColourAndFontCodes> process_colour_and_font_codes_cached(
+    std::wstring_view text, const FormatPropertiesHandle& initial_format)
+{
+    if (!has_colour_or_font_codes(text))
+        return get_processed_text_without_codes(text.size(), initial_format);
+
+    static std::mutex mutex;
+    static direct_write::GenerationalTextCache<std::shared_ptr<const ProcessedColourAndFontCodes>> cache(1024);
+
+    {
+        std::scoped_lock lock(mutex);
+
+        if (auto result = cache.get(text, initial_format.id()))
+            return std::move(*result);
+    }
+
+    auto result = std::make_shared<const ProcessedColourAndFontCodes>(
+        process_colour_and_font_codes_if_present(text, *initial_format));
+
+    std::scoped_lock lock(mutex);
+    cache.put(text, initial_format.id(), result);
+    return result;
+}
+
 std::optional<std::wstring> remove_newlines(std::wstring_view text)
 {
     std::optional<std::wstring> stripped_text;
     size_t offset{};
 
     while (true) {
-        const size_t index = text.find_first_of(L"\r\n"sv, offset);
+        const size_t index = text_scan::find_first_of(text, offset, L'\r', L'\n');
 
         if (index == std::string_view::npos && !stripped_text)
             return {};
@@ -287,12 +393,16 @@ std::optional<std::wstring> remove_newlines(std::wstring_view text)
 
 std::string remove_colour_and_font_codes(std::string_view text)
 {
+    size_t index = text_scan::find_first_of(text, 0, '\3', '\7');
+
+    if (index == std::string_view::npos)
+        return std::string(text);
+
     std::string stripped_text;
+    stripped_text.reserve(text.size());
     size_t offset{};
 
     while (true) {
-        const size_t index = text.find_first_of("\3\7"sv, offset);
-
         const auto fragment_length = index == std::string_view::npos ? std::string_view::npos : index - offset;
         const auto fragment = text.substr(offset, fragment_length);
 
@@ -302,12 +412,13 @@ std::string remove_colour_and_font_codes(std::string_view text)
         if (index == std::string_view::npos)
             break;
 
-        offset = text.find_first_of(text[index], index + 1);
+        offset = text_scan::find_first_of(text, index + 1, text[index]);
 
         if (offset == std::string_view::npos)
             break;
 
         ++offset;
+        index = text_scan::find_first_of(text, offset, '\3', '\7');
     }
 
     return stripped_text;
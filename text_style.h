@@ -23,13 +23,43 @@ struct FontSegment {
     size_t character_count{};
 };
 
+struct ProcessedColourAndFontCodes {
+    /** Empty if the text contained no colour or font codes (in which case the original text should be used) */
+    std::optional<std::wstring> stripped_text;
+    std::vector<ColourSegment> colour_segments;
+    std::vector<FontSegment> font_segments;
+};
+
 std::optional<ColourPair> parse_colour_code(std::wstring_view text);
 
+bool has_colour_or_font_codes(std::wstring_view text);
+
+/**
+ * Like process_colour_and_font_codes(), but doesn't copy text that contains no
+ * colour or font codes.
+ */
+ProcessedColourAndFontCodes process_colour_and_font_codes_if_present(std::wstring_view text,
+    const FormatProperties& initial_format_properties = {},
+    const std::function<void(std::wstring)>& print_legacy_feedback = {},
+    const direct_write::Context::Ptr& direct_write_context = {});
+
 std::tuple<std::wstring, std::vector<ColourSegment>, std::vector<FontSegment>> process_colour_and_font_codes(
     std::wstring_view text, const FormatProperties& initial_format_properties = {},
     const std::function<void(std::wstring)>& print_legacy_feedback = {},
     const direct_write::Context::Ptr& direct_write_context = {});
 
+/**
+ * Like process_colour_and_font_codes_if_present(), but results for text that
+ * contains codes are kept in a bounded cache shared by all threads. Results
+ * for text without codes are shared by all text of the same length with the
+ * same initial format.
+ *
+ * Legacy font codes that need a DirectWrite context are not resolved (as with
+ * process_colour_and_font_codes_if_present() when no context is passed).
+ */
+std::shared_ptr<const ProcessedColourAndFontCodes> process_colour_and_font_codes_cached(
+    std::wstring_view text, const FormatPropertiesHandle& initial_format);
+
 std::optional<std::wstring> remove_newlines(std::wstring_view text);
 std::string remove_colour_and_font_codes(std::string_view text);
 
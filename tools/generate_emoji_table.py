@@ -0,0 +1,161 @@
+"""
+Generates emoji_table.h from the Unicode emoji data files.
+
+Usage:
+
+    python tools/generate_emoji_table.py emoji-data.txt emoji-variation-sequences.txt emoji_table.h
+
+The input files are available from https://www.unicode.org/Public/ (under
+emoji/ for Unicode 15.1 and later, and ucd/emoji/ for earlier versions).
+"""
+
+import argparse
+import re
+
+BLOCK_BITS = 8
+BLOCK_SIZE = 1 << BLOCK_BITS
+
+EMOJI = 1 << 0
+EMOJI_PRESENTATION = 1 << 1
+HAS_VARIATION = 1 << 2
+COMPONENT = 1 << 3
+
+PROPERTY_FLAGS = {
+    "Emoji": EMOJI,
+    "Emoji_Presentation": EMOJI_PRESENTATION,
+    "Emoji_Component": COMPONENT,
+}
+
+
+def strip_comment(line):
+    return line.split("#", 1)[0].strip()
+
+
+def parse_code_point_range(text):
+    first, _, last = text.partition("..")
+    return range(int(first, 16), int(last or first, 16) + 1)
+
+
+def read_emoji_data(path, flags):
+    with open(path, encoding="utf-8") as file:
+        for line in file:
+            line = strip_comment(line)
+
+            if not line:
+                continue
+
+            code_points, property_name = (field.strip() for field in line.split(";")[:2])
+            flag = PROPERTY_FLAGS.get(property_name)
+
+            if flag is None:
+                continue
+
+            for code_point in parse_code_point_range(code_points):
+                flags[code_point] = flags.get(code_point, 0) | flag
+
+
+def read_variation_sequences(path, flags):
+    with open(path, encoding="utf-8") as file:
+        for line in file:
+            line = strip_comment(line)
+
+            if not line:
+                continue
+
+            sequence = line.split(";")[0].split()
+
+            if len(sequence) != 2 or not re.fullmatch("FE0[EF]", sequence[1], re.IGNORECASE):
+                raise ValueError(f"Unexpected variation sequence: {line}")
+
+            code_point = int(sequence[0], 16)
+            flags[code_point] = flags.get(code_point, 0) | HAS_VARIATION
+
+
+def build_tables(flags):
+    block_count = max(flags) // BLOCK_SIZE + 1
+    blocks = [bytes(BLOCK_SIZE // 2)]
+    block_indices = []
+
+    for block_start in range(0, block_count * BLOCK_SIZE, BLOCK_SIZE):
+        block = bytearray(BLOCK_SIZE // 2)
+
+        for offset in range(BLOCK_SIZE):
+            value = flags.get(block_start + offset, 0)
+            block[offset // 2] |= value << (4 * (offset % 2))
+
+        block = bytes(block)
+
+        if block not in blocks:
+            blocks.append(block)
+
+        block_indices.append(blocks.index(block))
+
+    if len(blocks) > 256:
+        raise ValueError("Too many distinct blocks for 8-bit block indices")
+
+    return block_indices, blocks
+
+
+def format_bytes(values, indent, max_line_length=120):
+    lines = []
+    line = indent
+
+    for value in values:
+        item = f"0x{value:02x},"
+
+        if len(line) + len(item) + 1 > max_line_length:
+            lines.append(line.rstrip())
+            line = indent
+
+        line += item + " "
+
+    lines.append(line.rstrip())
+    return "\n".join(lines)
+
+
+def write_header(path, block_indices, blocks):
+    with open(path, "w", encoding="utf-8", newline="\n") as file:
+        file.write("#pragma once\n\n")
+        file.write("// Generated by tools/generate_emoji_table.py. Do not edit.\n\n")
+        file.write("// clang-format off\n\n")
+        file.write("namespace uih::emoji::detail {\n\n")
+        file.write(f"constexpr unsigned emoji_table_block_bits = {BLOCK_BITS};\n\n")
+        file.write("/** Index into emoji_table_blocks of the block containing each code point */\n")
+        file.write(f"constexpr std::array<uint8_t, {len(block_indices)}> emoji_table_block_indices{{{{\n")
+        file.write(format_bytes(block_indices, "    "))
+        file.write("\n}};\n\n")
+        file.write("/**\n")
+        file.write(" * Emoji properties of each code point, packed into four bits (the lower four\n")
+        file.write(" * bits for even code points and the upper four bits for odd code points).\n")
+        file.write(" */\n")
+        file.write(
+            f"constexpr std::array<std::array<uint8_t, {BLOCK_SIZE // 2}>, {len(blocks)}> emoji_table_blocks{{{{\n"
+        )
+
+        for block in blocks:
+            file.write("    {{\n")
+            file.write(format_bytes(block, "        "))
+            file.write("\n    }},\n")
+
+        file.write("}};\n\n")
+        file.write("} // namespace uih::emoji::detail\n\n")
+        file.write("// clang-format on\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("emoji_data", help="path to emoji-data.txt")
+    parser.add_argument("variation_sequences", help="path to emoji-variation-sequences.txt")
+    parser.add_argument("output", help="path to the header to write")
+    args = parser.parse_args()
+
+    flags = {}
+    read_emoji_data(args.emoji_data, flags)
+    read_variation_sequences(args.variation_sequences, flags)
+
+    block_indices, blocks = build_tables(flags)
+    write_header(args.output, block_indices, blocks)
+
+
+if __name__ == "__main__":
+    main()